@@ -21,8 +21,13 @@
 #include <vector>
 
 #include "C_Mqueue.h"
+#include "C_Config.h"
 #include "SharedTypes.h"
 
+// [queues] defaults: requests into the DB/actuator, replies back to the threads.
+#define QUEUE_DEPTH_REQUESTS_DEFAULT  20
+#define QUEUE_DEPTH_REPLIES_DEFAULT   10
+
 static volatile sig_atomic_t g_stop = 0;
 
 static void signalHandler(int signum) {
@@ -182,17 +187,27 @@ int main() {
     std::cout << "  SECURE ASSET GUARD - LAUNCHER\n";
     std::cout << "======================================\n";
 
+    // Queue depths come from the shared configuration (fixed once created;
+    // the daemons watch the file for everything that can change live).
+    C_Config config;
+    if (config.load(SYSTEM_CONFIG_PATH)) {
+        std::cout << "[Wrapper] Configuration: " << SYSTEM_CONFIG_PATH << "\n";
+    }
+    const long reqDepth = config.getInt("queues", "depth_requests", QUEUE_DEPTH_REQUESTS_DEFAULT);
+    const long replyDepth = config.getInt("queues", "depth_replies", QUEUE_DEPTH_REPLIES_DEFAULT);
+
     // Create POSIX queues (launcher owns and unlinks).
     std::vector<std::unique_ptr<C_Mqueue>> mqs;
     try {
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_to_db", sizeof(DatabaseMsg), 20, true));
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_to_actuator", sizeof(ActuatorCmd), 20, true));
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_rfid_in", sizeof(AuthResponse), 10, true));
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_rfid_out", sizeof(AuthResponse), 10, true));
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_move", sizeof(AuthResponse), 10, true));
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_finger", sizeof(AuthResponse), 10, true));
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_db_to_env", sizeof(AuthResponse), 10, true));
-        mqs.push_back(std::make_unique<C_Mqueue>("/mq_db_to_web", sizeof(DbWebResponse), 10, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_to_db", sizeof(DatabaseMsg), reqDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_to_actuator", sizeof(ActuatorCmd), reqDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_rfid_in", sizeof(AuthResponse), replyDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_rfid_out", sizeof(AuthResponse), replyDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_move", sizeof(AuthResponse), replyDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_finger", sizeof(AuthResponse), replyDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_db_to_env", sizeof(AuthResponse), replyDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_db_to_inventory", sizeof(AuthResponse), replyDepth, true));
+        mqs.push_back(std::make_unique<C_Mqueue>("/mq_db_to_web", sizeof(DbWebResponse), replyDepth, true));
         std::cout << "[Wrapper] Message queues created successfully.\n";
     } catch (const std::exception& e) {
         std::cerr << "[Wrapper] ERROR creating queues: " << e.what() << std::endl;
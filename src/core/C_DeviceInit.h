@@ -0,0 +1,69 @@
+#ifndef C_DEVICEINIT_H
+#define C_DEVICEINIT_H
+
+/*
+ * Device bring-up driven by a declared dependency graph.
+ * Nodes whose dependencies are up are initialized concurrently (one worker each);
+ * every node is timed and a startup report is logged. Failed non-critical nodes
+ * are left pending and retried later with retryPending().
+ */
+
+#include <pthread.h>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+class C_DeviceInit {
+public:
+    typedef std::function<bool()> InitFn;
+    typedef std::function<void()> ReadyFn;
+
+    enum State_enum : uint8_t { NODE_PENDING, NODE_UP, NODE_FAILED, NODE_SKIPPED };
+
+    C_DeviceInit();
+    ~C_DeviceInit();
+
+    // Dependencies must already be declared (ids are in topological order).
+    // onReady runs when the node comes up in a retry (not during run()).
+    int add(const std::string& name, bool critical, InitFn init,
+            std::initializer_list<int> deps = {}, ReadyFn onReady = nullptr);
+
+    // Initialize all nodes; false if a critical node did not come up.
+    bool run();
+
+    // Retry failed/skipped non-critical nodes; returns how many are still down.
+    uint32_t retryPending();
+
+    bool ready(int id);
+    uint32_t pending();
+
+private:
+    struct S_Node {
+        std::string name;
+        bool critical;
+        std::vector<int> deps;
+        InitFn init;
+        ReadyFn onReady;
+        State_enum state;
+        double ms;
+        uint32_t attempts;
+    };
+
+    struct S_Worker {
+        C_DeviceInit* self;
+        int id;
+    };
+
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_cond;
+    std::vector<S_Node> m_nodes;
+
+    static void* workerEntry(void* arg);
+    void runNode(int id);
+    bool depsUp(const S_Node& node) const;
+    void report(double wallMs);
+};
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * Room unit construction from its hardware map entry.
+ */
+
+#include "C_Room.h"
+
+C_Room::C_Room(const S_RoomMap& map, unsigned index, C_UARTLoop& uartRx, const S_UartOptions& uartOptions)
+    : m_id(map.id),
+      m_index(index),
+      m_name("Sala " + std::to_string(map.id)),
+      m_uart_rfid_entry(map.rfidEntryUart, &uartRx),
+      m_uart_rfid_exit(map.rfidExitUart, &uartRx),
+      m_pwm_servo(map.servoPwmChip, map.servoPwmChannel),
+      m_rfid_entry(m_uart_rfid_entry),
+      m_rfid_exit(m_uart_rfid_exit),
+      m_door(ID_SERVO_ROOM, m_pwm_servo),
+      m_occupancy() {
+    m_uart_rfid_entry.setOptions(uartOptions);
+    m_uart_rfid_exit.setOptions(uartOptions);
+}
@@ -0,0 +1,56 @@
+#ifndef C_ROOM_H
+#define C_ROOM_H
+
+/*
+ * One guarded room: entry/exit RFID readers, door servo and occupancy.
+ * Built from the site map; the flow threads serve every room through these units.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "C_UART.h"
+#include "C_UARTLoop.h"
+#include "C_PWM.h"
+#include "C_RDM6300.h"
+#include "C_ServoMG996R.h"
+#include "C_Occupancy.h"
+#include "C_SiteMap.h"
+
+// Event kinds posted to the room flow inboxes (C_UnitEvents), unit = room index.
+enum RoomEvent_enum : uint8_t {
+    ROOM_EVT_RFID = 0,
+    ROOM_EVT_REED = 1
+};
+
+class C_Room {
+    uint16_t m_id;
+    unsigned m_index;
+    std::string m_name;
+
+    C_UART m_uart_rfid_entry;
+    C_UART m_uart_rfid_exit;
+    C_PWM m_pwm_servo;
+
+    C_RDM6300 m_rfid_entry;
+    C_RDM6300 m_rfid_exit;
+    C_ServoMG996R m_door;
+    C_Occupancy m_occupancy;
+
+public:
+    C_Room(const S_RoomMap& map, unsigned index, C_UARTLoop& uartRx, const S_UartOptions& uartOptions);
+
+    C_Room(const C_Room&) = delete;
+    C_Room& operator=(const C_Room&) = delete;
+
+    uint16_t id() const { return m_id; }
+    unsigned index() const { return m_index; }
+    const char* name() const { return m_name.c_str(); }
+
+    C_RDM6300& rfidEntry() { return m_rfid_entry; }
+    C_RDM6300& rfidExit() { return m_rfid_exit; }
+    C_ServoMG996R& door() { return m_door; }
+    C_Occupancy& occupancy() { return m_occupancy; }
+};
+
+#endif
@@ -4,46 +4,54 @@
  */
 
 #include "C_SecureAsset.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <cstdlib>
+#include <map>
+#include <string>
+#include <unistd.h>
 
 C_SecureAsset* C_SecureAsset::s_instance = nullptr;
 
+// Room index doubles as the inbox unit.
+static_assert(SITE_MAX_ROOMS <= UNIT_EVENTS_MAX_UNITS, "one inbox bit per room");
+
 
 C_SecureAsset::C_SecureAsset()
 
-    : m_gpio_fingerprint_rst(PIN_FINGERPRINT_RST, OUT),
-      m_gpio_yrm1001_enable(PIN_YRM1001_ENABLE, OUT),
-      m_gpio_fan(PIN_FAN, OUT),
-      m_gpio_alarm_led(PIN_ALARM_LED, OUT),
-      m_gpio_alarm_buzzer(PIN_ALARM_BUZZER, OUT),
+    : m_config(SYSTEM_CONFIG_PATH),
+      m_site(loadSite(m_config)),
+
+      m_gpio_fingerprint_rst(m_site.vault.fingerprintRstPin, OUT),
+      m_gpio_yrm1001_enable(m_site.vault.uhfEnablePin, OUT),
+      m_gpio_fan(m_site.fanPin, OUT),
+      m_gpio_alarm_led(m_site.alarmLedPin, OUT),
+      m_gpio_alarm_buzzer(m_site.alarmBuzzerPin, OUT),
 
 
-      m_uart_rfid_entry(UART_RFID_ENTRY),
-      m_uart_rfid_exit(UART_RFID_EXIT),
-      m_uart_fingerprint(UART_FINGERPRINT),
-      m_uart_yrm1001(UART_YRM1001),
+      m_uart_rx(),
+      m_uart_fingerprint(m_site.vault.fingerprintUart, &m_uart_rx),
+      m_uart_yrm1001(m_site.vault.uhfUart, &m_uart_rx),
 
 
-      m_i2c_temp_sensor(I2C_BUS, SHT30_ADDR),
+      m_i2c_temp_sensor(m_site.i2cBus, SHT30_ADDR),
 
 
-      m_pwm_servo_room(PWM_CHIP, PWM_CHANNEL_SERVO_ROOM),
-      m_pwm_servo_vault(PWM_CHIP, PWM_CHANNEL_SERVO_VAULT),
+      m_pwm_servo_vault(m_site.vault.servoPwmChip, m_site.vault.servoPwmChannel),
 
 
       m_temp_sensor(m_i2c_temp_sensor),
-      m_rfid_entry(m_uart_rfid_entry),
-      m_rfid_exit(m_uart_rfid_exit),
       m_rfid_inventory(m_uart_yrm1001, m_gpio_yrm1001_enable),
       m_fingerprint(m_uart_fingerprint, m_gpio_fingerprint_rst),
 
 
-      m_servo_room(ID_SERVO_ROOM, m_pwm_servo_room),
       m_servo_vault(ID_SERVO_VAULT, m_pwm_servo_vault),
       m_fan(m_gpio_fan),
       m_alarm(m_gpio_alarm_led, m_gpio_alarm_buzzer),
 
+      m_devices(),
+      m_dev_temp_sensor(-1),
+      m_dev_rfid_inventory(-1),
+
 
       m_mq_to_database("/mq_to_db", sizeof(DatabaseMsg), 20, false),
       m_mq_to_actuator("/mq_to_actuator", sizeof(ActuatorCmd), 20, false),
@@ -52,23 +60,60 @@ C_SecureAsset::C_SecureAsset()
       m_mq_to_check_movement("/mq_move", sizeof(AuthResponse), 10, false),
       m_mq_to_vault("/mq_finger", sizeof(AuthResponse), 10, false),
       m_mq_to_env_sensor("/mq_db_to_env", sizeof(AuthResponse), 10, false),
+      m_mq_to_inventory("/mq_db_to_inventory", sizeof(AuthResponse), 10, false),
 
 
-      m_monitor_reed_room(),
       m_monitor_reed_vault(),
-      m_monitor_pir(),
       m_monitor_fingerprint(),
-      m_monitor_rfid_entry(),
-      m_monitor_rfid_exit()
+
+      m_events_room_entry(),
+      m_events_room_exit(),
+      m_events_pir(),
+
+      m_outbox(m_mq_to_database, OUTBOX_PATH),
+      m_rules(m_mq_to_actuator, m_outbox, [this](uint16_t roomId) { return occupancyOf(roomId); }),
+      m_power_policy(PREWAKE_BUDGET_MW_DEFAULT)
 {
-    std::cout << "[SecureAsset] Construtor executado" << std::endl;
+    LOG_INFO("[SecureAsset] Construtor executado");
+
+    // Lines are requested in init(); the backend only has to be set before.
+    // Simulated hardware only provides the sysfs tree.
+    C_GPIO::setBackend(C_HalPaths::simulated() ? GPIO_BACKEND_SYSFS : m_site.gpioBackend, m_site.gpioChip);
 
-    // Initialize actuator list with null pointers.
-    m_actuators_list.fill(nullptr);
+    // Read timing is applied when the readers configure their ports in init().
+    m_uart_fingerprint.setOptions(m_site.uart);
+    m_uart_yrm1001.setOptions(m_site.uart);
+    m_temp_sensor.setMode(m_site.sht30Mode, m_site.sht30Rate);
+    m_rfid_inventory.setOptions(m_site.vault.uhf);
+
+    for (size_t i = 0; i < m_site.rooms.size(); ++i) {
+        m_rooms.push_back(std::make_unique<C_Room>(m_site.rooms[i], static_cast<unsigned>(i), m_uart_rx, m_site.uart));
+        m_room_ptrs.push_back(m_rooms.back().get());
+    }
+    LOG_INFO("[SecureAsset] %zu sala(s), cofre %u na sala %u", m_rooms.size(),
+             static_cast<unsigned>(m_site.vault.id), static_cast<unsigned>(m_site.vault.roomId));
+}
+
+C_SiteMap C_SecureAsset::loadSite(C_ConfigWatch& config) {
+    // Missing or invalid configuration: single room/vault with the default wiring.
+    C_SiteMap site;
+    if (config.load() && !site.load(config.config())) {
+        LOG_ERROR("[SecureAsset] Mapa de hardware inválido, mapa por omissão");
+    }
+    return site;
+}
+
+uint32_t C_SecureAsset::occupancyOf(uint16_t roomId) const {
+    // Room 0: the whole site (rules without a room context).
+    uint32_t total = 0;
+    for (const auto& room : m_rooms) {
+        if (roomId == 0 || room->id() == roomId) total += room->occupancy().count();
+    }
+    return total;
 }
 
 C_SecureAsset::~C_SecureAsset() {
-    std::cout << "[SecureAsset] Destrutor executado" << std::endl;
+    LOG_INFO("[SecureAsset] Destrutor executado");
 }
 
 C_SecureAsset* C_SecureAsset::getInstance() {
@@ -86,112 +131,116 @@ void C_SecureAsset::destroyInstance() {
     s_instance = nullptr;
 }
 
-bool C_SecureAsset::initSensors() {
-    std::cout << "[SecureAsset] A inicializar Sensores..." << std::endl;
-
-    // Required sensors; any failure aborts initialization.
-    if (!m_temp_sensor.init()) {
-        std::cerr << "[ERRO] Falha no init: Sensor Temperatura" << std::endl;
-        return false;
-    }
-
-    if (!m_rfid_entry.init()) {
-        std::cerr << "[ERRO] Falha no init: RFID Entry" << std::endl;
-        return false;
-    }
-
-    if (!m_rfid_exit.init()) {
-        std::cerr << "[ERRO] Falha no init: RFID Exit" << std::endl;
-        return false;
-    }
-
-    if (!m_rfid_inventory.init()) {
-        std::cerr << "[ERRO] Falha no init: RFID Inventory" << std::endl;
-        return false;
-    }
-
-    if (!m_fingerprint.init()) {
-        std::cerr << "[ERRO] Falha no init: Fingerprint" << std::endl;
-        return false;
+bool C_SecureAsset::initDevices() {
+    LOG_INFO("[SecureAsset] A inicializar dispositivos...");
+
+    // Bus nodes: fail fast (and skip dependents) when a kernel interface is missing.
+    auto interfacePresent = [](const std::string& path) {
+        return [path]() {
+            if (access(C_HalPaths::path(path).c_str(), F_OK) == 0) return true;
+            LOG_ERROR("[SecureAsset] Interface em falta: %s", path.c_str());
+            return false;
+        };
+    };
+    const int gpio = (C_GPIO::backend() == GPIO_BACKEND_CHARDEV)
+        ? m_devices.add("GPIO chardev", false, interfacePresent(C_GPIO::chipPath()))
+        : m_devices.add("GPIO sysfs", false, interfacePresent("/sys/class/gpio/export"));
+    const int i2c = m_devices.add("I2C bus", false,
+                                  interfacePresent("/dev/i2c-" + std::to_string(m_site.i2cBus)));
+
+    // One node per PWM chip used by a door servo.
+    std::map<int, int> pwmNodes;
+    auto pwmNode = [&](int chip) {
+        auto it = pwmNodes.find(chip);
+        if (it != pwmNodes.end()) return it->second;
+        int id = m_devices.add("PWM chip " + std::to_string(chip), false,
+                               interfacePresent("/sys/class/pwm/pwmchip" + std::to_string(chip)));
+        pwmNodes[chip] = id;
+        return id;
+    };
+    for (const S_RoomMap& map : m_site.rooms) pwmNode(map.servoPwmChip);
+    pwmNode(m_site.vault.servoPwmChip);
+
+    // Access path and safety actuators are critical; any failure aborts startup.
+    for (size_t i = 0; i < m_rooms.size(); ++i) {
+        C_Room* room = m_rooms[i].get();
+        std::string name = room->name();
+        m_devices.add("RFID Entry " + name, true, [room]() { return room->rfidEntry().init(); });
+        m_devices.add("RFID Exit " + name, true, [room]() { return room->rfidExit().init(); });
+        m_devices.add("Servo " + name, true, [room]() { return room->door().init(); },
+                      {pwmNodes[m_site.rooms[i].servoPwmChip]});
     }
-
-    std::cout << "[SecureAsset] Sensores inicializados com sucesso" << std::endl;
+    m_devices.add("Fingerprint", true, [this]() { return m_fingerprint.init(); }, {gpio});
+    m_devices.add("Servo Vault", true, [this]() { return m_servo_vault.init(); },
+                  {pwmNodes[m_site.vault.servoPwmChip]});
+    m_devices.add("Alarm", true, [this]() { return m_alarm.init(); }, {gpio});
+
+    // Non-critical: retried in background; their threads start once they are up.
+    m_dev_temp_sensor = m_devices.add("Sensor Temperatura", false,
+        [this]() { return m_temp_sensor.init(); }, {i2c},
+        [this]() { startLate(m_thread_env_sensor.get(), "Environment Sensor"); });
+    m_dev_rfid_inventory = m_devices.add("RFID Inventory", false,
+        [this]() { return m_rfid_inventory.init(); }, {gpio},
+        [this]() { startLate(m_thread_inventory.get(), "Inventory"); });
+    m_devices.add("Fan", false, [this]() { return m_fan.init(); }, {gpio});
+
+    if (!m_devices.run()) return false;
+
+    LOG_INFO("[SecureAsset] Dispositivos inicializados (%u em falta)", m_devices.pending());
     return true;
 }
 
-bool C_SecureAsset::initActuators() {
-    std::cout << "[SecureAsset] A inicializar Atuadores..." << std::endl;
-
-    // Required actuators; any failure aborts initialization.
-    if (!m_servo_room.init()) {
-        std::cerr << "[ERRO] Falha no init: Servo Room" << std::endl;
-        return false;
-    }
-
-    if (!m_servo_vault.init()) {
-        std::cerr << "[ERRO] Falha no init: Servo Vault" << std::endl;
-        return false;
-    }
-
-    if (!m_fan.init()) {
-        std::cerr << "[ERRO] Falha no init: Fan" << std::endl;
-        return false;
-    }
-
-    if (!m_alarm.init()) {
-        std::cerr << "[ERRO] Falha no init: Alarm" << std::endl;
-        return false;
+void C_SecureAsset::initActuatorsList() {
+    // Map actuator IDs (and room/vault IDs for doors) to concrete instances.
+    m_actuators_list.clear();
+    for (const auto& room : m_rooms) {
+        m_actuators_list.push_back(S_ActuatorSlot{ID_SERVO_ROOM, room->id(), &room->door()});
     }
+    m_actuators_list.push_back(S_ActuatorSlot{ID_SERVO_VAULT, m_site.vault.id, &m_servo_vault});
+    m_actuators_list.push_back(S_ActuatorSlot{ID_FAN, 0, &m_fan});
+    m_actuators_list.push_back(S_ActuatorSlot{ID_ALARM_ACTUATOR, 0, &m_alarm});
 
-    std::cout << "[SecureAsset] Atuadores inicializados com sucesso" << std::endl;
-    return true;
-}
-
-void C_SecureAsset::initActuatorsList() {
-    // Map actuator IDs to concrete instances.
-    m_actuators_list.fill(nullptr);
-    m_actuators_list[ID_SERVO_ROOM] = &m_servo_room;
-    m_actuators_list[ID_SERVO_VAULT] = &m_servo_vault;
-    m_actuators_list[ID_FAN] = &m_fan;
-    m_actuators_list[ID_ALARM_ACTUATOR] = &m_alarm;
-
-    std::cout << "[SecureAsset] Lista de atuadores configurada" << std::endl;
+    LOG_INFO("[SecureAsset] Lista de atuadores configurada");
 }
 
 
 
 
 void C_SecureAsset::createThreads() {
-    std::cout << "[SecureAsset] A criar threads..." << std::endl;
+    LOG_INFO("[SecureAsset] A criar threads...");
 
     // Thread dedicated to signals and monitors (sensor wakeups).
     m_thread_sighandler = std::make_unique<C_tSighandler>(
-        m_monitor_reed_room,
+        m_site,
+        m_events_room_entry,
+        m_events_room_exit,
+        m_events_pir,
         m_monitor_reed_vault,
-        m_monitor_pir,
-        m_monitor_fingerprint,
-        m_monitor_rfid_entry,
-        m_monitor_rfid_exit
+        m_monitor_fingerprint
     );
 
-    // Verify room entry access via RFID.
+    // Verify room entry access via RFID (all rooms).
     m_thread_verify_room = std::make_unique<C_tVerifyRoomAccess>(
-        m_monitor_rfid_entry,
-        m_monitor_reed_room,
-        m_rfid_entry,
+        m_events_room_entry,
+        m_room_ptrs,
         m_mq_to_database,
         m_mq_to_verify_room,
-        m_mq_to_actuator
+        m_mq_to_actuator,
+        m_outbox,
+        m_rules,
+        m_power_policy,
+        m_site.vault.roomId
     );
 
-    // Verify room exit via RFID.
+    // Verify room exit via RFID (all rooms).
     m_thread_leave_room = std::make_unique<C_tLeaveRoomAccess>(
-        m_monitor_rfid_exit,
-        m_monitor_reed_room,
-        m_rfid_exit,
+        m_events_room_exit,
+        m_room_ptrs,
         m_mq_to_database,
         m_mq_to_leave_room,
-        m_mq_to_actuator
+        m_mq_to_actuator,
+        m_outbox,
+        m_rules
     );
 
     // Verify vault access via fingerprint.
@@ -199,131 +248,179 @@ void C_SecureAsset::createThreads() {
         m_monitor_fingerprint,
         m_monitor_reed_vault,
         m_fingerprint,
-        m_mq_to_database,
+        m_outbox,
         m_mq_to_actuator,
-        m_mq_to_vault
+        m_mq_to_vault,
+        m_power_policy,
+        m_site.vault
     );
 
     // Inventory via RFID (YRM1001).
     m_thread_inventory = std::make_unique<C_tInventoryScan>(
         m_monitor_reed_vault,
         m_rfid_inventory,
-        m_mq_to_database
+        m_outbox,
+        m_mq_to_database,
+        m_mq_to_inventory,
+        m_power_policy,
+        m_site.vault
     );
 
     // Environmental reading (temperature) and threshold notification.
     m_thread_env_sensor = std::make_unique<C_tReadEnvSensor>(
         m_temp_sensor,
-        m_mq_to_actuator,
+        m_rules,
         m_mq_to_database,
         m_mq_to_env_sensor,
-        SAMPLING_INTERVAL_DEFAULT,
-        TEMP_THRESHOLD_DEFAULT
+        m_outbox,
+        m_config.config().getInt("environment", "sampling_interval", SAMPLING_INTERVAL_DEFAULT),
+        m_config.config().getInt("environment", "temp_threshold", TEMP_THRESHOLD_DEFAULT)
     );
 
-    // Movement monitoring (PIR) and DB communication.
+    // Movement monitoring (PIR) against in-memory occupancy.
     m_thread_check_movement = std::make_unique<C_tCheckMovement>(
         m_mq_to_check_movement,
         m_mq_to_database,
-        m_mq_to_actuator,
-        m_monitor_pir
+        m_events_pir,
+        m_room_ptrs,
+        m_rules
     );
 
     // Execute actuator commands received via queue.
     m_thread_actuator = std::make_unique<C_tAct>(
         m_mq_to_actuator,
-        m_mq_to_database,
+        m_outbox,
         m_actuators_list
     );
 
-    std::cout << "[SecureAsset] Threads criadas com sucesso" << std::endl;
+    // Replay of DB messages stored while the queue was unavailable.
+    m_thread_outbox_flush = std::make_unique<C_tOutboxFlush>(m_outbox);
+
+    // Background bring-up of non-critical devices that failed at startup.
+    m_thread_device_retry = std::make_unique<C_tDeviceRetry>(m_devices);
+
+    // Hot reload of the configuration file.
+    m_thread_config = std::make_unique<C_tConfigWatch>(m_config);
+
+    // Receive loop feeding the UART readers.
+    m_thread_uart_rx = std::make_unique<C_tUartRx>(m_uart_rx);
+
+    LOG_INFO("[SecureAsset] Threads criadas com sucesso");
 }
 
 
 
 
 bool C_SecureAsset::init() {
-    std::cout << "============================================" << std::endl;
-    std::cout << "    SECURE ASSET GUARD - INITIALIZATION" << std::endl;
-    std::cout << "============================================" << std::endl;
+    LOG_INFO("============================================");
+    LOG_INFO("    SECURE ASSET GUARD - INITIALIZATION");
+    LOG_INFO("============================================");
 
     // Block signals before creating threads so they inherit the mask.
     C_tSighandler::setupSignalBlock();
-    std::cout << "[SecureAsset] Sinais bloqueados (herança para threads)" << std::endl;
+    LOG_INFO("[SecureAsset] Sinais bloqueados (herança para threads)");
 
-    if (!initSensors()) {
-        std::cerr << "[ERRO CRÍTICO] Inicialização dos sensores falhou!" << std::endl;
+    // Order: devices (dependency graph) -> wiring -> threads.
+    if (!initDevices()) {
+        LOG_ERROR("[ERRO CRÍTICO] Inicialização dos dispositivos falhou!");
         return false;
     }
 
-    // Order: sensors -> actuators -> wiring -> threads.
-    if (!initActuators()) {
-        std::cerr << "[ERRO CRÍTICO] Inicialização dos atuadores falhou!" << std::endl;
-        return false;
-    }
-    
     initActuatorsList();
+
+    // Non-fatal: without the segment file logs are sent best-effort.
+    m_outbox.open();
+
+    // Built-in rules, replaced by the rules file when present and valid.
+    m_rules.loadDefaults();
+    if (access(RULES_PATH, R_OK) == 0) {
+        m_rules.loadFile(RULES_PATH);
+    }
+
     createThreads();
+    watchConfig();
 
-    std::cout << "============================================" << std::endl;
-    std::cout << "    INITIALIZATION COMPLETE" << std::endl;
-    std::cout << "============================================" << std::endl;
+    LOG_INFO("============================================");
+    LOG_INFO("    INITIALIZATION COMPLETE");
+    LOG_INFO("============================================");
 
     return true;
 }
 
 void C_SecureAsset::start() {
-    std::cout << "[SecureAsset] A iniciar threads..." << std::endl;
+    LOG_INFO("[SecureAsset] A iniciar threads...");
 
     // Startup order ensures signal handler and actuation are ready.
     if (!m_thread_sighandler->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Signal Handler!" << std::endl;
+        LOG_ERROR("[ERRO] Falha ao iniciar Signal Handler!");
         std::exit(EXIT_FAILURE);
     }
 
+    // Readers wait on decoded frames from here on.
+    if (!m_thread_uart_rx->start()) {
+        LOG_ERROR("[ERRO] Falha ao iniciar UART Rx Thread (leitura síncrona)");
+    }
+
     if (!m_thread_actuator->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Actuator Thread!" << std::endl;
+        LOG_ERROR("[ERRO] Falha ao iniciar Actuator Thread!");
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (!m_thread_outbox_flush->start()) {
+        LOG_ERROR("[ERRO] Falha ao iniciar Outbox Flush Thread!");
         std::exit(EXIT_FAILURE);
     }
 
     if (!m_thread_verify_room->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Verify Room Thread!" << std::endl;
+        LOG_ERROR("[ERRO] Falha ao iniciar Verify Room Thread!");
         std::exit(EXIT_FAILURE);
     }
 
     if (!m_thread_leave_room->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Leave Room Thread!" << std::endl;
+        LOG_ERROR("[ERRO] Falha ao iniciar Leave Room Thread!");
         std::exit(EXIT_FAILURE);
     }
 
     if (!m_thread_verify_vault->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Verify Vault Thread!" << std::endl;
+        LOG_ERROR("[ERRO] Falha ao iniciar Verify Vault Thread!");
         std::exit(EXIT_FAILURE);
     }
 
-    if (!m_thread_inventory->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Inventory Thread!" << std::endl;
+    // Threads of devices still down are started by the retry thread.
+    if (m_devices.ready(m_dev_rfid_inventory) && !m_thread_inventory->start()) {
+        LOG_ERROR("[ERRO] Falha ao iniciar Inventory Thread!");
         std::exit(EXIT_FAILURE);
     }
 
-    if (!m_thread_env_sensor->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Environment Sensor Thread!" << std::endl;
+    if (m_devices.ready(m_dev_temp_sensor) && !m_thread_env_sensor->start()) {
+        LOG_ERROR("[ERRO] Falha ao iniciar Environment Sensor Thread!");
         std::exit(EXIT_FAILURE);
     }
 
     if (!m_thread_check_movement->start()) {
-        std::cerr << "[ERRO] Falha ao iniciar Check Movement Thread!" << std::endl;
+        LOG_ERROR("[ERRO] Falha ao iniciar Check Movement Thread!");
         std::exit(EXIT_FAILURE);
     }
 
-    std::cout << "[SecureAsset] Todas as threads iniciadas!" << std::endl;
-    std::cout << "============================================" << std::endl;
-    std::cout << "    SISTEMA OPERACIONAL" << std::endl;
-    std::cout << "============================================" << std::endl;
+    if (m_devices.pending() > 0 && !m_thread_device_retry->start()) {
+        LOG_ERROR("[ERRO] Falha ao iniciar Device Retry Thread!");
+    }
+
+    // Without inotify the configuration is simply applied at startup only.
+    if (m_config.fd() >= 0 && !m_thread_config->start()) {
+        LOG_ERROR("[ERRO] Falha ao iniciar Config Watch Thread!");
+    }
+
+    LOG_INFO("[SecureAsset] Todas as threads iniciadas!");
+    LOG_INFO("============================================");
+    LOG_INFO("    SISTEMA OPERACIONAL");
+    LOG_INFO("============================================");
 }
 
 void C_SecureAsset::stop() {
     // Stop requests in reverse order of the main flow.
+    if (m_thread_config) m_thread_config->requestStop();
+    if (m_thread_device_retry) m_thread_device_retry->requestStop();
     if (m_thread_check_movement) m_thread_check_movement->requestStop();
     if (m_thread_env_sensor) m_thread_env_sensor->requestStop();
     if (m_thread_inventory) m_thread_inventory->requestStop();
@@ -332,23 +429,26 @@ void C_SecureAsset::stop() {
     if (m_thread_verify_room) m_thread_verify_room->requestStop();
     if (m_thread_actuator) m_thread_actuator->requestStop();
     if (m_thread_sighandler) m_thread_sighandler->requestStop();
+    if (m_thread_uart_rx) m_thread_uart_rx->requestStop();
+    if (m_thread_outbox_flush) m_thread_outbox_flush->requestStop();
 
     AuthResponse stopMsg = {};
     stopMsg.command = DB_CMD_STOP_ENV_SENSOR;
     // Special message to unblock the env thread (if waiting).
     m_mq_to_env_sensor.send(&stopMsg, sizeof(stopMsg));
-    m_monitor_reed_room.signal();
     m_monitor_reed_vault.signal();
-    m_monitor_pir.signal();
     m_monitor_fingerprint.signal();
-    m_monitor_rfid_entry.signal();
-    m_monitor_rfid_exit.signal();
+    m_events_room_entry.wake();
+    m_events_room_exit.wake();
+    m_events_pir.wake();
 }
 
 void C_SecureAsset::waitForThreads() {
-    std::cout << "[SecureAsset] A aguardar término das threads..." << std::endl;
+    LOG_INFO("[SecureAsset] A aguardar término das threads...");
 
-    // Join all threads for clean shutdown.
+    // Join all threads for clean shutdown; the retry thread first (it may start others).
+    if (m_thread_device_retry) m_thread_device_retry->join();
+    if (m_thread_config) m_thread_config->join();
     if (m_thread_sighandler) m_thread_sighandler->join();
     if (m_thread_actuator) m_thread_actuator->join();
     if (m_thread_verify_room) m_thread_verify_room->join();
@@ -357,8 +457,11 @@ void C_SecureAsset::waitForThreads() {
     if (m_thread_inventory) m_thread_inventory->join();
     if (m_thread_env_sensor) m_thread_env_sensor->join();
     if (m_thread_check_movement) m_thread_check_movement->join();
+    if (m_thread_uart_rx) m_thread_uart_rx->join();
+    // Last: its final flush picks up logs written during shutdown.
+    if (m_thread_outbox_flush) m_thread_outbox_flush->join();
 
-    std::cout << "[SecureAsset] Todas as threads terminadas" << std::endl;
+    LOG_INFO("[SecureAsset] Todas as threads terminadas");
 }
 
 void C_SecureAsset::unregisterQueues() {
@@ -370,4 +473,102 @@ void C_SecureAsset::unregisterQueues() {
     m_mq_to_check_movement.unregister();
     m_mq_to_vault.unregister();
     m_mq_to_env_sensor.unregister();
+    m_mq_to_inventory.unregister();
+}
+
+void C_SecureAsset::startLate(C_Thread* thread, const char* name) {
+    // Device came up after startup: start its consumer unless shutting down.
+    if (!thread || thread->started() || thread->stopRequested()) return;
+    if (thread->start()) {
+        LOG_INFO("[SecureAsset] %s Thread iniciada (dispositivo disponível)", name);
+    } else {
+        LOG_ERROR("[ERRO] Falha ao iniciar %s Thread!", name);
+    }
+}
+
+void C_SecureAsset::reloadRules() {
+    // SIGHUP: hot swap; the active rules stay if the file does not compile.
+    LOG_INFO("[SecureAsset] A recarregar regras de %s", RULES_PATH);
+    m_rules.loadFile(RULES_PATH);
+}
+
+void C_SecureAsset::watchConfig() {
+    // Startup values; afterwards each subsystem only hears about its own section.
+    applyAccess(m_config.config());
+    applyThreadPriorities(m_config.config());
+    applyPower(m_config.config());
+
+    m_config.subscribe("environment", [this](const C_Config& c) { applyEnvironment(c); });
+    m_config.subscribe("access", [this](const C_Config& c) { applyAccess(c); });
+    m_config.subscribe("threads", [this](const C_Config& c) { applyThreadPriorities(c); });
+    m_config.subscribe("power", [this](const C_Config& c) { applyPower(c); });
+    m_config.restartOnly("site");
+    m_config.restartOnly("room");
+    m_config.restartOnly("vault");
+    m_config.watch();
+}
+
+void C_SecureAsset::applyEnvironment(const C_Config& config) {
+    // Same path as a settings change from the web UI.
+    AuthResponse msg = {};
+    msg.command = DB_CMD_UPDATE_SETTINGS;
+    msg.payload.settings.tempThreshold = config.getInt("environment", "temp_threshold", TEMP_THRESHOLD_DEFAULT);
+    msg.payload.settings.samplingInterval = config.getInt("environment", "sampling_interval", SAMPLING_INTERVAL_DEFAULT);
+    if (!m_mq_to_env_sensor.trySend(&msg, sizeof(msg))) {
+        LOG_WARN("[SecureAsset] Settings ambientais não entregues (fila cheia)");
+    }
+}
+
+void C_SecureAsset::applyAccess(const C_Config& config) {
+    m_rules.setVar(RVAR_MAX_FAILED_SWIPES,
+                   config.getInt("access", "max_failed_swipes", RULE_MAX_FAILED_SWIPES_DEFAULT));
+    if (m_thread_actuator) {
+        m_thread_actuator->setAlarmSeconds(config.getInt("access", "alarm_seconds", ALARM_SECONDS_DEFAULT));
+    }
+    // Applies from the next card; a request already waiting keeps its timeout.
+    int replyTimeout = config.getInt("access", "reply_timeout", ACCESS_REPLY_TIMEOUT_DEFAULT);
+    if (replyTimeout < 1) replyTimeout = 1;
+    if (m_thread_verify_room) m_thread_verify_room->setReplyTimeout(replyTimeout);
+    if (m_thread_leave_room) m_thread_leave_room->setReplyTimeout(replyTimeout);
+}
+
+void C_SecureAsset::applyThreadPriorities(const C_Config& config) {
+    const int high = config.getInt("threads", "prio_high", PRIO_HIGH);
+    const int medium = config.getInt("threads", "prio_medium", PRIO_MEDIUM);
+    const int low = config.getInt("threads", "prio_low", PRIO_LOW);
+
+    C_Thread* threads[] = {
+        m_thread_sighandler.get(), m_thread_verify_room.get(), m_thread_leave_room.get(),
+        m_thread_verify_vault.get(), m_thread_inventory.get(), m_thread_env_sensor.get(),
+        m_thread_check_movement.get(), m_thread_actuator.get(), m_thread_outbox_flush.get(),
+        m_thread_device_retry.get(), m_thread_config.get(), m_thread_uart_rx.get()
+    };
+    for (C_Thread* thread : threads) {
+        if (!thread) continue;
+        switch (thread->basePriority()) {
+            case PRIO_HIGH:   thread->setPriority(high); break;
+            case PRIO_MEDIUM: thread->setPriority(medium); break;
+            case PRIO_LOW:    thread->setPriority(low); break;
+            default: break;
+        }
+    }
+    LOG_INFO("[SecureAsset] Prioridades: alta=%d média=%d baixa=%d", high, medium, low);
+}
+
+void C_SecureAsset::applyPower(const C_Config& config) {
+    int budget = config.getInt("power", "prewake_budget_mw", PREWAKE_BUDGET_MW_DEFAULT);
+    int fingerHold = config.getInt("power", "prewake_finger_hold_ms", PREWAKE_FINGER_HOLD_MS_DEFAULT);
+    int uhfHold = config.getInt("power", "prewake_uhf_hold_ms", PREWAKE_UHF_HOLD_MS_DEFAULT);
+    // A budget of 0 disables pre-wake; hold times must be positive.
+    if (budget < 0 || fingerHold <= 0 || uhfHold <= 0) {
+        LOG_ERROR("[SecureAsset] [power] inválida, a usar valores por omissão");
+        budget = PREWAKE_BUDGET_MW_DEFAULT;
+        fingerHold = PREWAKE_FINGER_HOLD_MS_DEFAULT;
+        uhfHold = PREWAKE_UHF_HOLD_MS_DEFAULT;
+    }
+    m_power_policy.setBudget(static_cast<uint32_t>(budget));
+    m_power_policy.setHold(PREWAKE_FINGERPRINT, static_cast<uint32_t>(fingerHold));
+    m_power_policy.setHold(PREWAKE_UHF, static_cast<uint32_t>(uhfHold));
+    LOG_INFO("[SecureAsset] Pre-wake: orçamento %d mW, fingerprint %d ms, UHF %d ms",
+             budget, fingerHold, uhfHold);
 }
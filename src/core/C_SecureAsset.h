@@ -4,14 +4,17 @@
 /*
  * Core orchestrator.
  * Aggregates hardware (GPIO/UART/I2C/PWM), sensors/actuators, IPC queues, and threads.
+ * Rooms and the vault are instantiated from the site map (SYSTEM_CONFIG_PATH).
  */
 
 #include <memory>
-#include <array>
+#include <vector>
 
 
 #include "C_GPIO.h"
 #include "C_UART.h"
+#include "C_UARTLoop.h"
+#include "C_HalPaths.h"
 #include "C_I2C.h"
 #include "C_PWM.h"
 
@@ -29,6 +32,10 @@
 
 #include "C_Mqueue.h"
 #include "C_Monitor.h"
+#include "C_UnitEvents.h"
+#include "C_Outbox.h"
+#include "C_RuleEngine.h"
+#include "C_PowerPolicy.h"
 
 
 #include "C_tSighandler.h"
@@ -39,30 +46,52 @@
 #include "C_tReadEnvSensor.h"
 #include "C_tCheckMovement.h"
 #include "C_tAct.h"
+#include "C_tOutboxFlush.h"
+#include "C_tDeviceRetry.h"
+#include "C_tConfigWatch.h"
+#include "C_tUartRx.h"
 
-#include "SharedTypes.h"
-
+#include "C_DeviceInit.h"
+#include "C_ConfigWatch.h"
+#include "C_SiteMap.h"
+#include "C_Room.h"
 
-#define PIN_FINGERPRINT_RST  26
-#define PIN_YRM1001_ENABLE   25
-#define PIN_FAN              18
-#define PIN_ALARM_LED        24
-#define PIN_ALARM_BUZZER     23
+#include "SharedTypes.h"
 
-#define UART_RFID_ENTRY      2
-#define UART_RFID_EXIT       3
-#define UART_FINGERPRINT     0
-#define UART_YRM1001         4
 
-#define I2C_BUS              1
+#define OUTBOX_PATH          "/var/lib/secureasset_outbox.seg"
+#define RULES_PATH           "/etc/secureasset/rules.conf"
 
-#define PWM_CHIP             0
-#define PWM_CHANNEL_SERVO_ROOM  0
-#define PWM_CHANNEL_SERVO_VAULT 1
+// Extra power allowed for modules woken ahead of use.
+#define PREWAKE_BUDGET_MW_DEFAULT    1200
 
 #define TEMP_THRESHOLD_DEFAULT   3
 #define SAMPLING_INTERVAL_DEFAULT 60
 
+/*
+ * Core keys of SYSTEM_CONFIG_PATH (live unless noted):
+ *   [environment] temp_threshold, sampling_interval
+ *   [access]      max_failed_swipes, alarm_seconds, reply_timeout
+ *   [threads]     prio_high, prio_medium, prio_low (SCHED_FIFO 1..99)
+ *   [power]       prewake_budget_mw, prewake_finger_hold_ms, prewake_uhf_hold_ms
+ *   [site], [room <id>], [vault <id>]: hardware map, gpio_backend, irq_source
+ *                                    (driver|gpio), irq_edge, uart_timing
+ *                                    (frame|stream), uart_low_latency,
+ *                                    uart_rx_trigger, sht30_mode
+ *                                    (periodic|single), sht30_mps,
+ *                                    <input>_holdoff_ms, <input>_min_interval_ms,
+ *                                    <input>_min_edges (input: vault_reed,
+ *                                    room_reed, pir, fingerprint, rfid_entry,
+ *                                    rfid_exit), vault
+ *                                    uhf_power_dbm, uhf_max_scan_ms,
+ *                                    uhf_min_idle_ms, uhf_confidence,
+ *                                    uhf_expected_tags, uhf_keep_warm_ms,
+ *                                    uhf_background_ms, uhf_missing_ms
+ *                                    (restart)
+ *   [sim]         enabled, realtime, root, interval_ms, card, user_id, tags,
+ *                 temp_base, temp_swing: simulated hardware (restart)
+ */
+
 class C_SecureAsset {
 private:
     
@@ -77,34 +106,44 @@ private:
     C_SecureAsset(C_SecureAsset&&) = delete;
     C_SecureAsset& operator=(C_SecureAsset&&) = delete;
 
+    // Runtime configuration and the hardware map built from it (both first).
+    C_ConfigWatch m_config;
+    C_SiteMap m_site;
+
     C_GPIO m_gpio_fingerprint_rst;
     C_GPIO m_gpio_yrm1001_enable;
     C_GPIO m_gpio_fan;
     C_GPIO m_gpio_alarm_led;
     C_GPIO m_gpio_alarm_buzzer;
 
-    C_UART m_uart_rfid_entry;
-    C_UART m_uart_rfid_exit;
+    // Receive loop of every UART below and in the rooms (outlives them).
+    C_UARTLoop m_uart_rx;
+
     C_UART m_uart_fingerprint;
     C_UART m_uart_yrm1001;
 
     C_I2C m_i2c_temp_sensor;
 
-    C_PWM m_pwm_servo_room;
     C_PWM m_pwm_servo_vault;
 
     C_TH_SHT30 m_temp_sensor;
-    C_RDM6300 m_rfid_entry;
-    C_RDM6300 m_rfid_exit;
     C_YRM1001 m_rfid_inventory;
     C_Fingerprint m_fingerprint;
 
-    C_ServoMG996R m_servo_room;
     C_ServoMG996R m_servo_vault;
     C_Fan m_fan;
     C_alarmActuator m_alarm;
 
-    std::array<C_Actuator*, ID_ACTUATOR_COUNT> m_actuators_list;
+    // Room units (readers, door, occupancy) served by the shared flow threads.
+    std::vector<std::unique_ptr<C_Room>> m_rooms;
+    std::vector<C_Room*> m_room_ptrs;
+
+    std::vector<S_ActuatorSlot> m_actuators_list;
+
+    // Startup graph; ids of the non-critical devices gating their threads.
+    C_DeviceInit m_devices;
+    int m_dev_temp_sensor;
+    int m_dev_rfid_inventory;
     
     // POSIX queues used to communicate with DB daemon and other threads.
     C_Mqueue m_mq_to_database;
@@ -114,13 +153,24 @@ private:
     C_Mqueue m_mq_to_check_movement;
     C_Mqueue m_mq_to_vault;
     C_Mqueue m_mq_to_env_sensor;
+    C_Mqueue m_mq_to_inventory;
 
-    C_Monitor m_monitor_reed_room;
     C_Monitor m_monitor_reed_vault;
-    C_Monitor m_monitor_pir;
     C_Monitor m_monitor_fingerprint;
-    C_Monitor m_monitor_rfid_entry;
-    C_Monitor m_monitor_rfid_exit;
+
+    // Room inputs, one pending bit per (event, room).
+    C_UnitEvents m_events_room_entry;
+    C_UnitEvents m_events_room_exit;
+    C_UnitEvents m_events_pir;
+
+    // Fire-and-forget DB traffic survives a stopped/slow dDatabase.
+    C_Outbox m_outbox;
+
+    // Event reactions (alarm, fan) shared by the flow threads.
+    C_RuleEngine m_rules;
+
+    // Pre-wake of the fingerprint/UHF modules ahead of their use.
+    C_PowerPolicy m_power_policy;
 
     std::unique_ptr<C_tSighandler> m_thread_sighandler;
     std::unique_ptr<C_tVerifyRoomAccess> m_thread_verify_room;
@@ -130,12 +180,23 @@ private:
     std::unique_ptr<C_tReadEnvSensor> m_thread_env_sensor;
     std::unique_ptr<C_tCheckMovement> m_thread_check_movement;
     std::unique_ptr<C_tAct> m_thread_actuator;
+    std::unique_ptr<C_tOutboxFlush> m_thread_outbox_flush;
+    std::unique_ptr<C_tDeviceRetry> m_thread_device_retry;
+    std::unique_ptr<C_tConfigWatch> m_thread_config;
+    std::unique_ptr<C_tUartRx> m_thread_uart_rx;
 
     // Initialization helpers and internal wiring.
-    bool initSensors();
-    bool initActuators();
+    static C_SiteMap loadSite(C_ConfigWatch& config);
+    uint32_t occupancyOf(uint16_t roomId) const;
+    bool initDevices();
+    void startLate(C_Thread* thread, const char* name);
     void initActuatorsList();
     void createThreads();
+    void watchConfig();
+    void applyEnvironment(const C_Config& config);
+    void applyAccess(const C_Config& config);
+    void applyThreadPriorities(const C_Config& config);
+    void applyPower(const C_Config& config);
 
 public:
 
@@ -149,6 +210,7 @@ public:
     void stop();
     void waitForThreads();
     void unregisterQueues();
+    void reloadRules();
 };
 
 #endif 
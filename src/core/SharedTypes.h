@@ -24,11 +24,69 @@ struct Data_RFID_Single {
     char tagID[11];
 };
 
+// Inventory results travel in fixed-size batches of one scan session:
+// DB_CMD_UPDATE_ASSET per batch, then DB_CMD_INVENTORY_END closes the session.
+// EPCs are raw 96-bit values; hex only at the edges (logs, web API).
+#define INVENTORY_BATCH_TAGS 8
+#define INVENTORY_EPC_BYTES  12
+#define INVENTORY_EPC_HEX_SIZE (INVENTORY_EPC_BYTES * 2 + 1)
+
 struct Data_RFID_Inventory {
-    int tagCount;
-    char tagList[4][32];
+    uint32_t sessionId;      // 0 = no session (single message, legacy).
+    uint16_t batchIndex;     // Order within the session; on the end message, batches sent.
+    uint16_t tagCount;       // Tags in this batch.
+    uint32_t totalTags;      // End message: distinct tags in the whole session.
+    uint32_t startedAt;      // Unix time of the scan start: LastRead of every tag and the scan log.
+    uint8_t tagList[INVENTORY_BATCH_TAGS][INVENTORY_EPC_BYTES];
+};
+
+// Background inventory diff (DB_CMD_TAG_PRESENCE): one tag changed presence.
+struct Data_TagPresence {
+    uint8_t epc[INVENTORY_EPC_BYTES];
+    uint8_t present;         // 1 = appeared, 0 = missing.
+    uint32_t reads;          // Rounds that read the tag since the core started.
+    uint32_t lastSeen;       // Unix time of the last read.
 };
 
+// Reply to DB_CMD_GET_PRESENT_TAGS: the tags the DB holds as present in the vault,
+// used to seed background inventory after a restart.
+#define PRESENT_TAGS_PER_REPLY 32
+struct Data_PresentTags {
+    uint32_t requestId;      // Echo of the request; replies to an older one are stale.
+    uint16_t batchIndex;
+    uint16_t tagCount;
+    uint8_t last;            // 1 on the final batch (possibly empty).
+    uint8_t epc[PRESENT_TAGS_PER_REPLY][INVENTORY_EPC_BYTES];
+};
+
+// Upper-case hex of a 96-bit EPC; out holds INVENTORY_EPC_HEX_SIZE.
+inline void epcToHex(const uint8_t* epc, char* out) {
+    static const char digits[] = "0123456789ABCDEF";
+    for (int i = 0; i < INVENTORY_EPC_BYTES; ++i) {
+        out[i * 2] = digits[epc[i] >> 4];
+        out[i * 2 + 1] = digits[epc[i] & 0x0F];
+    }
+    out[INVENTORY_EPC_BYTES * 2] = '\0';
+}
+
+// Exactly 24 hex digits (either case); false leaves out undefined.
+inline bool epcFromHex(const char* hex, uint8_t* out) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    };
+    if (!hex) return false;
+    for (int i = 0; i < INVENTORY_EPC_BYTES; ++i) {
+        int hi = nibble(hex[i * 2]);
+        int lo = (hi < 0) ? -1 : nibble(hex[i * 2 + 1]);
+        if (lo < 0) return false;
+        out[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return hex[INVENTORY_EPC_BYTES * 2] == '\0';
+}
+
 struct Data_Fingerprint {
     bool authenticated;
     int userID;
@@ -57,11 +115,13 @@ enum ActuatorID_enum : uint8_t {
 struct ActuatorCmd {
     ActuatorID_enum actuatorID;
     uint8_t value;
+    // Room/vault ID for door servos; ignored by site-wide actuators (fan, alarm).
+    uint16_t unitId;
 
     // Default is room servo at 0.
-    ActuatorCmd() : actuatorID(ID_SERVO_ROOM), value(0) {}
-    ActuatorCmd(ActuatorID_enum id, uint8_t val)
-        : actuatorID(id), value(val) {}
+    ActuatorCmd() : actuatorID(ID_SERVO_ROOM), value(0), unitId(0) {}
+    ActuatorCmd(ActuatorID_enum id, uint8_t val, uint16_t unit = 0)
+        : actuatorID(id), value(val), unitId(unit) {}
 };
 
 inline constexpr const char* ACTUATOR_NAMES[] = {
@@ -86,21 +146,43 @@ enum LogType_enum : uint8_t {
     LOG_TYPE_INVENTORY = 5
 };
 
+// Audit event codes (persisted in Logs.EventCode, values must stay stable).
+// Text is rendered by the database daemon only when displayed.
+enum LogEvent_enum : uint16_t {
+    EVT_NONE           = 0,
+    EVT_ROOM_ENTER     = 1,
+    EVT_ROOM_DENIED    = 2,
+    EVT_ROOM_LEAVE     = 3,
+    EVT_VAULT_OPEN     = 4,
+    EVT_VAULT_DENIED   = 5,
+    EVT_PIR_EMPTY_ROOM = 6,
+    EVT_PIR_MOTION     = 7,
+    EVT_INVENTORY_SCAN = 8,
+    EVT_ENV_READING    = 9,
+    EVT_ACTUATOR_STATE = 10,
+    EVT_ENV_RAPID_RISE = 11,
+    EVT_ENV_HUM_SPIKE  = 12,
+    EVT_ENV_STUCK      = 13,
+    EVT_ENV_TEMP_DRIFT = 14,
+    EVT_ASSET_APPEARED = 15,
+    EVT_ASSET_MISSING  = 16
+};
+
+// Event parameters: entityID (user/fingerprint/actuator), value, value2.
 struct DatabaseLog {
     LogType_enum logType;
+    LogEvent_enum eventCode;
     uint32_t entityID;
     double value;
     double value2;
     uint32_t timestamp;
-    char description[266]{};
     DatabaseLog()
         : logType(LOG_TYPE_SYSTEM),
+          eventCode(EVT_NONE),
           entityID(0),
           value(0.0),
           value2(0.0),
-          timestamp(0) {
-        description[0] = '\0';
-    }
+          timestamp(0) {}
 };
 
 
@@ -136,7 +218,10 @@ enum e_DbCommand {
     DB_CMD_GET_SETTINGS_THREAD,
     DB_CMD_UPDATE_SETTINGS,        
     DB_CMD_FILTER_LOGS,
-    DB_CMD_STOP_ENV_SENSOR
+    DB_CMD_STOP_ENV_SENSOR,
+    DB_CMD_INVENTORY_END,
+    DB_CMD_TAG_PRESENCE,
+    DB_CMD_GET_PRESENT_TAGS
 };
 
 struct UserData {
@@ -165,22 +250,36 @@ struct SystemSettings {
 
 struct DatabaseMsg {
     e_DbCommand command;
+    // Outbox ordering for replayed messages (0 = unsequenced, never deduplicated).
+    uint32_t outboxEpoch;
+    uint32_t outboxSeq;
+    // Source of access requests and events (0 = site-wide / not applicable).
+    uint16_t roomId;
+    uint16_t vaultId;
     union {
         char rfid[11];
         DatabaseLog log;
         Data_RFID_Inventory rfidInventory;
+        Data_TagPresence tagPresence;
         LoginRequest login;
         UserData user;        
         AssetData asset;      
         SystemSettings settings; 
         LogFilter logFilter;  
         uint32_t userId;
+        uint32_t requestId;     // DB_CMD_GET_PRESENT_TAGS.
     } payload;
 };
 
 
+// Seconds an access thread waits for the AuthResponse before failing closed
+// ([access] reply_timeout).
+#define ACCESS_REPLY_TIMEOUT_DEFAULT 5
+
 struct AuthResponse {
     e_DbCommand command;
+    // Echo of DatabaseMsg::roomId; shared reply queues route on it.
+    uint16_t roomId;
 
     union {
         struct {
@@ -190,6 +289,8 @@ struct AuthResponse {
         } auth;
 
         SystemSettings settings;
+        uint32_t occupancy;
+        Data_PresentTags presentTags;
     } payload;
 };
 
@@ -0,0 +1,136 @@
+/*
+ * INI parsing and typed lookups.
+ */
+
+#include "C_Config.h"
+#include "C_Logger.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+bool C_Config::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return loadText(buffer.str(), path.c_str());
+}
+
+bool C_Config::loadText(const std::string& text, const char* origin) {
+    std::map<std::string, std::map<std::string, std::string>> values;
+    std::vector<std::string> order;
+    std::string section;
+    std::istringstream in(text);
+    std::string raw;
+    int lineNo = 0;
+
+    while (std::getline(in, raw)) {
+        ++lineNo;
+        std::string line = trim(raw);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+
+        if (line[0] == '[') {
+            if (line.back() != ']') {
+                LOG_ERROR("[Config] %s:%d: secção mal formada", origin, lineNo);
+                return false;
+            }
+            section = trim(line.substr(1, line.size() - 2));
+            if (values.find(section) == values.end()) {
+                values[section];
+                order.push_back(section);
+            }
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            LOG_ERROR("[Config] %s:%d: esperado 'chave = valor'", origin, lineNo);
+            return false;
+        }
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        // Trailing comments after the value.
+        size_t hash = value.find(" #");
+        if (hash != std::string::npos) value = trim(value.substr(0, hash));
+        if (key.empty()) {
+            LOG_ERROR("[Config] %s:%d: chave vazia", origin, lineNo);
+            return false;
+        }
+        if (values.find(section) == values.end()) order.push_back(section);
+        values[section][key] = value;
+    }
+
+    m_values.swap(values);
+    m_sections.swap(order);
+    return true;
+}
+
+bool C_Config::has(const std::string& section, const std::string& key) const {
+    auto s = m_values.find(section);
+    return s != m_values.end() && s->second.find(key) != s->second.end();
+}
+
+std::string C_Config::getString(const std::string& section, const std::string& key,
+                                const std::string& def) const {
+    auto s = m_values.find(section);
+    if (s == m_values.end()) return def;
+    auto k = s->second.find(key);
+    return (k == s->second.end()) ? def : k->second;
+}
+
+int C_Config::getInt(const std::string& section, const std::string& key, int def) const {
+    std::string value = getString(section, key, "");
+    if (value.empty()) return def;
+    char* end = nullptr;
+    long v = std::strtol(value.c_str(), &end, 0);
+    if (*end != '\0') {
+        LOG_WARN("[Config] [%s] %s = '%s' inválido, a usar %d", section.c_str(), key.c_str(), value.c_str(), def);
+        return def;
+    }
+    return static_cast<int>(v);
+}
+
+double C_Config::getDouble(const std::string& section, const std::string& key, double def) const {
+    std::string value = getString(section, key, "");
+    if (value.empty()) return def;
+    char* end = nullptr;
+    double v = std::strtod(value.c_str(), &end);
+    if (*end != '\0') {
+        LOG_WARN("[Config] [%s] %s = '%s' inválido, a usar %g", section.c_str(), key.c_str(), value.c_str(), def);
+        return def;
+    }
+    return v;
+}
+
+std::vector<std::string> C_Config::sections(const std::string& prefix) const {
+    std::vector<std::string> out;
+    for (const std::string& name : m_sections) {
+        if (name.size() > prefix.size() + 1 &&
+            name.compare(0, prefix.size(), prefix) == 0 &&
+            name[prefix.size()] == ' ') {
+            out.push_back(name);
+        }
+    }
+    return out;
+}
+
+std::vector<std::string> C_Config::changedSections(const C_Config& other) const {
+    std::vector<std::string> out;
+    for (const auto& entry : m_values) {
+        auto o = other.m_values.find(entry.first);
+        if (o == other.m_values.end() || o->second != entry.second) out.push_back(entry.first);
+    }
+    for (const auto& entry : other.m_values) {
+        if (m_values.find(entry.first) == m_values.end()) out.push_back(entry.first);
+    }
+    return out;
+}
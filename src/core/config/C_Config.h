@@ -0,0 +1,41 @@
+#ifndef C_CONFIG_H
+#define C_CONFIG_H
+
+/*
+ * Minimal INI reader: [section] headers, key = value lines, '#'/';' comments.
+ * Section and key names are case-sensitive; later duplicates win.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Single configuration file shared by the launcher and the three daemons.
+#define SYSTEM_CONFIG_PATH   "/etc/secureasset/secureasset.conf"
+
+class C_Config {
+    // section -> (key -> value); sections keep file order for iteration.
+    std::map<std::string, std::map<std::string, std::string>> m_values;
+    std::vector<std::string> m_sections;
+
+public:
+    C_Config() = default;
+
+    // False (and no change) if the file cannot be read or does not parse.
+    bool load(const std::string& path);
+    bool loadText(const std::string& text, const char* origin);
+
+    bool has(const std::string& section, const std::string& key) const;
+    std::string getString(const std::string& section, const std::string& key,
+                          const std::string& def) const;
+    int getInt(const std::string& section, const std::string& key, int def) const;
+    double getDouble(const std::string& section, const std::string& key, double def) const;
+
+    // Sections named "<prefix> <id>" (e.g. "room 2"), in file order.
+    std::vector<std::string> sections(const std::string& prefix) const;
+
+    // Sections added, removed or with any key changed relative to 'other'.
+    std::vector<std::string> changedSections(const C_Config& other) const;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Configuration hot reload: inotify watch, re-parse and per-section notification.
+ */
+
+#include "C_ConfigWatch.h"
+#include "C_Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Editors write in several steps; reload once the burst is over.
+static constexpr int SETTLE_MS = 100;
+
+C_ConfigWatch::C_ConfigWatch(const std::string& path)
+    : m_path(path),
+      m_fd(-1) {
+    size_t slash = path.find_last_of('/');
+    m_dir = (slash == std::string::npos) ? "." : path.substr(0, slash);
+    m_file = (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+C_ConfigWatch::~C_ConfigWatch() {
+    if (m_fd >= 0) close(m_fd);
+}
+
+bool C_ConfigWatch::load() {
+    if (access(m_path.c_str(), R_OK) != 0) {
+        LOG_INFO("[Config] %s ausente, a usar valores por omissão", m_path.c_str());
+        return false;
+    }
+    if (!m_config.load(m_path)) {
+        LOG_ERROR("[Config] %s inválido, a usar valores por omissão", m_path.c_str());
+        return false;
+    }
+    LOG_INFO("[Config] Configuração carregada de %s", m_path.c_str());
+    return true;
+}
+
+void C_ConfigWatch::subscribe(const std::string& section, ApplyFn apply) {
+    m_subscribers.push_back(S_Subscriber{section, std::move(apply)});
+}
+
+void C_ConfigWatch::restartOnly(const std::string& section) {
+    m_restartOnly.push_back(section);
+}
+
+bool C_ConfigWatch::watch() {
+    if (m_fd >= 0) return true;
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        LOG_ERROR("[Config] inotify_init1: %s", strerror(errno));
+        return false;
+    }
+    if (inotify_add_watch(m_fd, m_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        LOG_WARN("[Config] Sem recarga automática (%s: %s)", m_dir.c_str(), strerror(errno));
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool C_ConfigWatch::matches(const std::string& pattern, const std::string& section) {
+    if (section == pattern) return true;
+    return section.size() > pattern.size() &&
+           section.compare(0, pattern.size(), pattern) == 0 &&
+           section[pattern.size()] == ' ';
+}
+
+bool C_ConfigWatch::drainEvents() {
+    alignas(struct inotify_event) char buf[4096];
+    bool ours = false;
+    for (;;) {
+        ssize_t n = read(m_fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        for (ssize_t off = 0; off < n; ) {
+            const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(buf + off);
+            if (ev->len > 0 && m_file == ev->name) ours = true;
+            off += static_cast<ssize_t>(sizeof(struct inotify_event) + ev->len);
+        }
+    }
+    return ours;
+}
+
+bool C_ConfigWatch::poll(int timeoutMs) {
+    if (m_fd < 0) {
+        if (timeoutMs > 0) usleep(static_cast<useconds_t>(timeoutMs) * 1000);
+        return false;
+    }
+
+    struct pollfd pfd = {m_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, timeoutMs) <= 0 || !drainEvents()) return false;
+
+    while (::poll(&pfd, 1, SETTLE_MS) > 0) drainEvents();
+    reload();
+    return true;
+}
+
+void C_ConfigWatch::reload() {
+    C_Config fresh;
+    if (access(m_path.c_str(), R_OK) != 0) {
+        // Removed (or mid-rename): keep running with what is applied.
+        return;
+    }
+    if (!fresh.load(m_path)) {
+        LOG_ERROR("[Config] %s inválido, configuração atual mantida", m_path.c_str());
+        return;
+    }
+
+    std::vector<std::string> changed = fresh.changedSections(m_config);
+    if (changed.empty()) return;
+
+    for (const std::string& section : changed) {
+        for (const std::string& pattern : m_restartOnly) {
+            if (matches(pattern, section)) {
+                LOG_WARN("[Config] [%s] alterada: aplicada apenas no próximo arranque", section.c_str());
+                break;
+            }
+        }
+    }
+
+    m_config = fresh;
+
+    // Each subscriber once, however many of its sections changed.
+    for (const S_Subscriber& sub : m_subscribers) {
+        for (const std::string& section : changed) {
+            if (matches(sub.section, section)) {
+                LOG_INFO("[Config] [%s] alterada: a aplicar", section.c_str());
+                sub.apply(m_config);
+                break;
+            }
+        }
+    }
+}
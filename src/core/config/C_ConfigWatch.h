@@ -0,0 +1,63 @@
+#ifndef C_CONFIGWATCH_H
+#define C_CONFIGWATCH_H
+
+/*
+ * Configuration file with inotify hot reload.
+ * The directory is watched (editors replace the file by rename); on a change the
+ * file is re-parsed and only subscribers of changed sections are called. A file
+ * that does not parse keeps the running configuration. Sections marked restart-only
+ * are reported, never applied live.
+ */
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "C_Config.h"
+
+class C_ConfigWatch {
+public:
+    typedef std::function<void(const C_Config&)> ApplyFn;
+
+    explicit C_ConfigWatch(const std::string& path = SYSTEM_CONFIG_PATH);
+    ~C_ConfigWatch();
+
+    C_ConfigWatch(const C_ConfigWatch&) = delete;
+    C_ConfigWatch& operator=(const C_ConfigWatch&) = delete;
+
+    // Initial load; false (empty config, all defaults) if missing or invalid.
+    bool load();
+    const C_Config& config() const { return m_config; }
+    const std::string& path() const { return m_path; }
+
+    // Section names match exactly or as a prefix ("room" matches "room 2").
+    void subscribe(const std::string& section, ApplyFn apply);
+    void restartOnly(const std::string& section);
+
+    // Start inotify; false if the config directory cannot be watched.
+    bool watch();
+    int fd() const { return m_fd; }
+
+    // Wait up to timeoutMs for a change; reload and notify. True if reloaded.
+    bool poll(int timeoutMs);
+
+private:
+    struct S_Subscriber {
+        std::string section;
+        ApplyFn apply;
+    };
+
+    std::string m_path;
+    std::string m_dir;
+    std::string m_file;
+    C_Config m_config;
+    std::vector<S_Subscriber> m_subscribers;
+    std::vector<std::string> m_restartOnly;
+    int m_fd;
+
+    bool drainEvents();
+    void reload();
+    static bool matches(const std::string& pattern, const std::string& section);
+};
+
+#endif
@@ -0,0 +1,256 @@
+/*
+ * Hardware map: defaults, configuration parsing and validation.
+ */
+
+#include "C_SiteMap.h"
+#include "C_Config.h"
+#include "C_Logger.h"
+#include <cmath>
+#include <cstdlib>
+
+static const char* const IRQ_KEYS[IRQ_INPUT_COUNT] = {
+    "reed_irq_pin", "pir_irq_pin", "rfid_entry_irq_pin", "rfid_exit_irq_pin"
+};
+
+// Key prefixes of the debounce settings, in signal order (see SITE_INPUT_KINDS).
+static const char* const INPUT_KEYS[SITE_INPUT_KINDS] = {
+    "vault_reed", "room_reed", "pir", "fingerprint", "rfid_entry", "rfid_exit"
+};
+
+// Reed switches bounce for a few ms; the PIR retriggers while someone moves.
+static const S_Debounce DEBOUNCE_REED = {50, 300, 1};
+static const S_Debounce DEBOUNCE_PIR  = {500, 2000, 1};
+static const S_Debounce DEBOUNCE_NONE = {0, 0, 1};
+
+static S_RoomMap defaultRoom() {
+    S_RoomMap room{};
+    room.id = SITE_DEFAULT_ROOM_ID;
+    room.rfidEntryUart = UART_RFID_ENTRY;
+    room.rfidExitUart = UART_RFID_EXIT;
+    room.servoPwmChip = PWM_CHIP;
+    room.servoPwmChannel = PWM_CHANNEL_SERVO_ROOM;
+    for (int i = 0; i < IRQ_INPUT_COUNT; ++i) room.irqPin[i] = -1;
+    return room;
+}
+
+// "room 3" -> 3; 0 when the suffix is not a valid ID.
+static uint16_t sectionId(const std::string& section) {
+    size_t space = section.find(' ');
+    if (space == std::string::npos) return 0;
+    char* end = nullptr;
+    long id = std::strtol(section.c_str() + space + 1, &end, 10);
+    if (*end != '\0' || id <= 0 || id > 0xFFFF) return 0;
+    return static_cast<uint16_t>(id);
+}
+
+C_SiteMap::C_SiteMap()
+    : gpioBackend(GPIO_DEFAULT_BACKEND),
+      gpioChip(GPIO_CHIP),
+      irqSource(IRQ_SOURCE_DRIVER),
+      irqEdge(EDGE_RISING),
+      uart(),
+      sht30Mode(SHT30_PERIODIC),
+      sht30Rate(SHT30_MPS_1),
+      i2cBus(I2C_BUS),
+      pwmChip(PWM_CHIP),
+      fanPin(PIN_FAN),
+      alarmLedPin(PIN_ALARM_LED),
+      alarmBuzzerPin(PIN_ALARM_BUZZER),
+      rooms(1, defaultRoom()),
+      vault{SITE_DEFAULT_VAULT_ID, SITE_DEFAULT_ROOM_ID, UART_FINGERPRINT, PIN_FINGERPRINT_RST,
+            UART_YRM1001, PIN_YRM1001_ENABLE, PWM_CHIP, PWM_CHANNEL_SERVO_VAULT, -1, -1,
+            0, 0, S_InventoryOptions()} {
+    for (S_Debounce& d : debounce) d = DEBOUNCE_NONE;
+    debounce[0] = DEBOUNCE_REED;
+    debounce[1] = DEBOUNCE_REED;
+    debounce[2] = DEBOUNCE_PIR;
+}
+
+bool C_SiteMap::load(const C_Config& config) {
+    C_SiteMap map;
+
+    std::string backend = config.getString("site", "gpio_backend", "");
+    if (backend == "chardev") map.gpioBackend = GPIO_BACKEND_CHARDEV;
+    else if (backend == "sysfs") map.gpioBackend = GPIO_BACKEND_SYSFS;
+    else if (!backend.empty()) {
+        LOG_ERROR("[SiteMap] gpio_backend '%s' inválido (sysfs|chardev)", backend.c_str());
+        return false;
+    }
+    map.gpioChip = config.getInt("site", "gpio_chip", map.gpioChip);
+
+    std::string source = config.getString("site", "irq_source", "driver");
+    if (source == "gpio") map.irqSource = IRQ_SOURCE_GPIO;
+    else if (source != "driver") {
+        LOG_ERROR("[SiteMap] irq_source '%s' inválido (driver|gpio)", source.c_str());
+        return false;
+    }
+    std::string edge = config.getString("site", "irq_edge", "rising");
+    if (edge == "falling") map.irqEdge = EDGE_FALLING;
+    else if (edge == "both") map.irqEdge = EDGE_BOTH;
+    else if (edge != "rising") {
+        LOG_ERROR("[SiteMap] irq_edge '%s' inválido (rising|falling|both)", edge.c_str());
+        return false;
+    }
+    std::string timing = config.getString("site", "uart_timing", "frame");
+    if (timing == "stream") map.uart.timing = UART_TIMING_STREAM;
+    else if (timing != "frame") {
+        LOG_ERROR("[SiteMap] uart_timing '%s' inválido (frame|stream)", timing.c_str());
+        return false;
+    }
+    map.uart.lowLatency = config.getInt("site", "uart_low_latency", 0) != 0;
+    map.uart.rxTrigger = config.getInt("site", "uart_rx_trigger", map.uart.rxTrigger);
+    std::string shtMode = config.getString("site", "sht30_mode", "periodic");
+    if (shtMode == "single") map.sht30Mode = SHT30_SINGLE_SHOT;
+    else if (shtMode != "periodic") {
+        LOG_ERROR("[SiteMap] sht30_mode '%s' inválido (periodic|single)", shtMode.c_str());
+        return false;
+    }
+    std::string mps = config.getString("site", "sht30_mps", "1");
+    static const char* const MPS_NAMES[] = {"0.5", "1", "2", "4", "10"};
+    bool mpsOk = false;
+    for (int i = 0; i <= SHT30_MPS_10; ++i) {
+        if (mps == MPS_NAMES[i]) {
+            map.sht30Rate = static_cast<Sht30Rate_enum>(i);
+            mpsOk = true;
+        }
+    }
+    if (!mpsOk) {
+        LOG_ERROR("[SiteMap] sht30_mps '%s' inválido (0.5|1|2|4|10)", mps.c_str());
+        return false;
+    }
+    map.i2cBus = config.getInt("site", "i2c_bus", map.i2cBus);
+    map.pwmChip = config.getInt("site", "pwm_chip", map.pwmChip);
+    map.fanPin = config.getInt("site", "fan_pin", map.fanPin);
+    map.alarmLedPin = config.getInt("site", "alarm_led_pin", map.alarmLedPin);
+    map.alarmBuzzerPin = config.getInt("site", "alarm_buzzer_pin", map.alarmBuzzerPin);
+
+    for (int i = 0; i < SITE_INPUT_KINDS; ++i) {
+        S_Debounce& d = map.debounce[i];
+        std::string key = INPUT_KEYS[i];
+        d.holdoffMs = config.getInt("site", key + "_holdoff_ms", d.holdoffMs);
+        d.minIntervalMs = config.getInt("site", key + "_min_interval_ms", d.minIntervalMs);
+        d.minEdges = config.getInt("site", key + "_min_edges", d.minEdges);
+        if (d.holdoffMs < 0 || d.minIntervalMs < 0 || d.minEdges < 1) {
+            LOG_ERROR("[SiteMap] Debounce de %s inválido (ms >= 0, min_edges >= 1)", INPUT_KEYS[i]);
+            return false;
+        }
+    }
+
+    std::vector<std::string> roomSections = config.sections("room");
+    if (!roomSections.empty()) map.rooms.clear();
+    else map.rooms[0].servoPwmChip = map.pwmChip;
+
+    for (const std::string& section : roomSections) {
+        S_RoomMap room = defaultRoom();
+        room.id = sectionId(section);
+        if (room.id == 0 || map.roomIndexById(room.id) >= 0) {
+            LOG_ERROR("[SiteMap] [%s]: ID inválido ou repetido", section.c_str());
+            return false;
+        }
+        if (map.rooms.size() >= SITE_MAX_ROOMS) {
+            LOG_ERROR("[SiteMap] Máximo de %d salas por controlador", SITE_MAX_ROOMS);
+            return false;
+        }
+        room.rfidEntryUart = config.getInt(section, "rfid_entry_uart", room.rfidEntryUart);
+        room.rfidExitUart = config.getInt(section, "rfid_exit_uart", room.rfidExitUart);
+        room.servoPwmChip = config.getInt(section, "servo_pwm_chip", map.pwmChip);
+        room.servoPwmChannel = config.getInt(section, "servo_pwm_channel", room.servoPwmChannel);
+        for (int i = 0; i < IRQ_INPUT_COUNT; ++i) {
+            room.irqPin[i] = config.getInt(section, IRQ_KEYS[i], -1);
+        }
+        map.rooms.push_back(room);
+    }
+
+    // Several rooms cannot share "any pin" routing for the same input; GPIO
+    // edge inputs need the actual line of every input.
+    if (map.rooms.size() > 1 || map.irqSource == IRQ_SOURCE_GPIO) {
+        for (const S_RoomMap& room : map.rooms) {
+            for (int i = 0; i < IRQ_INPUT_COUNT; ++i) {
+                if (room.irqPin[i] < 0) {
+                    LOG_ERROR("[SiteMap] [room %u]: %s obrigatório (várias salas ou irq_source = gpio)", room.id, IRQ_KEYS[i]);
+                    return false;
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> vaultSections = config.sections("vault");
+    // One vault per controller: its devices, monitors and threads are single.
+    if (vaultSections.size() > 1) {
+        LOG_ERROR("[SiteMap] %zu secções [vault]: só é suportado um cofre por controlador",
+                  vaultSections.size());
+        return false;
+    }
+    if (!vaultSections.empty()) {
+        const std::string& section = vaultSections[0];
+        S_VaultMap& v = map.vault;
+        v.id = sectionId(section);
+        if (v.id == 0) {
+            LOG_ERROR("[SiteMap] [%s]: ID inválido", section.c_str());
+            return false;
+        }
+        v.roomId = static_cast<uint16_t>(config.getInt(section, "room", map.rooms[0].id));
+        v.fingerprintUart = config.getInt(section, "fingerprint_uart", v.fingerprintUart);
+        v.fingerprintRstPin = config.getInt(section, "fingerprint_rst_pin", v.fingerprintRstPin);
+        v.uhfUart = config.getInt(section, "uhf_uart", v.uhfUart);
+        v.uhfEnablePin = config.getInt(section, "uhf_enable_pin", v.uhfEnablePin);
+        v.servoPwmChip = config.getInt(section, "servo_pwm_chip", map.pwmChip);
+        v.servoPwmChannel = config.getInt(section, "servo_pwm_channel", v.servoPwmChannel);
+        v.reedIrqPin = config.getInt(section, "reed_irq_pin", -1);
+        v.fingerprintIrqPin = config.getInt(section, "fingerprint_irq_pin", -1);
+
+        S_InventoryOptions& uhf = v.uhf;
+        double dbm = config.getDouble(section, "uhf_power_dbm", uhf.powerCentiDbm / 100.0);
+        if (dbm < 0 || dbm > 33) {
+            LOG_ERROR("[SiteMap] [%s]: uhf_power_dbm %.2f fora de 0..33", section.c_str(), dbm);
+            return false;
+        }
+        uhf.powerCentiDbm = static_cast<uint16_t>(std::lround(dbm * 100));
+        uhf.maxScanMs = config.getInt(section, "uhf_max_scan_ms", uhf.maxScanMs);
+        uhf.minIdleMs = config.getInt(section, "uhf_min_idle_ms", uhf.minIdleMs);
+        uhf.confidence = config.getDouble(section, "uhf_confidence", uhf.confidence);
+        uhf.expectedTags = config.getInt(section, "uhf_expected_tags", uhf.expectedTags);
+        uhf.keepWarmMs = config.getInt(section, "uhf_keep_warm_ms", uhf.keepWarmMs);
+        v.uhfBackgroundMs = config.getInt(section, "uhf_background_ms", 0);
+        // A tag must miss a few rounds before it is reported gone.
+        v.uhfMissingMs = config.getInt(section, "uhf_missing_ms", 3 * v.uhfBackgroundMs);
+        if (uhf.maxScanMs <= 0 || uhf.minIdleMs < 0 || uhf.expectedTags < 0 || uhf.keepWarmMs < 0 ||
+            v.uhfBackgroundMs < 0 || v.uhfMissingMs < 0 ||
+            uhf.confidence <= 0 || uhf.confidence >= 1) {
+            LOG_ERROR("[SiteMap] [%s]: parâmetros uhf_* inválidos", section.c_str());
+            return false;
+        }
+    } else {
+        map.vault.roomId = map.rooms[0].id;
+        map.vault.servoPwmChip = map.pwmChip;
+    }
+    if (map.irqSource == IRQ_SOURCE_GPIO &&
+        (map.vault.reedIrqPin < 0 || map.vault.fingerprintIrqPin < 0)) {
+        LOG_ERROR("[SiteMap] irq_source = gpio: reed_irq_pin e fingerprint_irq_pin do cofre obrigatórios");
+        return false;
+    }
+    if (map.roomIndexById(map.vault.roomId) < 0) {
+        LOG_ERROR("[SiteMap] Cofre %u: sala %u não existe", map.vault.id, map.vault.roomId);
+        return false;
+    }
+
+    *this = map;
+    return true;
+}
+
+int C_SiteMap::roomIndexFor(IrqInput_enum input, int pin) const {
+    if (input >= IRQ_INPUT_COUNT) return -1;
+    int wildcard = -1;
+    for (size_t i = 0; i < rooms.size(); ++i) {
+        if (rooms[i].irqPin[input] == pin) return static_cast<int>(i);
+        if (rooms[i].irqPin[input] < 0 && wildcard < 0) wildcard = static_cast<int>(i);
+    }
+    return wildcard;
+}
+
+int C_SiteMap::roomIndexById(uint16_t id) const {
+    for (size_t i = 0; i < rooms.size(); ++i) {
+        if (rooms[i].id == id) return static_cast<int>(i);
+    }
+    return -1;
+}
@@ -0,0 +1,129 @@
+#ifndef C_SITEMAP_H
+#define C_SITEMAP_H
+
+/*
+ * Hardware map of the controller: shared devices, rooms and the vault.
+ * Built from the [site], [room <id>] and [vault <id>] sections of the system
+ * configuration; anything not configured keeps the single-room defaults below.
+ * Rooms scale to SITE_MAX_ROOMS; a map with more than one vault is rejected.
+ * Room/vault IDs are the ones stored by the database (Logs.RoomID/VaultID).
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "C_GPIO.h"
+#include "C_UART.h"
+#include "C_TH_SHT30.h"
+#include "C_YRM1001.h"
+
+class C_Config;
+
+// Defaults: the original single room/vault board.
+#define PIN_FINGERPRINT_RST  26
+#define PIN_YRM1001_ENABLE   25
+#define PIN_FAN              18
+#define PIN_ALARM_LED        24
+#define PIN_ALARM_BUZZER     23
+
+#define UART_RFID_ENTRY      2
+#define UART_RFID_EXIT       3
+#define UART_FINGERPRINT     0
+#define UART_YRM1001         4
+
+#define I2C_BUS              1
+#define GPIO_CHIP            0
+
+#define PWM_CHIP             0
+#define PWM_CHANNEL_SERVO_ROOM  0
+#define PWM_CHANNEL_SERVO_VAULT 1
+
+#define SITE_DEFAULT_ROOM_ID  1
+#define SITE_DEFAULT_VAULT_ID 1
+#define SITE_MAX_ROOMS        8
+
+// IRQ inputs reported by the kernel driver, routed to a room by pin.
+enum IrqInput_enum : uint8_t {
+    IRQ_ROOM_REED = 0,
+    IRQ_ROOM_PIR,
+    IRQ_RFID_ENTRY,
+    IRQ_RFID_EXIT,
+    IRQ_INPUT_COUNT
+};
+
+// Where room/vault inputs come from: the IRQ kernel module (RT signals) or
+// GPIO edge events read directly by the core (every input pin must be set).
+enum IrqSource_enum : uint8_t {
+    IRQ_SOURCE_DRIVER = 0,
+    IRQ_SOURCE_GPIO
+};
+
+#define IRQ_MODULE_DEFAULT   "/root/my_irq.ko"
+
+// Hardware input kinds, in RT signal order (43..48): vault reed, room reed,
+// PIR, fingerprint, RFID entry, RFID exit.
+#define SITE_INPUT_KINDS     6
+
+// Debounce settings for one input kind (times in ms).
+struct S_Debounce {
+    int holdoffMs;      // Window after an accepted edge where further edges are merged.
+    int minIntervalMs;  // Minimum time between two delivered events.
+    int minEdges;       // Edges needed inside the window before the event is delivered.
+};
+
+struct S_RoomMap {
+    uint16_t id;
+    int rfidEntryUart;
+    int rfidExitUart;
+    int servoPwmChip;
+    int servoPwmChannel;
+    int irqPin[IRQ_INPUT_COUNT];   // -1: any pin (single-room wiring).
+};
+
+struct S_VaultMap {
+    uint16_t id;
+    uint16_t roomId;
+    int fingerprintUart;
+    int fingerprintRstPin;
+    int uhfUart;
+    int uhfEnablePin;
+    int servoPwmChip;
+    int servoPwmChannel;
+    int reedIrqPin;                // Edge inputs (IRQ_SOURCE_GPIO only).
+    int fingerprintIrqPin;
+    int uhfBackgroundMs;           // Background inventory period; 0 = only on vault close.
+    int uhfMissingMs;              // Unread this long -> tag reported missing.
+    S_InventoryOptions uhf;        // UHF inventory round tuning.
+};
+
+class C_SiteMap {
+public:
+    GpioBackend_enum gpioBackend;
+    int gpioChip;
+    IrqSource_enum irqSource;
+    GPIO_EDGE irqEdge;
+    S_UartOptions uart;    // Read timing/latency of every reader UART.
+    Sht30Mode_enum sht30Mode;
+    Sht30Rate_enum sht30Rate;
+    int i2cBus;
+    int pwmChip;
+    int fanPin;
+    int alarmLedPin;
+    int alarmBuzzerPin;
+    S_Debounce debounce[SITE_INPUT_KINDS];
+    std::vector<S_RoomMap> rooms;
+    S_VaultMap vault;
+
+    // Single room + vault with the default wiring.
+    C_SiteMap();
+
+    // Replace defaults with the configured map; false keeps the defaults.
+    bool load(const C_Config& config);
+
+    // Room index for an IRQ (exact pin first, then a room wired as "any"); -1 if none.
+    int roomIndexFor(IrqInput_enum input, int pin) const;
+    int roomIndexById(uint16_t id) const;
+};
+
+#endif
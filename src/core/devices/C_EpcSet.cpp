@@ -0,0 +1,67 @@
+/*
+ * EPC hash set (open addressing, linear probing).
+ */
+
+#include "C_EpcSet.h"
+#include <cstring>
+
+C_EpcSet::C_EpcSet(size_t capacity)
+    : m_mask(0),
+      m_size(0) {
+    size_t slots = 16;
+    while (slots < capacity * 2) slots <<= 1;
+    m_slots.assign(slots, S_Slot());
+    m_mask = slots - 1;
+}
+
+uint64_t C_EpcSet::hash(const uint8_t* epc) {
+    // Serialized EPCs differ mostly in the last bytes: mix both halves.
+    uint64_t hi;
+    uint32_t lo;
+    std::memcpy(&hi, epc, sizeof(hi));
+    std::memcpy(&lo, epc + sizeof(hi), sizeof(lo));
+    uint64_t h = hi ^ (static_cast<uint64_t>(lo) * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+size_t C_EpcSet::find(const uint8_t* epc) const {
+    size_t i = hash(epc) & m_mask;
+    while (m_slots[i].used && std::memcmp(m_slots[i].epc, epc, INVENTORY_EPC_BYTES) != 0) {
+        i = (i + 1) & m_mask;
+    }
+    return i;
+}
+
+bool C_EpcSet::insert(const uint8_t* epc) {
+    size_t i = find(epc);
+    if (m_slots[i].used) return false;
+
+    std::memcpy(m_slots[i].epc, epc, INVENTORY_EPC_BYTES);
+    m_slots[i].used = true;
+    if (++m_size * 2 > m_slots.size()) grow();
+    return true;
+}
+
+bool C_EpcSet::contains(const uint8_t* epc) const {
+    return m_slots[find(epc)].used;
+}
+
+void C_EpcSet::clear() {
+    if (m_size == 0) return;
+    for (S_Slot& slot : m_slots) slot.used = false;
+    m_size = 0;
+}
+
+void C_EpcSet::grow() {
+    std::vector<S_Slot> old;
+    old.swap(m_slots);
+    m_slots.assign(old.size() * 2, S_Slot());
+    m_mask = m_slots.size() - 1;
+    for (const S_Slot& slot : old) {
+        if (!slot.used) continue;
+        m_slots[find(slot.epc)] = slot;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef C_EPCSET_H
+#define C_EPCSET_H
+
+/*
+ * Set of 96-bit EPCs for deduplication during an inventory round.
+ * Open addressing with linear probing over a power-of-two table kept at most
+ * half full; clear() keeps the table, so steady-state rounds do not allocate.
+ * Not thread-safe: owned by the reader's scan.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SharedTypes.h"
+
+class C_EpcSet {
+public:
+    explicit C_EpcSet(size_t capacity = 64);
+
+    // True if the EPC was not in the set yet.
+    bool insert(const uint8_t* epc);
+    bool contains(const uint8_t* epc) const;
+    void clear();
+    size_t size() const { return m_size; }
+
+private:
+    struct S_Slot {
+        uint8_t epc[INVENTORY_EPC_BYTES];
+        bool used;
+    };
+
+    std::vector<S_Slot> m_slots;
+    size_t m_mask;
+    size_t m_size;
+
+    static uint64_t hash(const uint8_t* epc);
+    // Slot holding the EPC, or the free slot where it belongs.
+    size_t find(const uint8_t* epc) const;
+    void grow();
+};
+
+#endif
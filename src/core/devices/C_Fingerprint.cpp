@@ -2,11 +2,10 @@
  * Fingerprint sensor implementation (command/response protocol).
  */
 
-#include <poll.h>
 #include "C_Fingerprint.h"
 #include "C_UART.h"
 #include "C_GPIO.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <unistd.h> 
 
 C_Fingerprint::C_Fingerprint(C_UART& uart, C_GPIO& rst)
@@ -20,7 +19,9 @@ bool C_Fingerprint::init() {
     // Initialize reset GPIO and UART.
     if (!m_rst.init()) return false;
     if (!m_uart.openPort()) return false;
+    m_uart.setFrameSize(FINGER_FRAME_SIZE);
     if (!m_uart.configPort(19200, 8, 'N')) return false; 
+    m_uart.setDecoder(&m_decoder);
     return true;
 }
 
@@ -44,7 +45,7 @@ bool C_Fingerprint::read(SensorData* data) {
         if (status == 1 || status == 2 || status == 3) {
             data->data.fingerprint.authenticated = true;
             data->data.fingerprint.userID = (idHigh << 8) | idLow;
-            std::cout << "[Finger] User ID Verified: " << data->data.fingerprint.userID << std::endl;
+            LOG_INFO("[Finger] User ID Verified: %d", data->data.fingerprint.userID);
         } else {
             // Unknown/failed authentication.
             data->data.fingerprint.authenticated = false;
@@ -61,15 +62,15 @@ bool C_Fingerprint::addUser(const int userID) const {
     const uint8_t p2 = userID & 0xFF;
     const uint8_t perm = 1;
 
-    std::cout << "[Finger] Step 1/3: Place finger..." << std::endl;
+    LOG_INFO("[Finger] Step 1/3: Place finger...");
     if (executeCommand(CMD_ADD_1, p1, p2, perm, nullptr,
         nullptr, 10.0) != ACK_SUCCESS) return false;
 
-    std::cout << "[Finger] Step 2/3: Place finger again..." << std::endl;
+    LOG_INFO("[Finger] Step 2/3: Place finger again...");
     if (executeCommand(CMD_ADD_2, p1, p2, perm, nullptr,
         nullptr, 10.0) != ACK_SUCCESS) return false;
 
-    std::cout << "[Finger] Step 3/3: Final confirmation..." << std::endl;
+    LOG_INFO("[Finger] Step 3/3: Final confirmation...");
     if (executeCommand(CMD_ADD_3, p1, p2, perm, nullptr,
         nullptr, 10.0) != ACK_SUCCESS) return false;
 
@@ -88,23 +89,11 @@ bool C_Fingerprint::deleteUser(const int userID) const {
 uint8_t C_Fingerprint::executeCommand(const uint8_t cmd, const uint8_t p1, const uint8_t p2, const uint8_t p3,
     uint8_t* outHigh, uint8_t* outLow, const float timeoutSec) const {
 
-    std::cout << "[DEBUG] >> A entrar em executeCommand (POLL VERSION)..." << std::endl;
-
-    // Flush any pending bytes in UART RX.
-    std::cout << "[DEBUG] A limpar buffer (Flush)..." << std::endl;
-    uint8_t trash[64];
-    int flushCount = 0;
-    while(m_uart.readBuffer(trash, 64) > 0) {
-        flushCount++;
-        if (flushCount > 10) {
-            std::cout << "[ERRO] Loop infinito no Flush!" << std::endl;
-            break;
-        }
-    }
-    if (flushCount > 0) std::cout << "[DEBUG] Lixo limpo." << std::endl;
+    // Drop anything pending so the next frame is this command's answer.
+    m_uart.discardInput();
 
     // Build command frame.
-    uint8_t tx[8];
+    uint8_t tx[FINGER_FRAME_SIZE];
     tx[0] = FINGER_HEAD;
     tx[1] = cmd;
     tx[2] = p1; tx[3] = p2; tx[4] = p3;
@@ -112,60 +101,34 @@ uint8_t C_Fingerprint::executeCommand(const uint8_t cmd, const uint8_t p1, const
     tx[6] = tx[1] ^ tx[2] ^ tx[3] ^ tx[4] ^ tx[5]; 
     tx[7] = FINGER_TAIL;
 
-    std::cout << "[DEBUG] A enviar comando..." << std::endl;
-    m_uart.writeBuffer(tx, 8);
-
-    std::cout << "[DEBUG] A esperar resposta (Poll)..." << std::endl;
-    uint8_t rx[8];
-    int totalRead = 0;
-    struct pollfd pfd;
-    pfd.fd = m_uart.getFd();
-    pfd.events = POLLIN;     
-    int timeoutMs = static_cast<int>(timeoutSec * 1000);
-    // Poll until full response frame arrives or timeout.
-    while (totalRead < 8) {
-
-        int ret = poll(&pfd, 1, timeoutMs);
-
-        if (ret > 0) {
-            if (pfd.revents & POLLIN) {
-                int n = m_uart.readBuffer(rx + totalRead, 8 - totalRead);
-                if (n > 0) {
-                    totalRead += n;
-                    std::cout << "[DEBUG] Recebi " << n << " bytes. Total: " << totalRead << "/8" << std::endl;
-                }
-            }
-        }
-        else if (ret == 0) {
-            // Timeout waiting for response.
-            return ACK_TIMEOUT;
-        }
-        else {
-            std::cout << "[ERRO] Erro critico no Poll!" << std::endl;
-            return ACK_TIMEOUT;
-        }
-    }
-
-    std::cout << "[DEBUG] Pacote completo recebido." << std::endl;
+    LOG_DEBUG("[Finger] A enviar comando 0x%02X...", static_cast<int>(cmd));
+    m_uart.writeBuffer(tx, FINGER_FRAME_SIZE);
 
-    // Validate frame header/tail.
-    if (rx[0] != FINGER_HEAD || rx[7] != FINGER_TAIL) {
-        std::cout << "[DEBUG] Erro de Frame (Head/Tail incorretos)" << std::endl;
-        return 0xFF;
-    }
-    // Validate checksum.
-    uint8_t chk = rx[1] ^ rx[2] ^ rx[3] ^ rx[4] ^ rx[5];
-    if (rx[6] != chk) {
-        std::cout << "[DEBUG] Erro de Checksum (Calculado: " << static_cast<int>(chk) << " vs Recebido: " << static_cast<int>(rx[6]) << ")" << std::endl;
-        return 0xFF;
+    // Head/tail and checksum are verified by the decoder.
+    S_UartFrame rx;
+    if (!m_uart.waitFrame(rx, static_cast<int>(timeoutSec * 1000))) {
+        return ACK_TIMEOUT;
     }
 
     // Output user ID if requested.
-    if (outHigh) *outHigh = rx[2];
-    if (outLow)  *outLow  = rx[3];
-    std::cout << "[DEBUG] Resposta valida! Status (Q3): " << static_cast<int>(rx[4]) << std::endl;
-    return rx[4];
+    if (outHigh) *outHigh = rx.data[2];
+    if (outLow)  *outLow  = rx.data[3];
+    LOG_DEBUG("[Finger] Resposta valida! Status (Q3): %d", static_cast<int>(rx.data[4]));
+    return rx.data[4];
+
+}
 
+bool C_FingerprintDecoder::decode(C_RingBuffer& rx, S_UartFrame& frame) {
+    while (syncTo(rx, FINGER_HEAD)) {
+        if (rx.size() < FINGER_FRAME_SIZE) return false;
+        uint8_t chk = rx[1] ^ rx[2] ^ rx[3] ^ rx[4] ^ rx[5];
+        if (rx[7] == FINGER_TAIL && rx[6] == chk) {
+            take(rx, FINGER_FRAME_SIZE, frame);
+            return true;
+        }
+        reject(rx);
+    }
+    return false;
 }
 
 static constexpr uint8_t CMD_DELETE_ALL = 0x05;
@@ -6,6 +6,7 @@
  */
 
 #include "C_Sensor.h"
+#include "C_FrameDecoder.h"
 #include <stdint.h>
 
 class C_UART;
@@ -25,6 +26,14 @@ class C_GPIO;
 #define ACK_NO_USER         0x05
 #define ACK_TIMEOUT         0x08
 
+#define FINGER_FRAME_SIZE   8
+
+// Head, command, P1..P3, 0, XOR checksum, tail (same layout both ways).
+class C_FingerprintDecoder final : public C_FrameDecoder {
+public:
+    bool decode(C_RingBuffer& rx, S_UartFrame& frame) override;
+};
+
 class C_Fingerprint final : public C_Sensor {
 public:
     C_Fingerprint(C_UART& uart, C_GPIO& rst);
@@ -40,6 +49,7 @@ public:
 private:
     C_UART& m_uart;
     C_GPIO& m_rst; 
+    C_FingerprintDecoder m_decoder;
 
     uint8_t executeCommand(uint8_t cmd, uint8_t p1, uint8_t p2,
         uint8_t p3, uint8_t* outHigh, uint8_t* outLow, float timeoutSec) const;
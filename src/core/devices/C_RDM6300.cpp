@@ -4,10 +4,8 @@
 
 #include "C_RDM6300.h"
 #include "C_UART.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <cstring>
-#include <poll.h>
-#include <unistd.h>
 
 C_RDM6300::C_RDM6300(C_UART& uart)
     : C_Sensor(ID_RDM6300), m_uart(uart) {}
@@ -15,72 +13,44 @@ C_RDM6300::C_RDM6300(C_UART& uart)
 C_RDM6300::~C_RDM6300() = default;
 
 bool C_RDM6300::init() {
-    // Open UART and configure 9600 8N1.
+    // Open UART and configure 9600 8N1; tags arrive as decoded frames.
     if (!m_uart.openPort()) return false;
     
+    m_uart.setFrameSize(RDM_FRAME_SIZE);
     if (!m_uart.configPort(9600, 8, 'N')) return false;
+    m_uart.setDecoder(&m_decoder);
     return true;
 }
-bool C_RDM6300::waitForData(int timeout_ms) const {
-    // Poll UART for incoming data.
-    struct pollfd pfd;
-    pfd.fd = m_uart.getFd();
-    pfd.events = POLLIN;
-    int ret = poll(&pfd, 1, timeout_ms);
-
-    return (ret > 0);        
+
+bool C_RDM6300Decoder::decode(C_RingBuffer& rx, S_UartFrame& frame) {
+    while (syncTo(rx, RDM_STX)) {
+        if (rx.size() < RDM_FRAME_SIZE) return false;
+        char raw[RDM_FRAME_SIZE];
+        rx.copyOut(reinterpret_cast<uint8_t*>(raw), RDM_FRAME_SIZE);
+        if (raw[13] == RDM_ETX && C_RDM6300::validateChecksum(raw)) {
+            take(rx, RDM_FRAME_SIZE, frame);
+            return true;
+        }
+        reject(rx);
+    }
+    return false;
 }
 
 bool C_RDM6300::read(SensorData* data) {
-    if (!waitForData(1000)) {
-        cerr << "shit falhou" << endl;
-        return false;
-    }
-    char header = 0;
-    if (m_uart.readBuffer(&header, 1) != 1) return false;
-    
-    // Expect start-of-text marker; otherwise flush noise.
-    if (header != RDM_STX) {
-        char trash[32];
-        if (waitForData(10)) {    
-            while(m_uart.readBuffer(trash, sizeof(trash)) > 0);
-        }
+    S_UartFrame frame;
+    if (!m_uart.waitFrame(frame, RDM_READ_TIMEOUT_MS)) {
+        LOG_ERROR("[RDM6300] Timeout à espera de dados");
         return false;
     }
-    m_rawBuffer[0] = RDM_STX;
-    int bytesToRead = 13;    
-    int totalRead = 0;
-    while (totalRead < bytesToRead) {
-        if (!waitForData(100)) {
-            return false;    
-        }
 
-        int n = m_uart.readBuffer(m_rawBuffer + 1 + totalRead,
-                                 bytesToRead - totalRead);
-        if (n > 0) {
-            totalRead += n;
-        } else {
-            return false;    
-        }
-    }
-    
-    bool success = false;
-    if (m_rawBuffer[13] == RDM_ETX) {
-        if (validateChecksum(m_rawBuffer)) {
-            success = true;
-            if (data) {
-                data->type = ID_RDM6300;
-                parseTag(m_rawBuffer, data->data.rfid_single.tagID);
-            }
-        }
+    if (data) {
+        data->type = ID_RDM6300;
+        parseTag(reinterpret_cast<const char*>(frame.data), data->data.rfid_single.tagID);
     }
-    
-    // Flush any trailing bytes in the buffer.
-    if (waitForData(0)) {
-        char trash[64];
-        while(m_uart.readBuffer(trash, sizeof(trash)) > 0);
-    }
-    return success;
+
+    // The reader repeats the tag while it is held: drop the repeats.
+    m_uart.discardInput();
+    return true;
 }
 
 
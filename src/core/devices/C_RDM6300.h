@@ -6,6 +6,7 @@
  */
 
 #include "C_Sensor.h"
+#include "C_FrameDecoder.h"
 #include <stdint.h>
 
 class C_UART;
@@ -13,6 +14,13 @@ class C_UART;
 #define RDM_STX         0x02
 #define RDM_ETX         0x03
 #define RDM_FRAME_SIZE  14
+#define RDM_READ_TIMEOUT_MS 1000
+
+// STX, 10 ASCII hex tag chars, 2 ASCII hex XOR checksum, ETX.
+class C_RDM6300Decoder final : public C_FrameDecoder {
+public:
+    bool decode(C_RingBuffer& rx, S_UartFrame& frame) override;
+};
 
 class C_RDM6300 final : public C_Sensor {
 public:
@@ -23,12 +31,13 @@ public:
     bool read(SensorData* data) override;
 
 private:
+    friend class C_RDM6300Decoder;
+
     C_UART& m_uart;
-    char m_rawBuffer[RDM_FRAME_SIZE]{};
+    C_RDM6300Decoder m_decoder;
     static uint8_t asciiCharToVal(char c);
     static uint8_t hexPairToByte(char high, char low);
     static bool validateChecksum(const char* buffer);
     static void parseTag(const char* buffer, char* dest);
-    bool waitForData(int timeout_ms) const;
 };
 #endif
@@ -4,13 +4,14 @@
 
 #include "C_ServoMG996R.h"
 #include "C_PWM.h"
-#include <iostream>
+#include "C_Logger.h"
 
 
 
 
 #define DUTY_MIN 5
 #define DUTY_MAX 10
+#define SERVO_PERIOD_NS 20000000
 
 C_ServoMG996R::C_ServoMG996R(ActuatorID_enum id, C_PWM& pwm)
     : C_Actuator(id), m_pwm(pwm), m_targetAngle(0) {}
@@ -22,29 +23,19 @@ C_ServoMG996R::~C_ServoMG996R() {
 void C_ServoMG996R::stop() {
     // Disable PWM output.
     m_pwm.setEnable(false);
-    std::cout << "[Servo] Stop (PWM Disabled)" << std::endl;
+    LOG_INFO("[Servo] Stop (PWM Disabled)");
 }
 
 bool C_ServoMG996R::init() {
     // Initialize PWM and set a safe default.
     if (!m_pwm.init()) {
-        std::cerr << "[Servo] Erro: Falha no init do PWM" << std::endl;
+        LOG_ERROR("[Servo] Erro: Falha no init do PWM");
         return false;
     }
 
-    if (!m_pwm.setPeriodns(20000000)) {
-        std::cerr << "[Servo] Erro: Falha ao definir periodo" << std::endl;
-        return false;
-    }
-
-    if (!m_pwm.setEnable(true)) {
-        std::cerr << "[Servo] Erro: Falha ao ativar PWM" << std::endl;
-        return false;
-    }
-
-    // Start at a neutral duty cycle.
-    if (!m_pwm.setDutyCycle(90)) {
-        std::cerr << "[Servo] Erro: Falha ao ativar PWM" << std::endl;
+    // Period, neutral duty cycle and enable in one batch.
+    if (!m_pwm.update(SERVO_PERIOD_NS, 90, true)) {
+        LOG_ERROR("[Servo] Erro: Falha ao ativar PWM");
         return false;
     }
 
@@ -53,11 +44,6 @@ bool C_ServoMG996R::init() {
 
 bool C_ServoMG996R::set_value(uint8_t angle) {
 
-    // Ensure PWM is enabled before commanding.
-    if (!m_pwm.setEnable(true)) {
-        std::cerr << "[Servo] Erro: Nao consegui reativar o motor" << std::endl;
-        return false;
-    }
     if (angle == 0) {
         // Angle 0 is used as "disable".
         stop();  
@@ -70,10 +56,15 @@ bool C_ServoMG996R::set_value(uint8_t angle) {
     uint8_t duty = angleToDutyCycle(angle);
 
     // Convert angle to duty cycle percentage.
-    std::cout << "[Servo] Mover para " << static_cast<int>(angle) << "º (Duty " << static_cast<int>(duty) << "%)" << std::endl;
+    LOG_INFO("[Servo] Mover para %dº (Duty %d%%)", static_cast<int>(angle), static_cast<int>(duty));
 
     if (!m_pwm.setDutyCycle(duty)) {
-        std::cerr << "[Servo] Erro critico: Falha ao escrever duty cycle!" << std::endl;
+        LOG_ERROR("[Servo] Erro critico: Falha ao escrever duty cycle!");
+        return false;
+    }
+    // Re-enable after a stop(); no write when already enabled.
+    if (!m_pwm.setEnable(true)) {
+        LOG_ERROR("[Servo] Erro: Nao consegui reativar o motor");
         return false;
     }
     return true;
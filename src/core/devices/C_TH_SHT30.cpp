@@ -4,71 +4,158 @@
 
 #include "C_TH_SHT30.h"
 #include "C_I2C.h"
-#include <iostream>
+#include "C_Logger.h"
+#include <unistd.h>
+#include <chrono>
 
 
-#define CMD_MSB 0x2C
-#define CMD_LSB 0x06
+#define CMD_SINGLE_SHOT_HIGH_CS 0x2C06
+#define CMD_FETCH_DATA          0xE000
+#define CMD_BREAK               0x3093
+
+// Periodic acquisition, high repeatability, indexed by Sht30Rate_enum.
+static const uint16_t CMD_PERIODIC[] = {0x2032, 0x2130, 0x2236, 0x2334, 0x2737};
+static const int PERIOD_MS[] = {2000, 1000, 500, 250, 100};
+
+// Commands need 1 ms before the sensor accepts the next one.
+#define SHT30_CMD_GAP_US 1000
+// A cached sample older than this many periods is treated as a failed read.
+#define SHT30_STALE_PERIODS 3
+
+static int64_t nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
 
 C_TH_SHT30::C_TH_SHT30(C_I2C& i2c)
-    : C_Sensor(ID_SHT31), m_i2c(i2c)
+    : C_Sensor(ID_SHT31), m_i2c(i2c),
+      m_mode(SHT30_PERIODIC), m_rate(SHT30_MPS_1), m_running(false),
+      m_lastTemp(0.0f), m_lastHum(0.0f), m_lastMs(0), m_startMs(0)
 {
 }
 
-C_TH_SHT30::~C_TH_SHT30() = default;
+C_TH_SHT30::~C_TH_SHT30() {
+    // Leave the sensor idle (low power) rather than converting forever.
+    stopPeriodic();
+}
+
+void C_TH_SHT30::setMode(Sht30Mode_enum mode, Sht30Rate_enum rate) {
+    m_mode = mode;
+    m_rate = rate;
+}
 
 bool C_TH_SHT30::init() {
 
     // Initialize I2C bus.
     if (!m_i2c.init()) {
-        cerr << "[SHT30] Falha: Não foi possível inicializar o barramento I2C." << endl;
+        LOG_ERROR("[SHT30] Falha: Não foi possível inicializar o barramento I2C.");
         return false;
     }
+    m_running = false;
+    m_lastMs = 0;
 
+    if (m_mode == SHT30_PERIODIC) return startPeriodic();
     return true;
 }
 
-bool C_TH_SHT30::read(SensorData* data) {
-    
-    // Send measurement command.
-    
-    if (!m_i2c.writeRegister(CMD_MSB, CMD_LSB)) {
-        std::cerr << "[SHT30] ERRO: Falha ao enviar comando" << std::endl;
+bool C_TH_SHT30::startPeriodic() {
+    // A previous run (or crash) may have left periodic mode on: break first.
+    m_i2c.writeCommand(CMD_BREAK);
+    usleep(SHT30_CMD_GAP_US);
+
+    if (!m_i2c.writeCommand(CMD_PERIODIC[m_rate])) {
+        LOG_ERROR("[SHT30] ERRO: Falha ao iniciar modo periódico");
         return false;
     }
+    m_running = true;
+    m_startMs = nowMs();
+    LOG_INFO("[SHT30] Modo periódico (%d ms por amostra)", periodMs());
+    return true;
+}
 
+void C_TH_SHT30::stopPeriodic() {
+    if (!m_running) return;
+    m_i2c.writeCommand(CMD_BREAK);
+    m_running = false;
+}
+
+int C_TH_SHT30::periodMs() const {
+    return PERIOD_MS[m_rate];
+}
+
+bool C_TH_SHT30::read(SensorData* data) {
+    float temp = 0.0f;
+    float hum = 0.0f;
+
+    bool ok = (m_mode == SHT30_PERIODIC) ? readPeriodic(temp, hum) : readSingleShot(temp, hum);
+    if (!ok) return false;
+
+    if (data) {
+        data->type = ID_SHT31;
+        data->data.tempHum.temp = temp;
+        data->data.tempHum.hum = hum;
+    }
+
+    return true;
+}
+
+bool C_TH_SHT30::readSingleShot(float& temp, float& hum) {
+    // Measurement command; the sensor stretches the clock until the result is ready.
+    uint8_t cmd[2] = {CMD_SINGLE_SHOT_HIGH_CS >> 8, CMD_SINGLE_SHOT_HIGH_CS & 0xFF};
     uint8_t buffer[6];
-    if (m_i2c.readRaw(buffer, 6) != 6) {
-        std::cerr << "[SHT30] ERRO: Falha ao ler dados (sensor não respondeu)"
-                 << std::endl;
+    if (!m_i2c.transfer(cmd, sizeof(cmd), buffer, sizeof(buffer))) {
+        LOG_ERROR("[SHT30] ERRO: Falha ao ler dados (sensor não respondeu)");
         return false;
     }
+    return decode(buffer, temp, hum);
+}
+
+bool C_TH_SHT30::readPeriodic(float& temp, float& hum) {
+    if (!m_running && !startPeriodic()) return false;
+
+    // Fetch: the sensor NACKs the read when no new sample is ready since the last fetch.
+    uint8_t cmd[2] = {CMD_FETCH_DATA >> 8, CMD_FETCH_DATA & 0xFF};
+    uint8_t buffer[6];
+    const int64_t now = nowMs();
+    if (m_i2c.transfer(cmd, sizeof(cmd), buffer, sizeof(buffer))) {
+        if (!decode(buffer, m_lastTemp, m_lastHum)) return false;
+        m_lastMs = now;
+    } else {
+        const int64_t since = (m_lastMs != 0) ? m_lastMs : m_startMs;
+        if (now - since > SHT30_STALE_PERIODS * periodMs()) {
+            LOG_ERROR("[SHT30] ERRO: Sem amostra periódica recente");
+            // The sensor may have been reset: restart acquisition on the next read.
+            m_running = false;
+            return false;
+        }
+        // Read within the first period after a (re)start: nothing to report yet.
+        if (m_lastMs == 0) return false;
+    }
 
+    temp = m_lastTemp;
+    hum = m_lastHum;
+    return true;
+}
+
+bool C_TH_SHT30::decode(const uint8_t* buffer, float& temp, float& hum) {
     // Validate temperature CRC.
     if (calculateCRC(buffer, 2) != buffer[2]) {
-        std::cerr << "[SHT30] ERRO: CRC temperatura inválido" << std::endl;
+        LOG_ERROR("[SHT30] ERRO: CRC temperatura inválido");
         return false;
     }
 
     // Validate humidity CRC.
     if (calculateCRC(buffer + 3, 2) != buffer[5]) {
-        std::cerr << "[SHT30] ERRO: CRC humidade inválido" << std::endl;
+        LOG_ERROR("[SHT30] ERRO: CRC humidade inválido");
         return false;
     }
 
     // Convert raw values to physical units.
     uint16_t rawTemp = (buffer[0] << 8) | buffer[1];
-    float temp = -45.0f + 175.0f * (static_cast<float>(rawTemp) / 65535.0f);
+    temp = -45.0f + 175.0f * (static_cast<float>(rawTemp) / 65535.0f);
 
     uint16_t rawHum = (buffer[3] << 8) | buffer[4];
-    float hum = 100.0f * (static_cast<float>(rawHum) / 65535.0f);
-
-    if (data) {
-        data->type = ID_SHT31;
-        data->data.tempHum.temp = temp;
-        data->data.tempHum.hum = hum;
-    }
-
+    hum = 100.0f * (static_cast<float>(rawHum) / 65535.0f);
     return true;
 }
 
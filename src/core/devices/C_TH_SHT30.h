@@ -3,6 +3,10 @@
 
 /*
  * SHT30 temperature/humidity sensor (I2C).
+ * Single shot: each read() triggers a clock-stretched conversion and waits for it.
+ * Periodic: the sensor converts on its own at the configured rate and read() only
+ * fetches the latest result (one short transaction); between samples the last
+ * one is returned until it is older than a few periods.
  */
 
 #include "C_Sensor.h"
@@ -13,15 +17,48 @@ class C_I2C;
 
 #define SHT30_ADDR 0x44
 
+enum Sht30Mode_enum : uint8_t {
+    SHT30_SINGLE_SHOT = 0,
+    SHT30_PERIODIC
+};
+
+// Measurements per second in periodic mode.
+enum Sht30Rate_enum : uint8_t {
+    SHT30_MPS_0_5 = 0,
+    SHT30_MPS_1,
+    SHT30_MPS_2,
+    SHT30_MPS_4,
+    SHT30_MPS_10
+};
+
 class C_TH_SHT30 final : public C_Sensor {
 private:
     C_I2C& m_i2c;
+    Sht30Mode_enum m_mode;
+    Sht30Rate_enum m_rate;
+    bool m_running;          // Periodic acquisition started on the sensor.
+
+    // Last periodic sample (valid once m_lastMs > 0).
+    float m_lastTemp;
+    float m_lastHum;
+    int64_t m_lastMs;
+    int64_t m_startMs;       // Acquisition (re)started: no sample expected before a period.
     
     static uint8_t calculateCRC(const uint8_t* data, size_t len);
+    static bool decode(const uint8_t* buffer, float& temp, float& hum);
+    bool startPeriodic();
+    void stopPeriodic();
+    bool readSingleShot(float& temp, float& hum);
+    bool readPeriodic(float& temp, float& hum);
+    int periodMs() const;
 
 public:
     C_TH_SHT30(C_I2C& i2c);
     ~C_TH_SHT30() override;
+
+    // Takes effect on the next init().
+    void setMode(Sht30Mode_enum mode, Sht30Rate_enum rate);
+
     bool init() override;
     bool read(SensorData* data) override;
 };
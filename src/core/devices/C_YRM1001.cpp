@@ -5,10 +5,11 @@
 #include "C_YRM1001.h"
 #include "C_UART.h"
 #include "C_GPIO.h"
-#include <iostream>
+#include "C_Logger.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <unistd.h>
-#include <poll.h>
 #include <chrono>
 
 
@@ -20,15 +21,26 @@ static const uint8_t CMD_STOP_INVENTORY[] = {
     0xBB, 0x00, 0x28, 0x00, 0x00, 0x28, 0x7E
 };
 
+static int64_t nowMs() {
+    // Monotonic clock for scan windows and the keep-warm timer.
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
 
 C_YRM1001::C_YRM1001(C_UART& uart, C_GPIO& enable)
     : C_Sensor(ID_YRM1001),
       m_uart(uart),
       m_gpio_enable(enable),
-      m_bufferPos(0)
+      m_prepared(false),
+      m_options(),
+      m_lastCount(-1),
+      m_rfPower(-1),
+      m_rfQuery(-1),
+      m_lastUseMs(0)
 {
-    // Clear RX buffer state.
-    std::memset(m_rawBuffer, 0, sizeof(m_rawBuffer));
+    // Clear RX frame state.
+    std::memset(&m_frame, 0, sizeof(m_frame));
 }
 
 C_YRM1001::~C_YRM1001() {
@@ -36,27 +48,33 @@ C_YRM1001::~C_YRM1001() {
 }
 
 
+void C_YRM1001::setOptions(const S_InventoryOptions& options) {
+    m_options = options;
+}
+
+
 bool C_YRM1001::init() {
     // Initialize GPIO and UART.
     if (!m_gpio_enable.init()) {
-        std::cerr << "[YRM1001] ERROR: Failed to initialize GPIO Enable" << std::endl;
+        LOG_ERROR("[YRM1001] ERROR: Failed to initialize GPIO Enable");
         return false;
     }
 
     if (!m_uart.openPort()) {
-        std::cerr << "[YRM1001] ERROR: Failed to open UART" << std::endl;
+        LOG_ERROR("[YRM1001] ERROR: Failed to open UART");
         return false;
     }
     
     if (!m_uart.configPort(115200, 8, 'N')) {
-        std::cerr << "[YRM1001] ERROR: Failed to configure UART (115200 8N1)" << std::endl;
+        LOG_ERROR("[YRM1001] ERROR: Failed to configure UART (115200 8N1)");
         return false;
     }
+    m_uart.setDecoder(&m_decoder);
 
     // Ensure module starts powered off.
     powerOff();
 
-    std::cout << "[YRM1001] Initialized (UART 115200, EN ready)" << std::endl;
+    LOG_INFO("[YRM1001] Initialized (UART 115200, EN ready)");
     return true;
 }
 
@@ -71,31 +89,83 @@ bool C_YRM1001::powerOn() {
 
 
 void C_YRM1001::powerOff() {
-    // Disable module power.
+    // Disable module power; the module forgets its RF settings.
     m_gpio_enable.writePin(false);  
-    std::cout << "[YRM1001] Power OFF" << std::endl;
+    m_rfPower = -1;
+    m_rfQuery = -1;
+    LOG_INFO("[YRM1001] Power OFF");
 }
 
 
-void C_YRM1001::flushUART() const {
-    // Drain UART RX to avoid stale frames.
-    uint8_t trash[64];
-    int count = 0;
-    
-    while (m_uart.readBuffer(trash, sizeof(trash)) > 0 && ++count < 10);
+bool C_YRM1001::prepare() {
+    if (!m_prepared) {
+        powerOn();
+        // Module ignores commands until it has booted.
+        usleep(YRM_BOOT_TIME_MS * 1000);
+        m_prepared = true;
+    }
+    flushUART();
+    configure();
+    m_lastUseMs = nowMs();
+    return true;
+}
+
+
+void C_YRM1001::configure() {
+    // RF settings hold while the module stays powered: send only what changed.
+    if (m_rfPower != m_options.powerCentiDbm) {
+        if (setPower(m_options.powerCentiDbm)) {
+            m_rfPower = m_options.powerCentiDbm;
+        } else {
+            m_rfPower = -1;
+            LOG_WARN("[YRM1001] WARNING: setPower failed during prepare");
+        }
+    }
 
-    if (count > 0) {
-        std::cout << "[YRM1001] Flush: Cleared UART buffer" << std::endl;
+    uint16_t query = queryFor(expectedTags());
+    if (m_rfQuery != query) {
+        if (setQuery(query)) {
+            m_rfQuery = query;
+        } else {
+            m_rfQuery = -1;
+            LOG_WARN("[YRM1001] WARNING: setQuery failed during prepare");
+        }
     }
 }
 
 
+void C_YRM1001::release() {
+    if (!m_prepared) return;
+    powerOff();
+    m_prepared = false;
+}
+
+
+void C_YRM1001::powerDownIfIdle() {
+    if (!m_prepared || m_options.keepWarmMs <= 0) return;
+    if (nowMs() - m_lastUseMs < m_options.keepWarmMs) return;
+    LOG_INFO("[YRM1001] Idle for %dms -> power down", m_options.keepWarmMs);
+    release();
+}
+
+
+bool C_YRM1001::isPrepared() const {
+    return m_prepared;
+}
+
+
+void C_YRM1001::flushUART() const {
+    // Drop stale frames and bytes so the next frame answers the next command.
+    m_uart.discardInput();
+}
+
+
 bool C_YRM1001::sendCommand(const uint8_t* cmd, size_t len) const {
     // Send raw command frame.
     int written = m_uart.writeBuffer(cmd, len);
 
     if (written != static_cast<int>(len)) {
-        std::cerr << "[YRM1001] ERROR: Failed to send command" << std::endl;
+        LOG_ERROR("[YRM1001] ERROR: Failed to send command");
         return false;
     }
 
@@ -104,124 +174,64 @@ bool C_YRM1001::sendCommand(const uint8_t* cmd, size_t len) const {
 
 
 bool C_YRM1001::readFrame() {
-    m_bufferPos = 0;
-
-    struct pollfd pfd;
-    pfd.fd = m_uart.getFd();
-    pfd.events = POLLIN;
-
-    const int HEADER_SIZE = 5;
-
-    while (m_bufferPos < HEADER_SIZE) {
-        
-        int ret = poll(&pfd, 1, 100);
+    // Complete, checksummed frame from the receive path (or timeout).
+    return m_uart.waitFrame(m_frame, YRM_FRAME_TIMEOUT_MS);
+}
 
-        if (ret > 0 && (pfd.revents & POLLIN)) {
-            int n = m_uart.readBuffer(&m_rawBuffer[m_bufferPos], HEADER_SIZE - m_bufferPos);
 
-            if (n > 0) {
-                m_bufferPos += n;
-            }
-        } else if (ret == 0) {
-            // Timeout waiting for header.
-            return false;
-        } else {
-            // Poll error on header.
-            std::cerr << "[YRM1001] ERROR: Poll failed on header" << std::endl;
-            return false;
+bool C_YRM1001Decoder::decode(C_RingBuffer& rx, S_UartFrame& frame) {
+    while (syncTo(rx, YRM_HEADER)) {
+        if (rx.size() < YRM_HEADER_SIZE) return false;
+        uint16_t payloadLen = static_cast<uint16_t>((rx[YRM_IDX_PL_MSB] << 8) | rx[YRM_IDX_PL_LSB]);
+        size_t total = YRM_HEADER_SIZE + payloadLen + 2;
+        if (total > UART_FRAME_MAX) {
+            reject(rx);
+            continue;
         }
-    }
+        if (rx.size() < total) return false;
 
-    // Validate frame header byte.
-    if (m_rawBuffer[YRM_IDX_HEADER] != YRM_HEADER) {
-        std::cerr << "[YRM1001] ERROR: Invalid header (0x"
-                  << std::hex << static_cast<int>(m_rawBuffer[0]) << std::dec << ")" << std::endl;
-        return false;
-    }
-    
-    uint16_t payloadLen = (m_rawBuffer[YRM_IDX_PL_MSB] << 8) | m_rawBuffer[YRM_IDX_PL_LSB];
-    int totalFrameSize = 5 + payloadLen + 2;
-
-    if (totalFrameSize > static_cast<int>(sizeof(m_rawBuffer))) {
-        std::cerr << "[YRM1001] ERROR: Frame too large (" << totalFrameSize << " bytes)" << std::endl;
-        return false;
-    }
-
-    int remaining = totalFrameSize - HEADER_SIZE;
-    while (m_bufferPos < totalFrameSize) {
-        // Read the remaining payload + checksum + tail.
-        int ret = poll(&pfd, 1, 100);
-
-        if (ret > 0 && (pfd.revents & POLLIN)) {
-            // Read available bytes.
-            int n = m_uart.readBuffer(&m_rawBuffer[m_bufferPos], remaining);
-
-            if (n > 0) {
-                m_bufferPos += n;
-                remaining -= n;
-            }
-        } else if (ret == 0) {
-            // Timeout mid-frame.
-            std::cerr << "[YRM1001] ERROR: Timeout mid-frame (got "
-                      << m_bufferPos << "/" << totalFrameSize << " bytes)" << std::endl;
-            return false;
-        } else {
-            // Poll error on payload.
-            std::cerr << "[YRM1001] ERROR: Poll failed on payload" << std::endl;
-            return false;
+        uint8_t sum = 0;
+        for (size_t i = YRM_IDX_TYPE; i < total - 2; ++i) sum += rx[i];
+        if (rx[total - 1] == YRM_TAIL && rx[total - 2] == sum) {
+            take(rx, total, frame);
+            return true;
         }
+        reject(rx);
     }
-
-    // Validate tail byte.
-    if (m_rawBuffer[m_bufferPos - 1] != YRM_TAIL) {
-        std::cerr << "[YRM1001] ERROR: Invalid tail (0x"
-                  << std::hex << static_cast<int>(m_rawBuffer[m_bufferPos - 1]) << std::dec << ")" << std::endl;
-        return false;
-    }
-    return true; 
+    return false;
 }
 
 
-bool C_YRM1001::parseFrame(char* epcOut, size_t epcSize) const {
-    // Parse inventory notification frame.
-    if (m_bufferPos < 10) {
+bool C_YRM1001::parseFrame(uint8_t* epcOut) const {
+    // Parse inventory notification frame (checksum verified by the decoder).
+    const uint8_t* raw = m_frame.data;
+    if (m_frame.len < 10) {
         return false;
     }
 
-    if (m_rawBuffer[YRM_IDX_TYPE] != YRM_TYPE_NOTIF ||
-        m_rawBuffer[YRM_IDX_COMMAND] != YRM_CMD_INVENTORY) {
+    if (raw[YRM_IDX_TYPE] != YRM_TYPE_NOTIF ||
+        raw[YRM_IDX_COMMAND] != YRM_CMD_INVENTORY) {
         return false;
     }
 
-    uint16_t payloadLen = (m_rawBuffer[YRM_IDX_PL_MSB] << 8) | m_rawBuffer[YRM_IDX_PL_LSB];
+    uint16_t payloadLen = (raw[YRM_IDX_PL_MSB] << 8) | raw[YRM_IDX_PL_LSB];
 
     if (payloadLen < 5) {
-        std::cerr << "[YRM1001] ERROR: Payload too small" << std::endl;
+        LOG_ERROR("[YRM1001] ERROR: Payload too small");
         return false;
     }
 
+    // RSSI, PC, EPC, CRC: only 96-bit EPCs are tracked.
     int epcLen = payloadLen - 5;
-    int epcStartIdx = YRM_IDX_PAYLOAD + 1 + 2;  
+    int epcStartIdx = YRM_IDX_PAYLOAD + 1 + 2;
 
-    // Ensure EPC fits in output buffer.
-    if (epcLen * 2 >= static_cast<int>(epcSize)) {
-        std::cerr << "[YRM1001] ERROR: EPC too large (" << epcLen << " bytes)" << std::endl;
+    if (epcLen != INVENTORY_EPC_BYTES) {
+        LOG_RATELIMITED(LOG_LVL_WARN, 10000, "[YRM1001] EPC de %d bytes ignorado (esperado %d)",
+                        epcLen, INVENTORY_EPC_BYTES);
         return false;
     }
 
-    int checksumIdx = 5 + payloadLen;
-
-    uint8_t expectedCS = calculateChecksum(&m_rawBuffer[YRM_IDX_TYPE], 4 + payloadLen);
-
-    // Warn on checksum mismatch (but continue).
-    if (m_rawBuffer[checksumIdx] != expectedCS) {
-        std::cerr << "[YRM1001] WARNING: Invalid checksum "
-                  << "(expected: 0x" << std::hex << static_cast<int>(expectedCS)
-                  << ", received: 0x" << static_cast<int>(m_rawBuffer[checksumIdx])
-                  << std::dec << ")" << std::endl;
-    }
-
-    bytesToHex(&m_rawBuffer[epcStartIdx], epcLen, epcOut);
+    std::memcpy(epcOut, &raw[epcStartIdx], INVENTORY_EPC_BYTES);
 
     return true;
 }
@@ -237,7 +247,7 @@ bool C_YRM1001::setPower(uint16_t powerCentiDbm) {
 
     cmd_power[7] = calculateChecksum(&cmd_power[1], 6);
 
-    std::cout << "[YRM1001] Setting power to: " << (powerCentiDbm / 100.0f) << " dBm\n";
+    LOG_INFO("[YRM1001] Setting power to: %.2f dBm", (powerCentiDbm / 100.0f));
 
     flushUART();
     if (!sendCommand(cmd_power, sizeof(cmd_power))) return false;
@@ -246,30 +256,66 @@ bool C_YRM1001::setPower(uint16_t powerCentiDbm) {
     if (!readFrame()) return false;
 
     bool ok = false;
-    if (m_rawBuffer[YRM_IDX_HEADER] == YRM_HEADER &&
-        m_rawBuffer[YRM_IDX_TYPE]   == 0x01 &&
-        m_rawBuffer[YRM_IDX_COMMAND]== 0xB6) {
+    if (m_frame.data[YRM_IDX_HEADER] == YRM_HEADER &&
+        m_frame.data[YRM_IDX_TYPE]   == 0x01 &&
+        m_frame.data[YRM_IDX_COMMAND]== 0xB6) {
 
-        uint16_t pl = (static_cast<uint16_t>(m_rawBuffer[YRM_IDX_PL_MSB]) << 8) | m_rawBuffer[YRM_IDX_PL_LSB];
-        if (pl == 1 && m_rawBuffer[YRM_IDX_PAYLOAD] == 0x00) ok = true;
+        uint16_t pl = (static_cast<uint16_t>(m_frame.data[YRM_IDX_PL_MSB]) << 8) | m_frame.data[YRM_IDX_PL_LSB];
+        if (pl == 1 && m_frame.data[YRM_IDX_PAYLOAD] == 0x00) ok = true;
         }
 
     if (!ok) return false;
 
     uint16_t actual{};
     if (getPower(actual)) {
-        std::cout << "[YRM1001] Power now: " << (actual / 100.0f) << " dBm\n";
+        LOG_INFO("[YRM1001] Power now: %.2f dBm", (actual / 100.0f));
         if (actual != powerCentiDbm) {
-            std::cout << "[YRM1001] NOTE: Module clamped/adjusted value (requested "
-                      << (powerCentiDbm / 100.0f) << " dBm).\n";
+            LOG_INFO("[YRM1001] NOTE: Module clamped/adjusted value (requested %.2f dBm).", (powerCentiDbm / 100.0f));
         }
     } else {
-        std::cout << "[YRM1001] WARNING: set OK, but getPower() failed.\n";
+        LOG_WARN("[YRM1001] WARNING: set OK, but getPower() failed.");
     }
 
     return true;
 }
 
+uint16_t C_YRM1001::queryFor(int expected) {
+    // Q ~ log2(population): about one tag per slot. S1 keeps read tags quiet
+    // so a crowded vault does not drown the last ones in collisions.
+    int q = 0;
+    while (q < YRM_Q_MAX && (1 << q) < expected) ++q;
+    int session = (expected > YRM_S1_MIN_TAGS) ? 1 : 0;
+    return static_cast<uint16_t>(YRM_QUERY_BASE | (session << 8) | (q << 3));
+}
+
+bool C_YRM1001::setQuery(uint16_t param) {
+    // Gen2 Query parameters for the following inventory rounds.
+    uint8_t cmd_query[] = {
+        0xBB, 0x00, YRM_CMD_SET_QUERY, 0x00, 0x02,
+        static_cast<uint8_t>(param >> 8),
+        static_cast<uint8_t>(param & 0xFF),
+        0x00, 0x7E
+    };
+    cmd_query[7] = calculateChecksum(&cmd_query[1], 6);
+
+    LOG_INFO("[YRM1001] Query: Q=%u S%u", (param >> 3) & 0x0F, (param >> 8) & 0x03);
+
+    flushUART();
+    if (!sendCommand(cmd_query, sizeof(cmd_query))) return false;
+    if (!readFrame()) return false;
+
+    uint16_t pl = (static_cast<uint16_t>(m_frame.data[YRM_IDX_PL_MSB]) << 8) | m_frame.data[YRM_IDX_PL_LSB];
+    return m_frame.data[YRM_IDX_TYPE] == YRM_TYPE_RESPONSE &&
+           m_frame.data[YRM_IDX_COMMAND] == YRM_CMD_SET_QUERY &&
+           pl == 1 && m_frame.data[YRM_IDX_PAYLOAD] == 0x00;
+}
+
+int C_YRM1001::expectedTags() const {
+    if (m_options.expectedTags > 0) return m_options.expectedTags;
+    if (m_lastCount >= 0) return std::max(m_lastCount, 1);
+    return YRM_DEFAULT_TAGS;
+}
+
 bool C_YRM1001::getPower(uint16_t& outCentiDbm) {
     // Query current RF output power.
     uint8_t cmd_get[] = { 0xBB, 0x00, 0xB7, 0x00, 0x00, 0x00, 0x7E };
@@ -280,24 +326,17 @@ bool C_YRM1001::getPower(uint16_t& outCentiDbm) {
     if (!sendCommand(cmd_get, sizeof(cmd_get))) return false;
     if (!readFrame()) return false;
     
-    if (m_rawBuffer[YRM_IDX_HEADER] != YRM_HEADER) return false;
-    if (m_rawBuffer[YRM_IDX_TYPE]   != 0x01)       return false;
-    if (m_rawBuffer[YRM_IDX_COMMAND]!= 0xB7)       return false;
+    if (m_frame.data[YRM_IDX_HEADER] != YRM_HEADER) return false;
+    if (m_frame.data[YRM_IDX_TYPE]   != 0x01)       return false;
+    if (m_frame.data[YRM_IDX_COMMAND]!= 0xB7)       return false;
 
-    uint16_t pl = (static_cast<uint16_t>(m_rawBuffer[YRM_IDX_PL_MSB]) << 8) | m_rawBuffer[YRM_IDX_PL_LSB];
+    uint16_t pl = (static_cast<uint16_t>(m_frame.data[YRM_IDX_PL_MSB]) << 8) | m_frame.data[YRM_IDX_PL_LSB];
     if (pl != 2) return false;
 
+    // Checksum and tail already verified by the decoder.
     const int payloadIdx  = YRM_IDX_PAYLOAD;      
-    const int checksumIdx = 5 + pl;               
-    const uint8_t expected = calculateChecksum(&m_rawBuffer[YRM_IDX_TYPE], 4 + pl);
-
-    if (m_rawBuffer[checksumIdx] != expected) {
-        // Checksum mismatch.
-        return false;
-    }
-    if (m_rawBuffer[checksumIdx + 1] != YRM_TAIL) return false;
 
-    outCentiDbm = (static_cast<uint16_t>(m_rawBuffer[payloadIdx]) << 8) | m_rawBuffer[payloadIdx + 1];
+    outCentiDbm = (static_cast<uint16_t>(m_frame.data[payloadIdx]) << 8) | m_frame.data[payloadIdx + 1];
     return true;
 }
 
@@ -314,133 +353,117 @@ uint8_t C_YRM1001::calculateChecksum(const uint8_t* data, size_t len) {
 }
 
 
-void C_YRM1001::bytesToHex(const uint8_t* data, size_t len, char* hexOut) {
-    // Convert bytes to ASCII hex string.
-    static const char hexChars[] = "0123456789ABCDEF";
-
-    for (size_t i = 0; i < len; i++) {
-        hexOut[i * 2]     = hexChars[data[i] >> 4];      
-        hexOut[i * 2 + 1] = hexChars[data[i] & 0x0F];    
-    }
+bool C_YRM1001::read(SensorData* data) {
+    if (!data) return false;
 
-    hexOut[len * 2] = '\0';  
-}
+    data->type = ID_YRM1001;
+    Data_RFID_Inventory& inv = data->data.rfid_inventory;
+    std::memset(&inv, 0, sizeof(inv));
 
+    int total = scan([&inv](const uint8_t* epc) {
+        if (inv.tagCount >= INVENTORY_BATCH_TAGS) return;
+        std::memcpy(inv.tagList[inv.tagCount], epc, INVENTORY_EPC_BYTES);
+        ++inv.tagCount;
+    });
+    if (total < 0) return false;
 
-bool C_YRM1001::isTagSeen(const char* epc, char tagList[][32], int tagCount){
-    // Deduplicate tags within a scan.
-    for (int i = 0; i < tagCount; i++) {
-        if (strcmp(tagList[i], epc) == 0) {
-            return true;  
-        }
-    }
-    return false;  
+    inv.totalTags = static_cast<uint32_t>(total);
+    return true;
 }
 
 
-bool C_YRM1001::read(SensorData* data) {
-    if (!data) return false;
-
-    // Use a monotonic timer for scan windows.
-    auto nowMs = []() -> int64_t {
-        using namespace std::chrono;
-        return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
-    };
-
+int C_YRM1001::scan(const TagFn& onTag) {
     // Scan parameters.
-    static constexpr int IDLE_NEW_TAG_MS = 500;   
-    static constexpr int TOTAL_SCAN_MS   = 3000;  
-    static constexpr int POLL_SLICE_MS   = 100;   
+    static constexpr int POLL_SLICE_MS   = 100;
+    // With new tags arriving at a mean gap g, a silence t leaves an unread tag
+    // with probability exp(-t/g): stop once that is below 1 - confidence.
+    const double silenceFactor = -std::log(1.0 - m_options.confidence);
 
-    powerOn();
-    std::cout << "[YRM1001] ========== START SCAN ==========\n";
-
-    flushUART();
+    LOG_INFO("[YRM1001] ========== START SCAN ==========");
 
-    setPower(5);
+    // A pre-woken or warm reader skips boot; unchanged RF settings are not resent.
+    prepare();
 
     if (!sendCommand(CMD_START_INVENTORY, sizeof(CMD_START_INVENTORY))) {
-        powerOff();
-        return false;
+        release();
+        return -1;
     }
-    std::cout << "[YRM1001] START command sent\n";
-
-    struct pollfd pfd{};
-    pfd.fd = m_uart.getFd();
-    pfd.events = POLLIN;
+    LOG_INFO("[YRM1001] START command sent");
 
-    int tagCount = 0;
+    // The set keeps its buckets between rounds.
+    m_seen.clear();
     int64_t tStart   = nowMs();
     int64_t tLastNew = tStart;
-    
-    data->type = ID_YRM1001;
-    data->data.rfid_inventory.tagCount = 0;
-    for (int i = 0; i < MAX_TAGS; ++i) {
-        data->data.rfid_inventory.tagList[i][0] = '\0';
-    }
-    while (tagCount < MAX_TAGS) {
+    double meanGapMs = YRM_FIRST_TAG_MS;
+    bool responded = false;
+
+    for (;;) {
+        int64_t now = nowMs();
+
         // Stop if total scan time elapsed.
-        if (nowMs() - tStart >= TOTAL_SCAN_MS) {
-            std::cout << "[YRM1001] Total scan timeout (" << TOTAL_SCAN_MS << "ms)\n";
+        if (now - tStart >= m_options.maxScanMs) {
+            LOG_INFO("[YRM1001] Total scan timeout (%dms)", m_options.maxScanMs);
             break;
         }
 
-        // Stop if no new tags appear for a while.
-        if (nowMs() - tLastNew >= IDLE_NEW_TAG_MS) {
-            std::cout << "[YRM1001] No new tags for " << IDLE_NEW_TAG_MS << "ms -> done\n";
+        // Stop once the silence makes another new tag unlikely.
+        int64_t quietMs = std::max<int64_t>(m_options.minIdleMs,
+                                            static_cast<int64_t>(silenceFactor * meanGapMs));
+        if (now - tLastNew >= quietMs) {
+            LOG_INFO("[YRM1001] No new tags for %lldms (mean gap %.0fms) -> done",
+                     static_cast<long long>(quietMs), meanGapMs);
             break;
         }
 
-        int ret = poll(&pfd, 1, POLL_SLICE_MS);
-
-        if (ret == 0) {
-            // No data yet.
+        int sliceMs = static_cast<int>(std::min<int64_t>(POLL_SLICE_MS, tLastNew + quietMs - now));
+        if (!m_uart.waitFrame(m_frame, std::max(sliceMs, 1))) {
+            // No frame yet.
             continue;
         }
+        responded = true;
 
-        if (ret < 0) {
-            if (errno == EINTR) continue;
-            std::cerr << "[YRM1001] ERROR: poll() failed\n";
-            break;
-        }
-
-        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
-            std::cerr << "[YRM1001] ERROR: UART revents=" << std::hex << pfd.revents << std::dec << "\n";
-            break;
+        uint8_t epc[INVENTORY_EPC_BYTES];
+        if (!parseFrame(epc)) {
+            continue;
         }
 
-        if (pfd.revents & POLLIN) {
-            if (!readFrame()) {
-                // Ignore malformed frame.
-                continue;
-            }
-
-            char epc[32];
-            if (!parseFrame(epc, sizeof(epc))) {
-                continue;
-            }
-
-            // Add unique tags only.
-            if (!isTagSeen(epc, data->data.rfid_inventory.tagList, tagCount)) {
-                // Store EPC string.
-                std::strncpy(data->data.rfid_inventory.tagList[tagCount], epc, 31);
-                data->data.rfid_inventory.tagList[tagCount][31] = '\0';
-
-                tagCount++;
-                tLastNew = nowMs(); 
-
-                std::cout << "[YRM1001] Tag " << tagCount << ": " << epc << "\n";
-            }
+        // Report unique tags only.
+        if (m_seen.insert(epc)) {
+            // Recent gaps weigh most: discovery slows as the population is exhausted.
+            int64_t t = nowMs();
+            double gap = static_cast<double>(t - tLastNew);
+            meanGapMs = (m_seen.size() == 1) ? gap : 0.75 * meanGapMs + 0.25 * gap;
+            tLastNew = t;
+#if LOG_MIN_LEVEL <= LOG_LVL_DEBUG
+            char hex[INVENTORY_EPC_HEX_SIZE];
+            epcToHex(epc, hex);
+            LOG_DEBUG("[YRM1001] Tag %zu: %s", m_seen.size(), hex);
+#endif
+            onTag(epc);
         }
     }
     sendCommand(CMD_STOP_INVENTORY, sizeof(CMD_STOP_INVENTORY));
+    // Any frame (tag, "no tag" notice or the stop ack) proves the reader is alive;
+    // a silent reader must not pass for an empty vault.
+    if (!responded) {
+        responded = readFrame();
+    }
 
-    powerOff();
+    // Keep-warm: stay configured and idle; powerDownIfIdle() ends it.
+    if (m_options.keepWarmMs > 0) {
+        m_lastUseMs = nowMs();
+    } else {
+        release();
+    }
 
-    data->data.rfid_inventory.tagCount = tagCount;
+    LOG_INFO("[YRM1001] ========== END SCAN ==========");
+    if (!responded) {
+        LOG_RATELIMITED(LOG_LVL_ERROR, 60000, "[YRM1001] Leitor sem resposta: inventário descartado");
+        return -1;
+    }
+    LOG_INFO("[YRM1001] Total tags found: %zu", m_seen.size());
 
-    std::cout << "[YRM1001] ========== END SCAN ==========\n";
-    std::cout << "[YRM1001] Total tags found: " << tagCount << "\n";
+    m_lastCount = static_cast<int>(m_seen.size());
 
-    return true;
+    return static_cast<int>(m_seen.size());
 }
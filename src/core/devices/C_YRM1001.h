@@ -3,11 +3,21 @@
 
 /*
  * YRM1001 UHF RFID reader (UART) interface.
+ * scan() runs one inventory round and hands every distinct EPC to the caller as
+ * it is read, so the tag population is not bounded by any message layout.
+ * The round ends once the discovery rate says no unread tag is likely left
+ * (S_InventoryOptions::confidence); Gen2 Q and session are sized from the
+ * expected population, by default the count of the previous round.
+ * RF settings are cached while the module is powered and only resent when
+ * they change; with keepWarmMs the module stays powered between rounds.
  */
 
 #include "C_Sensor.h"
+#include "C_FrameDecoder.h"
+#include "C_EpcSet.h"
 #include <stdint.h>
 #include <cstddef>
+#include <functional>
 class C_UART;
 class C_GPIO;
 
@@ -24,34 +34,90 @@ class C_GPIO;
 #define YRM_BOOT_TIME_MS    100
 #define YRM_STOP_TIME_MS    50
 #define YRM_IDLE_TIMEOUT_MS 500
+#define YRM_SCAN_POWER      5
+#define YRM_CMD_SET_QUERY   0x0E
+#define YRM_TYPE_RESPONSE   0x01
+#define YRM_FRAME_TIMEOUT_MS 100
+#define YRM_HEADER_SIZE     5
+
+// Gen2 Query: DR=8, M=FM0, TRext on, Sel=All, target A (bits 12, 9-8, 6-3).
+#define YRM_QUERY_BASE      0x1000
+#define YRM_Q_MAX           15
+// Populations above this use S1: read tags stay quiet for the rest of the round.
+#define YRM_S1_MIN_TAGS     32
+// Expected population when nothing is configured and no round has run yet.
+#define YRM_DEFAULT_TAGS    16
+// Gap assumed before the first tag (sets the wait of an empty vault).
+#define YRM_FIRST_TAG_MS    100
+
+// Inventory round tuning ([vault <id>] uhf_* keys).
+struct S_InventoryOptions {
+    uint16_t powerCentiDbm = YRM_SCAN_POWER;   // RF output power.
+    int maxScanMs = 3000;       // Dwell: hard limit of one round.
+    int minIdleMs = 150;        // Never stop on a silence shorter than this.
+    double confidence = 0.95;   // Chance that no unread tag is left when the round stops.
+    int expectedTags = 0;       // Population for Q/session; 0 = previous round's count.
+    int keepWarmMs = 0;         // Idle time powered after a round; 0 = power off at once.
+};
+
+// Header, type, command, 16-bit payload length, payload, sum checksum, tail.
+class C_YRM1001Decoder final : public C_FrameDecoder {
+public:
+    bool decode(C_RingBuffer& rx, S_UartFrame& frame) override;
+};
 
 class C_YRM1001 final : public C_Sensor {
 private:
     C_UART& m_uart;
     C_GPIO& m_gpio_enable;
 
-    uint8_t m_rawBuffer[256];
-    int m_bufferPos;
-
-    static const int MAX_TAGS = 4;
+    C_YRM1001Decoder m_decoder;
+    S_UartFrame m_frame;    // Last frame received.
+    bool m_prepared;
+    C_EpcSet m_seen;        // EPCs of the current round.
+    S_InventoryOptions m_options;
+    int m_lastCount;        // Distinct tags of the last round; -1 before the first.
+    int32_t m_rfPower;      // RF settings applied since power-on; -1 = unknown.
+    int32_t m_rfQuery;
+    int64_t m_lastUseMs;    // Last prepare/round (keep-warm timer).
 
 public:
+    // epc: INVENTORY_EPC_BYTES, valid for the duration of the call.
+    typedef std::function<void(const uint8_t* epc)> TagFn;
+
     C_YRM1001(C_UART& uart, C_GPIO& enable);
     ~C_YRM1001() override;
+    // Applied from the next prepare().
+    void setOptions(const S_InventoryOptions& options);
     bool init() override;
+    // First INVENTORY_BATCH_TAGS tags and the total; scan() for the full population.
     bool read(SensorData* data) override;
 
+    // One inventory round; onTag runs once per distinct EPC, on the caller's thread.
+    // Distinct tags read, or -1 if the round could not start or the reader never answered.
+    int scan(const TagFn& onTag);
+
+    // Power on, boot and configure ahead of read() (pre-wake); read() powers off
+    // unless keep-warm is on.
+    bool prepare();
+    void release();
+    // Owner's tick: power a warm reader down after keepWarmMs without use.
+    void powerDownIfIdle();
+    bool isPrepared() const;
+
 private:
     bool powerOn();
     void powerOff();
     bool getPower(uint16_t& outCentiDbm);
     bool sendCommand(const uint8_t* cmd, size_t len) const;
     bool readFrame();
-    bool parseFrame(char* epcOut, size_t epcSize) const;
+    bool parseFrame(uint8_t* epcOut) const;
     static uint8_t calculateChecksum(const uint8_t* data, size_t len);
     bool setPower(uint16_t powerDBm);
-    static void bytesToHex(const uint8_t* data, size_t len, char* hexOut);
-    static bool isTagSeen(const char* epc, char tagList[][32], int tagCount) ;
+    bool setQuery(uint16_t param);
+    static uint16_t queryFor(int expected);
+    void configure();
+    int expectedTags() const;
     void flushUART() const;
 };
 
@@ -6,7 +6,8 @@
 #include "C_GPIO.h"
 
 C_alarmActuator::C_alarmActuator(C_GPIO& gpio_led, C_GPIO& gpio_buzzer)
-: C_Actuator(ID_ALARM_ACTUATOR), gpio_led(gpio_led), gpio_buzzer(gpio_buzzer), ison(false) {}
+: C_Actuator(ID_ALARM_ACTUATOR), gpio_led(gpio_led), gpio_buzzer(gpio_buzzer),
+  lines{&gpio_led, &gpio_buzzer}, ison(false) {}
 
 C_alarmActuator::~C_alarmActuator() {
     C_alarmActuator::stop();
@@ -14,16 +15,12 @@ C_alarmActuator::~C_alarmActuator() {
 
 void C_alarmActuator::stop() {
     // Turn off both buzzer and LED.
-    gpio_buzzer.writePin(false);
-    gpio_led.writePin(false);
+    lines.set(lines.all(), 0);
     ison = false;
 }
 bool C_alarmActuator::init() {
-    // Initialize GPIOs and ensure OFF state.
-    if (!gpio_led.init()) {
-        return false;
-    }
-    if (!gpio_buzzer.init()) {
+    // Initialize GPIOs (one request on chardev) and ensure OFF state.
+    if (!lines.init()) {
         return false;
     }
     stop();
@@ -33,8 +30,9 @@ bool C_alarmActuator::init() {
 bool C_alarmActuator::set_value(const uint8_t value) {
     // Any value > 0 enables alarm.
     if (value > 0) {
-        gpio_buzzer.writePin(true);
-        gpio_led.writePin(true);
+        if (!lines.set(lines.all(), lines.all())) {
+            return false;
+        }
         ison = true;
     }
     else {
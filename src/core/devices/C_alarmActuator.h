@@ -1,9 +1,10 @@
 #ifndef C_ALARMACTUATOR_H
 #define C_ALARMACTUATOR_H
 /*
- * Alarm actuator: LED + buzzer controlled via GPIO.
+ * Alarm actuator: LED + buzzer controlled via GPIO (switched together as one group).
  */
 #include "C_Actuator.h"
+#include "C_GPIOLines.h"
 #include "SharedTypes.h"
 
 class C_GPIO;
@@ -20,6 +21,8 @@ public:
 private:
     C_GPIO& gpio_led;
     C_GPIO& gpio_buzzer;
+    // Bit 0 LED, bit 1 buzzer.
+    C_GPIOLines lines;
     bool ison;
 };
 
@@ -0,0 +1,61 @@
+#ifndef C_FRAMEDECODER_H
+#define C_FRAMEDECODER_H
+
+/*
+ * Protocol framing for a UART receive ring.
+ * Each device protocol implements decode(): find the next start marker, wait until
+ * the whole frame is buffered, verify it (tail, checksum) and hand it out. Bytes
+ * that cannot start a valid frame are consumed one at a time so the decoder
+ * resynchronizes on the next marker instead of discarding whole reads.
+ */
+
+#include <cstdint>
+#include "C_RingBuffer.h"
+
+#define UART_FRAME_MAX 256
+
+struct S_UartFrame {
+    uint8_t data[UART_FRAME_MAX];
+    uint16_t len;
+    int64_t tsMs;    // CLOCK_MONOTONIC when the last byte was decoded.
+};
+
+class C_FrameDecoder {
+protected:
+    uint32_t m_dropped;    // Bytes skipped while hunting for a start marker.
+    uint32_t m_rejected;   // Candidate frames with bad tail/checksum.
+
+    // Skip to the first 'marker' byte; true if one is at the front.
+    bool syncTo(C_RingBuffer& rx, uint8_t marker) {
+        size_t skip = 0;
+        while (skip < rx.size() && rx[skip] != marker) ++skip;
+        rx.consume(skip);
+        m_dropped += static_cast<uint32_t>(skip);
+        return !rx.empty();
+    }
+
+    // Candidate failed verification: drop its marker and hunt again.
+    void reject(C_RingBuffer& rx) {
+        rx.consume(1);
+        ++m_dropped;
+        ++m_rejected;
+    }
+
+    static void take(C_RingBuffer& rx, size_t len, S_UartFrame& frame) {
+        rx.copyOut(frame.data, len);
+        rx.consume(len);
+        frame.len = static_cast<uint16_t>(len);
+    }
+
+public:
+    C_FrameDecoder() : m_dropped(0), m_rejected(0) {}
+    virtual ~C_FrameDecoder() = default;
+
+    // One complete, verified frame from the front of rx; false if more bytes are needed.
+    virtual bool decode(C_RingBuffer& rx, S_UartFrame& frame) = 0;
+
+    uint32_t dropped() const { return m_dropped; }
+    uint32_t rejected() const { return m_rejected; }
+};
+
+#endif
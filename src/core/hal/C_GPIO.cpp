@@ -1,91 +1,370 @@
 /*
- * GPIO implementation via sysfs (/sys/class/gpio).
+ * GPIO implementation: sysfs (/sys/class/gpio) and chardev (/dev/gpiochipN, uAPI v2).
  */
 
 #include "C_GPIO.h"
-#include <cstdio>       
-#include <fcntl.h>      
-#include <unistd.h>     
-#include <cstring>      
-#include <iostream>
-#define GPIO_BASE 512
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "C_Logger.h"
+#include "C_HalPaths.h"
 using namespace std;
 
-C_GPIO::C_GPIO(int pin, GPIO_DIRECTION dir)
-    : m_dir(dir)
+static GpioBackend_enum s_backend = GPIO_DEFAULT_BACKEND;
+static int s_chip = 0;
+
+C_GPIO::C_GPIO(int pin, GPIO_DIRECTION dir, GPIO_EDGE edge)
+    : m_pin(pin),
+      m_dir(dir),
+      m_edge(edge),
+      m_valueFd(-1),
+      m_lineFd(-1),
+      m_lineBit(0),
+      m_ownsLine(false),
+      m_lastSeqno(0),
+      m_io("gpio")
 {
-    // Map logical pins to the platform base.
-    m_pin=pin+GPIO_BASE;
-    m_path = "/sys/class/gpio/gpio" + to_string(m_pin);
+    // sysfs numbers are global: map logical pins to the platform base.
+    m_path = C_HalPaths::path("/sys/class/gpio/gpio" + to_string(m_pin + GPIO_BASE));
+    m_io.setName("pin " + to_string(m_pin));
 }
 
 C_GPIO::~C_GPIO() {
     closePin();
 }
 
+void C_GPIO::setBackend(GpioBackend_enum backend, int chip) {
+    s_backend = backend;
+    s_chip = chip;
+}
+
+GpioBackend_enum C_GPIO::backend() {
+    return s_backend;
+}
+
+std::string C_GPIO::chipPath() {
+    return C_HalPaths::path("/dev/gpiochip" + to_string(s_chip));
+}
+
 bool C_GPIO::init() {
+    // A retry re-requests the line; drop descriptors from a previous attempt.
+    closeValue();
+    releaseLine();
+    return (s_backend == GPIO_BACKEND_CHARDEV) ? initChardev() : initSysfs();
+}
+
+bool C_GPIO::initSysfs() {
     // Export the pin to sysfs.
-    int fd = open("/sys/class/gpio/export", O_WRONLY);
-    if (fd == -1) {
-        perror("GPIO: Erro ao abrir export");
+    if (!writeSysfs(C_HalPaths::path("/sys/class/gpio/export"), to_string(m_pin + GPIO_BASE).c_str())) {
+        LOG_ERROR("GPIO: Erro ao abrir export: %s", strerror(errno));
         return false;
     }
 
-    string pinStr = to_string(m_pin);
-    write(fd, pinStr.c_str(), pinStr.length()); 
-    close(fd);
     // Set direction (in/out).
-    string dirPath = m_path + "/direction";
-    fd = open(dirPath.c_str(), O_WRONLY);
-    if (fd == -1) {
-        perror("GPIO: Erro ao abrir direction");
+    if (!writeSysfs(m_path + "/direction", (m_dir == OUT) ? "out" : "in")) {
+        LOG_ERROR("GPIO: Erro ao abrir direction: %s", strerror(errno));
         return false;
     }
 
-    const char* d = (m_dir == OUT) ? "out" : "in";
-    write(fd, d, strlen(d)); 
+    if (m_dir == IN && m_edge != EDGE_NONE) {
+        // Edge interrupts are reported as POLLPRI on the value file.
+        static const char* const EDGE_NAMES[] = {"none", "rising", "falling", "both"};
+        if (!writeSysfs(m_path + "/edge", EDGE_NAMES[m_edge])) {
+            LOG_ERROR("GPIO: Erro ao abrir edge: %s", strerror(errno));
+            return false;
+        }
+    }
+
+    if (!openValue()) {
+        LOG_ERROR("GPIO: Erro ao abrir value (pino %d): %s", m_pin, strerror(errno));
+        return false;
+    }
+    if (m_edge != EDGE_NONE) {
+        // The first poll reports POLLPRI until the value has been read once.
+        char level;
+        pread(m_valueFd, &level, 1, 0);
+        m_io.syscall();
+    }
+    return true;
+}
+
+bool C_GPIO::writeSysfs(const string& path, const char* value) {
+    C_IoOp op(m_io);
+    int fd = open(path.c_str(), O_WRONLY);
+    m_io.syscall();
+    if (fd == -1) {
+        m_io.error();
+        return false;
+    }
+    // A write error (e.g. export of a line already exported) is not fatal.
+    size_t len = strlen(value);
+    if (write(fd, value, len) == static_cast<ssize_t>(len)) m_io.bytes(len);
     close(fd);
+    m_io.syscall(2);
+    return true;
+}
+
+int C_GPIO::requestLines(const uint32_t* offsets, unsigned count,
+                         GPIO_DIRECTION dir, GPIO_EDGE edge) {
+    if (count == 0 || count > GPIO_V2_LINES_MAX) return -1;
+
+    int chipFd = open(chipPath().c_str(), O_RDONLY | O_CLOEXEC);
+    if (chipFd == -1) {
+        LOG_ERROR("GPIO: Erro ao abrir %s: %s", chipPath().c_str(), strerror(errno));
+        return -1;
+    }
+
+    struct gpio_v2_line_request req;
+    memset(&req, 0, sizeof(req));
+    memcpy(req.offsets, offsets, count * sizeof(uint32_t));
+    req.num_lines = count;
+    strncpy(req.consumer, GPIO_CONSUMER, sizeof(req.consumer) - 1);
+
+    if (dir == OUT) {
+        // Outputs start low, like a freshly exported sysfs line.
+        req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+        req.config.num_attrs = 1;
+        req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values = 0;
+        req.config.attrs[0].mask = (count == 64) ? ~0ULL : ((1ULL << count) - 1);
+    } else {
+        req.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+        if (edge == EDGE_RISING || edge == EDGE_BOTH) req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+        if (edge == EDGE_FALLING || edge == EDGE_BOTH) req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    }
+
+    int rc = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req);
+    int err = errno;
+    close(chipFd);
+    if (rc == -1) {
+        LOG_ERROR("GPIO: Pedido de %u linha(s) a partir de %u falhou: %s", count, offsets[0], strerror(err));
+        return -1;
+    }
+    return req.fd;
+}
+
+bool C_GPIO::initChardev() {
+    uint32_t offset = static_cast<uint32_t>(m_pin);
+    int fd = requestLines(&offset, 1, m_dir, m_edge);
+    m_io.syscall(3);   // open chip, line request, close chip.
+    if (fd == -1) {
+        m_io.error();
+        return false;
+    }
+    attachLine(fd, 0);
+    m_ownsLine = true;
     return true;
 }
 
+void C_GPIO::attachLine(int fd, unsigned bit) {
+    releaseLine();
+    m_lineFd = fd;
+    m_lineBit = bit;
+    m_ownsLine = false;
+}
+
+void C_GPIO::releaseLine() {
+    // Grouped lines are released by their C_GPIOLines.
+    if (m_lineFd != -1 && m_ownsLine) close(m_lineFd);
+    m_lineFd = -1;
+    m_ownsLine = false;
+}
+
+bool C_GPIO::openValue() {
+    string valPath = m_path + "/value";
+    m_valueFd = open(valPath.c_str(), ((m_dir == OUT) ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    m_io.syscall();
+    if (m_valueFd == -1) m_io.error();
+    return m_valueFd != -1;
+}
+
+void C_GPIO::closeValue() {
+    if (m_valueFd != -1) {
+        close(m_valueFd);
+        m_io.syscall();
+        m_valueFd = -1;
+    }
+}
+
 
 void C_GPIO::closePin() {
-    // Unexport to free the pin.
-    int fd = open("/sys/class/gpio/unexport", O_WRONLY);
-    if (fd != -1) {
-        string pinStr = to_string(m_pin);
-        write(fd, pinStr.c_str(), pinStr.length());
-        close(fd);
+    if (m_lineFd != -1) {
+        // chardev: releasing the request frees the line, nothing to unexport.
+        releaseLine();
+        return;
     }
+    if (s_backend == GPIO_BACKEND_CHARDEV) return;
+
+    closeValue();
+
+    // Unexport to free the pin.
+    writeSysfs(C_HalPaths::path("/sys/class/gpio/unexport"), to_string(m_pin + GPIO_BASE).c_str());
 }
 
 
 void C_GPIO::writePin(bool value) {
     if (m_dir != OUT) return;
-    // Write 0/1 to the value file.
-    string valPath = m_path + "/value";
-    int fd = open(valPath.c_str(), O_WRONLY);
-    if (fd == -1) return;
-    
-    if (value) {
-        write(fd, "1", 1);
-    } else {
-        write(fd, "0", 1);
+    C_IoOp op(m_io);
+
+    if (m_lineFd != -1) {
+        struct gpio_v2_line_values vals;
+        vals.mask = 1ULL << m_lineBit;
+        vals.bits = value ? vals.mask : 0;
+        m_io.syscall();
+        if (ioctl(m_lineFd, GPIO_V2_LINE_SET_VALUES_IOCTL, &vals) == -1) m_io.error();
+        return;
     }
 
-    close(fd);
+    // Pin exported outside init(): open the value file on first use.
+    if (m_valueFd == -1 && (s_backend == GPIO_BACKEND_CHARDEV || !openValue())) return;
+
+    // sysfs attributes are rewritten from offset 0: one syscall per toggle.
+    m_io.syscall();
+    if (pwrite(m_valueFd, value ? "1" : "0", 1, 0) == 1) m_io.bytes(1);
+    else m_io.error();
 }
 
 bool C_GPIO::readPin() {
-    // Read the value file from sysfs.
-    string valPath = m_path + "/value";
+    C_IoOp op(m_io);
+    if (m_lineFd != -1) {
+        struct gpio_v2_line_values vals;
+        vals.mask = 1ULL << m_lineBit;
+        vals.bits = 0;
+        m_io.syscall();
+        if (ioctl(m_lineFd, GPIO_V2_LINE_GET_VALUES_IOCTL, &vals) == -1) {
+            m_io.error();
+            return false;
+        }
+        return (vals.bits & vals.mask) != 0;
+    }
 
-    int fd = open(valPath.c_str(), O_RDONLY);
-    if (fd == -1) return false;
+    if (m_valueFd == -1 && (s_backend == GPIO_BACKEND_CHARDEV || !openValue())) return false;
 
     char buffer[1] = {0};
-    read(fd, buffer, 1); 
-    close(fd);
+    m_io.syscall();
+    if (pread(m_valueFd, buffer, 1, 0) != 1) {
+        m_io.error();
+        return false;
+    }
+    m_io.bytes(1);
 
     return (buffer[0] == '1');
 }
+
+int C_GPIO::eventFd() const {
+    if (m_edge == EDGE_NONE) return -1;
+    return (m_lineFd != -1) ? m_lineFd : m_valueFd;
+}
+
+bool C_GPIO::readEvent(S_GpioEvent& event) {
+    if (m_edge == EDGE_NONE) return false;
+    C_IoOp op(m_io);
+
+    if (m_lineFd != -1) {
+        struct gpio_v2_line_event ev;
+        m_io.syscall();
+        if (read(m_lineFd, &ev, sizeof(ev)) != static_cast<ssize_t>(sizeof(ev))) {
+            m_io.error();
+            return false;
+        }
+        m_io.bytes(sizeof(ev));
+        event.timestampNs = ev.timestamp_ns;
+        event.rising = (ev.id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+        event.seqno = ev.line_seqno;
+        if (m_lastSeqno != 0 && ev.line_seqno > m_lastSeqno + 1) {
+            LOG_WARN("GPIO: pino %d perdeu %u evento(s)", m_pin, ev.line_seqno - m_lastSeqno - 1);
+        }
+        m_lastSeqno = ev.line_seqno;
+        return true;
+    }
+
+    // sysfs: the level after the edge; re-reading from 0 also re-arms POLLPRI.
+    if (m_valueFd == -1) return false;
+    char buffer[1] = {0};
+    m_io.syscall();
+    if (pread(m_valueFd, buffer, 1, 0) != 1) {
+        m_io.error();
+        return false;
+    }
+    m_io.bytes(1);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    event.timestampNs = static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+    event.rising = (buffer[0] == '1');
+    event.seqno = ++m_lastSeqno;
+    return true;
+}
+
+
+static uint64_t benchNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void logBench(const C_IoStats& io, int toggles, uint64_t elapsedNs) {
+    LOG_INFO("[GPIO bench] %d escritas em %.1f ms (%.2f us/escrita)", toggles,
+             static_cast<double>(elapsedNs) / 1e6, static_cast<double>(elapsedNs) / 1e3 / toggles);
+    io.log();
+}
+
+void C_GPIO::benchmark(int pin, int toggles) {
+    if (toggles <= 0) return;
+    const GpioBackend_enum saved = s_backend;
+    LOG_INFO("[GPIO bench] Pino %d, %d escritas por caminho", pin, toggles);
+
+    s_backend = GPIO_BACKEND_SYSFS;
+    {
+        C_GPIO gpio(pin, OUT);
+        if (!gpio.init()) {
+            LOG_WARN("[GPIO bench] sysfs indisponível: caminhos sysfs ignorados");
+        } else {
+            // Persistent value fd: one pwrite per toggle.
+            gpio.m_io.reset();
+            gpio.m_io.setName("sysfs pwrite");
+            uint64_t t0 = benchNowNs();
+            for (int i = 0; i < toggles; ++i) gpio.writePin(i & 1);
+            logBench(gpio.m_io, toggles, benchNowNs() - t0);
+
+            // The pre-fd path, on the same exported line: path build + open/write/close.
+            C_IoStats legacy("gpio");
+            legacy.setName("sysfs open/write/close");
+            t0 = benchNowNs();
+            for (int i = 0; i < toggles; ++i) {
+                C_IoOp op(legacy);
+                std::string path = C_HalPaths::path("/sys/class/gpio/gpio" + to_string(pin + GPIO_BASE) + "/value");
+                int fd = open(path.c_str(), O_WRONLY);
+                legacy.syscall();
+                if (fd == -1) {
+                    legacy.error();
+                    continue;
+                }
+                if (write(fd, (i & 1) ? "1" : "0", 1) == 1) legacy.bytes(1);
+                else legacy.error();
+                close(fd);
+                legacy.syscall(2);
+            }
+            logBench(legacy, toggles, benchNowNs() - t0);
+        }
+    }
+
+    s_backend = GPIO_BACKEND_CHARDEV;
+    if (access(chipPath().c_str(), F_OK) != 0) {
+        LOG_WARN("[GPIO bench] %s indisponível: caminho chardev ignorado", chipPath().c_str());
+    } else {
+        C_GPIO gpio(pin, OUT);
+        if (gpio.init()) {
+            gpio.m_io.reset();
+            gpio.m_io.setName("chardev ioctl");
+            uint64_t t0 = benchNowNs();
+            for (int i = 0; i < toggles; ++i) gpio.writePin(i & 1);
+            logBench(gpio.m_io, toggles, benchNowNs() - t0);
+        }
+    }
+    s_backend = saved;
+}
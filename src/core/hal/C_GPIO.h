@@ -2,28 +2,105 @@
 #define C_GPIO_H
 
 /*
- * Simple GPIO abstraction via sysfs.
- * Used for digital signals (input/output).
+ * GPIO line abstraction with two kernel backends:
+ *  - sysfs (/sys/class/gpio): value file opened once in init(); reads/writes are
+ *    a single pread/pwrite at offset 0.
+ *  - chardev (/dev/gpiochipN, v2 line requests): no export, lines can be requested
+ *    together (C_GPIOLines) and edge events carry kernel timestamps.
+ * The backend is chosen at build time (GPIO_DEFAULT_BACKEND) or before init()
+ * with setBackend().
  */
 
+#include <cstdint>
 #include <string>
 
+#include "C_IoStats.h"
+
 using namespace std;
 
 enum GPIO_DIRECTION { IN, OUT };
 
+enum GPIO_EDGE { EDGE_NONE, EDGE_RISING, EDGE_FALLING, EDGE_BOTH };
+
+enum GpioBackend_enum : uint8_t {
+    GPIO_BACKEND_SYSFS = 0,
+    GPIO_BACKEND_CHARDEV
+};
+
+#ifndef GPIO_DEFAULT_BACKEND
+#define GPIO_DEFAULT_BACKEND GPIO_BACKEND_SYSFS
+#endif
+
+#define GPIO_CONSUMER "secureasset"
+
+// sysfs numbers are global: logical pins start at the platform base.
+#define GPIO_BASE 512
+
+struct S_GpioEvent {
+    uint64_t timestampNs;   // Kernel timestamp (chardev) or CLOCK_MONOTONIC at read (sysfs).
+    bool rising;
+    uint32_t seqno;
+};
+
 class C_GPIO {
+    friend class C_GPIOLines;
+
 public:
-    C_GPIO(int pin, GPIO_DIRECTION dir);
+    C_GPIO(int pin, GPIO_DIRECTION dir, GPIO_EDGE edge = EDGE_NONE);
     ~C_GPIO();
+
+    C_GPIO(const C_GPIO&) = delete;
+    C_GPIO& operator=(const C_GPIO&) = delete;
+
+    // Process-wide backend for lines initialized afterwards.
+    static void setBackend(GpioBackend_enum backend, int chip);
+    static GpioBackend_enum backend();
+    static std::string chipPath();
+
+    // Toggle an output 'toggles' times on each write path (sysfs open/write/close
+    // per toggle, sysfs persistent fd + pwrite, chardev) and log ops, syscalls and
+    // latency of each. Paths whose interface is missing are skipped.
+    static void benchmark(int pin, int toggles);
+
     bool init();
     void closePin();
     void writePin(bool value);
     bool readPin();
+
+    // Edge events (inputs built with an edge): fd to poll (POLLIN chardev,
+    // POLLPRI sysfs) and the event behind a wakeup.
+    int eventFd() const;
+    bool readEvent(S_GpioEvent& event);
+
+    int pin() const { return m_pin; }
+    const C_IoStats& ioStats() const { return m_io; }
+
 private:
-    int m_pin;
+    int m_pin;                 // Line offset on the chip.
     GPIO_DIRECTION m_dir;
+    GPIO_EDGE m_edge;
     string m_path;
+    int m_valueFd;             // sysfs value file.
+
+    // chardev: line request fd and this line's bit in it (shared when grouped).
+    int m_lineFd;
+    unsigned m_lineBit;
+    bool m_ownsLine;
+    uint32_t m_lastSeqno;
+    C_IoStats m_io;
+
+    // open + write + close of a sysfs attribute (export, direction, edge).
+    bool writeSysfs(const string& path, const char* value);
+    bool openValue();
+    void closeValue();
+    bool initSysfs();
+    bool initChardev();
+    void releaseLine();
+    void attachLine(int fd, unsigned bit);
+
+    // One v2 line request for 'count' offsets of the configured chip; -1 on error.
+    static int requestLines(const uint32_t* offsets, unsigned count,
+                            GPIO_DIRECTION dir, GPIO_EDGE edge);
 };
 
-#endif 
+#endif
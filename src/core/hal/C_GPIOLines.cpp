@@ -0,0 +1,107 @@
+/*
+ * Multi-line GPIO requests (uAPI v2) with a per-line sysfs fallback.
+ */
+
+#include "C_GPIOLines.h"
+#include "C_GPIO.h"
+#include "C_Logger.h"
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+C_GPIOLines::C_GPIOLines(std::initializer_list<C_GPIO*> lines)
+    : m_lines(lines),
+      m_fd(-1) {
+}
+
+C_GPIOLines::~C_GPIOLines() {
+    release();
+}
+
+uint64_t C_GPIOLines::all() const {
+    return (m_lines.size() >= 64) ? ~0ULL : ((1ULL << m_lines.size()) - 1);
+}
+
+bool C_GPIOLines::init() {
+    release();
+
+    if (C_GPIO::backend() != GPIO_BACKEND_CHARDEV) {
+        for (C_GPIO* line : m_lines) {
+            if (!line->init()) return false;
+        }
+        return true;
+    }
+
+    if (m_lines.empty() || m_lines.size() > GPIO_V2_LINES_MAX) return false;
+    std::vector<uint32_t> offsets;
+    for (C_GPIO* line : m_lines) {
+        if (line->m_dir != m_lines[0]->m_dir) {
+            LOG_ERROR("GPIO: grupo com direções diferentes");
+            return false;
+        }
+        offsets.push_back(static_cast<uint32_t>(line->m_pin));
+    }
+
+    m_fd = C_GPIO::requestLines(offsets.data(), static_cast<unsigned>(offsets.size()),
+                                m_lines[0]->m_dir, EDGE_NONE);
+    if (m_fd == -1) return false;
+
+    // Single-line calls on the members go through the shared request.
+    for (size_t i = 0; i < m_lines.size(); ++i) {
+        m_lines[i]->attachLine(m_fd, static_cast<unsigned>(i));
+    }
+    return true;
+}
+
+void C_GPIOLines::release() {
+    if (m_fd == -1) return;
+    for (C_GPIO* line : m_lines) {
+        if (line->m_lineFd == m_fd) line->attachLine(-1, 0);
+    }
+    close(m_fd);
+    m_fd = -1;
+}
+
+bool C_GPIOLines::set(uint64_t mask, uint64_t bits) {
+    mask &= all();
+    if (m_fd != -1) {
+        // Group ioctls are accounted on the first line.
+        C_IoStats& io = m_lines[0]->m_io;
+        C_IoOp op(io);
+        struct gpio_v2_line_values vals;
+        vals.mask = mask;
+        vals.bits = bits & mask;
+        io.syscall();
+        if (ioctl(m_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &vals) != 0) {
+            io.error();
+            return false;
+        }
+        return true;
+    }
+    for (size_t i = 0; i < m_lines.size(); ++i) {
+        if (mask & (1ULL << i)) m_lines[i]->writePin((bits >> i) & 1ULL);
+    }
+    return true;
+}
+
+uint64_t C_GPIOLines::get(uint64_t mask) {
+    mask &= all();
+    if (m_fd != -1) {
+        C_IoStats& io = m_lines[0]->m_io;
+        C_IoOp op(io);
+        struct gpio_v2_line_values vals;
+        vals.mask = mask;
+        vals.bits = 0;
+        io.syscall();
+        if (ioctl(m_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &vals) == -1) {
+            io.error();
+            return 0;
+        }
+        return vals.bits & mask;
+    }
+    uint64_t bits = 0;
+    for (size_t i = 0; i < m_lines.size(); ++i) {
+        if ((mask & (1ULL << i)) && m_lines[i]->readPin()) bits |= 1ULL << i;
+    }
+    return bits;
+}
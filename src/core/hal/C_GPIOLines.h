@@ -0,0 +1,39 @@
+#ifndef C_GPIOLINES_H
+#define C_GPIOLINES_H
+
+/*
+ * Group of same-direction GPIO lines driven together.
+ * chardev: one line request for the whole group; set()/get() are a single ioctl,
+ * so all lines change in the same instant. sysfs: each line is initialized and
+ * written in turn (same API, not atomic).
+ */
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+class C_GPIO;
+
+class C_GPIOLines {
+public:
+    C_GPIOLines(std::initializer_list<C_GPIO*> lines);
+    ~C_GPIOLines();
+
+    C_GPIOLines(const C_GPIOLines&) = delete;
+    C_GPIOLines& operator=(const C_GPIOLines&) = delete;
+
+    bool init();
+    void release();
+
+    // Bit i is the i-th line given to the constructor; lines outside 'mask' keep their value.
+    bool set(uint64_t mask, uint64_t bits);
+    uint64_t get(uint64_t mask);
+
+    uint64_t all() const;
+
+private:
+    std::vector<C_GPIO*> m_lines;
+    int m_fd;
+};
+
+#endif
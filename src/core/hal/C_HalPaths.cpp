@@ -0,0 +1,19 @@
+/*
+ * HAL path prefix (simulation support).
+ */
+
+#include "C_HalPaths.h"
+
+static std::string s_root;
+
+void C_HalPaths::setRoot(const std::string& root) {
+    s_root = root;
+}
+
+const std::string& C_HalPaths::root() {
+    return s_root;
+}
+
+std::string C_HalPaths::path(const std::string& absolute) {
+    return s_root + absolute;
+}
@@ -0,0 +1,22 @@
+#ifndef C_HALPATHS_H
+#define C_HALPATHS_H
+
+/*
+ * Root prefix for every device node and sysfs path the HAL opens.
+ * Empty on the target; a temporary tree (fake sysfs, pty symlinks) when the
+ * hardware is simulated. Must be set before any HAL object is constructed.
+ */
+
+#include <string>
+
+class C_HalPaths {
+public:
+    static void setRoot(const std::string& root);
+    static const std::string& root();
+    static bool simulated() { return !root().empty(); }
+
+    // "/sys/class/gpio/export" -> "<root>/sys/class/gpio/export".
+    static std::string path(const std::string& absolute);
+};
+
+#endif
@@ -3,19 +3,32 @@
  */
 
 #include "C_I2C.h"
-#include <iostream>
+#include "C_Logger.h"
+#include "C_HalPaths.h"
 #include <fcntl.h>      
 #include <unistd.h>     
 #include <sys/ioctl.h>  
 #include <linux/i2c-dev.h> 
+#include <linux/i2c.h>
+#include <cerrno>
+#include <cstdio>
 
 using namespace std;
 
+static C_I2CSimBus* s_simBus = nullptr;
+
+void C_I2C::setSimBus(C_I2CSimBus* bus) {
+    s_simBus = bus;
+}
+
 C_I2C::C_I2C(int i2cbusnum, uint8_t slave_address)
-    : m_slaveaddress(slave_address), m_fd(-1)
+    : m_slaveaddress(slave_address), m_fd(-1), m_io("i2c")
 {
     // Define I2C bus path (e.g., /dev/i2c-1).
-    m_devicePath = "/dev/i2c-" + to_string(i2cbusnum);
+    m_devicePath = C_HalPaths::path("/dev/i2c-" + to_string(i2cbusnum));
+    char addr[8];
+    snprintf(addr, sizeof(addr), "@0x%02X", m_slaveaddress);
+    m_io.setName(m_devicePath + addr);
 }
 
 
@@ -24,15 +37,21 @@ C_I2C::~C_I2C() {
 }
 
 bool C_I2C::init() {
-    // Open device and select slave.
+    // Open device and select slave (a retry reopens it).
+    closeI2C();
+    if (s_simBus) return true;
     m_fd = open(m_devicePath.c_str(), O_RDWR);
+    m_io.syscall();
     if (m_fd < 0) {
-        cerr << "C_I2C: Erro ao abrir dev/...\n";
+        m_io.error();
+        LOG_ERROR("C_I2C: Erro ao abrir dev/...");
         return false;
     }
 
+    m_io.syscall();
     if (ioctl(m_fd, I2C_SLAVE, m_slaveaddress) < 0) {
-        cerr<<"C_I2C: Erro ao definir slave (ioctl)\n";
+        m_io.error();
+        LOG_ERROR("C_I2C: Erro ao definir slave (ioctl)");
         return false;
     }
 
@@ -42,6 +61,7 @@ bool C_I2C::init() {
 void C_I2C::closeI2C() {
     if (m_fd >= 0) {
         close(m_fd);
+        m_io.syscall();
         m_fd = -1;
     }
 }
@@ -54,21 +74,17 @@ bool C_I2C::writeRegister(uint8_t reg, uint8_t value) {
     buffer[0] = reg;
     buffer[1] = value;
 
-    if (write(m_fd, buffer, 2) != 2) {
-        cerr<<"C_I2C: Erro ao escrever no registo\n";
+    if (!transfer(buffer, 2, nullptr, 0)) {
+        LOG_ERROR("C_I2C: Erro ao escrever no registo");
         return false;
     }
     return true;
 }
 
 bool C_I2C::readRegister(uint8_t reg, uint8_t& value) {
-    // Point to register and read 1 byte.
-    if (write(m_fd, &reg, 1) != 1) {
-        cerr<<"C_I2C: Erro ao definir o registo\n";
-        return false;
-    }
-    if (read(m_fd, &value, 1) != 1) {
-        cerr<<"C_I2C: Erro ao ler do registo definido\n";
+    // Point to register and read 1 byte (repeated start).
+    if (!transfer(&reg, 1, &value, 1)) {
+        LOG_ERROR("C_I2C: Erro ao ler do registo 0x%02X", static_cast<int>(reg));
         return false;
     }
     return true;
@@ -78,20 +94,67 @@ bool C_I2C::readRegister(uint8_t reg, uint8_t& value) {
 bool C_I2C::readBytes(uint8_t reg, uint8_t* buffer, size_t len) {
 
     // Read a block starting at the given register.
-    if (write(m_fd, &reg, 1) != 1) {
-        cerr<<"C_I2C: Erro ao definir registo inicial\n";
+    if (!transfer(&reg, 1, buffer, len)) {
+        LOG_ERROR("C_I2C: Erro na leitura do bloco (registo 0x%02X)", static_cast<int>(reg));
         return false;
     }
-    
-    if (read(m_fd, buffer, len) != static_cast<ssize_t>(len)) {
-        cerr<<"C_I2C: Erro na leitura do bloco\n";
+
+    return true;
+}
+
+bool C_I2C::transfer(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) {
+    C_IoOp op(m_io);
+    if (s_simBus) {
+        if (s_simBus->transfer(m_slaveaddress, tx, txLen, rx, rxLen)) {
+            m_io.bytes(txLen + rxLen);
+            return true;
+        }
+        m_io.error();
+        errno = ENXIO;
+        return false;
+    }
+    if (m_fd < 0) {
+        m_io.error();
+        errno = EBADF;
         return false;
     }
 
+    struct i2c_msg msgs[2];
+    int count = 0;
+    if (txLen > 0) {
+        msgs[count].addr = m_slaveaddress;
+        msgs[count].flags = 0;
+        msgs[count].len = static_cast<uint16_t>(txLen);
+        msgs[count].buf = const_cast<uint8_t*>(tx);
+        ++count;
+    }
+    if (rxLen > 0) {
+        msgs[count].addr = m_slaveaddress;
+        msgs[count].flags = I2C_M_RD;
+        msgs[count].len = static_cast<uint16_t>(rxLen);
+        msgs[count].buf = rx;
+        ++count;
+    }
+    if (count == 0) return true;
+
+    struct i2c_rdwr_ioctl_data xfer;
+    xfer.msgs = msgs;
+    xfer.nmsgs = static_cast<uint32_t>(count);
+    m_io.syscall();
+    if (ioctl(m_fd, I2C_RDWR, &xfer) != count) {
+        m_io.error();
+        return false;
+    }
+    m_io.bytes(txLen + rxLen);
     return true;
 }
 
+bool C_I2C::writeCommand(uint16_t cmd) {
+    uint8_t buffer[2] = {static_cast<uint8_t>(cmd >> 8), static_cast<uint8_t>(cmd & 0xFF)};
+    return transfer(buffer, 2, nullptr, 0);
+}
+
 ssize_t C_I2C::readRaw(uint8_t* buffer, size_t len) {
     // Raw read without selecting a register.
-    return read(m_fd, buffer, len);
+    return transfer(nullptr, 0, buffer, len) ? static_cast<ssize_t>(len) : -1;
 }
@@ -3,17 +3,30 @@
 
 /*
  * I2C abstraction (device file + slave ioctl).
+ * Register reads and command/response exchanges go out as one I2C_RDWR
+ * transaction (write, repeated start, read) so no other master or thread can
+ * slip in between the two halves.
  */
 
 #include <string>
 #include <cstdint> 
+#include "C_IoStats.h"
 using namespace std;
 
+// In-process stand-in for the devices on a bus (hardware simulation).
+class C_I2CSimBus {
+public:
+    virtual ~C_I2CSimBus() = default;
+    // Same contract as C_I2C::transfer(); false = NACK.
+    virtual bool transfer(uint8_t addr, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) = 0;
+};
+
 
 class C_I2C {
     uint8_t m_slaveaddress;
     int m_fd;
     string m_devicePath;
+    C_IoStats m_io;
 public:
     C_I2C(int i2cbusnum, uint8_t slave_address);
     ~C_I2C();
@@ -23,6 +36,16 @@ public:
     bool readRegister(uint8_t reg, uint8_t& value);
     bool readBytes(uint8_t reg, uint8_t* buffer, size_t len);
     ssize_t readRaw(uint8_t* buffer, size_t len);
+
+    // Combined transfer; either half may be empty. errno is kept on failure.
+    bool transfer(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen);
+    // 16-bit big-endian command (e.g. SHT3x) in a single write.
+    bool writeCommand(uint16_t cmd);
+
+    const C_IoStats& ioStats() const { return m_io; }
+
+    // Route every bus opened afterwards to a simulated bus (nullptr: real device).
+    static void setSimBus(C_I2CSimBus* bus);
 };
 
 #endif 
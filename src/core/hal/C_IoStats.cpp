@@ -0,0 +1,102 @@
+/*
+ * HAL I/O accounting: histogram, snapshots and the registry of live devices.
+ */
+
+#include "C_IoStats.h"
+#include "C_Logger.h"
+#include <mutex>
+
+static std::mutex s_registryMutex;
+static C_IoStats* s_registry = nullptr;
+
+uint32_t S_IoSnapshot::percentileUs(double fraction) const {
+    if (ops == 0) return 0;
+    uint64_t total = 0;
+    for (uint32_t count : latency) total += count;
+    const uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(total));
+    uint64_t seen = 0;
+    for (int i = 0; i < IO_LAT_BUCKETS - 1; ++i) {
+        seen += latency[i];
+        if (seen > target) return 1u << i;
+    }
+    return maxUs;
+}
+
+C_IoStats::C_IoStats(const char* kind)
+    : m_kind(kind),
+      m_next(nullptr),
+      m_prev(nullptr)
+{
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    m_next = s_registry;
+    if (s_registry) s_registry->m_prev = this;
+    s_registry = this;
+}
+
+C_IoStats::~C_IoStats() {
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    if (m_prev) m_prev->m_next = m_next;
+    else s_registry = m_next;
+    if (m_next) m_next->m_prev = m_prev;
+}
+
+void C_IoStats::setName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    m_name = name;
+}
+
+#if HAL_IO_STATS
+void C_IoStats::op(uint64_t elapsedNs) {
+    m_ops.fetch_add(1, std::memory_order_relaxed);
+
+    const uint64_t us = elapsedNs / 1000;
+    int bucket = 0;
+    while (bucket < IO_LAT_BUCKETS - 1 && (us >> bucket) != 0) ++bucket;
+    m_latency[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    const uint32_t clamped = (us > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(us);
+    uint32_t seen = m_maxUs.load(std::memory_order_relaxed);
+    while (clamped > seen && !m_maxUs.compare_exchange_weak(seen, clamped, std::memory_order_relaxed)) {}
+}
+#endif
+
+S_IoSnapshot C_IoStats::snapshot() const {
+    S_IoSnapshot snap;
+    snap.ops = m_ops.load(std::memory_order_relaxed);
+    snap.syscalls = m_syscalls.load(std::memory_order_relaxed);
+    snap.bytes = m_bytes.load(std::memory_order_relaxed);
+    snap.errors = m_errors.load(std::memory_order_relaxed);
+    snap.maxUs = m_maxUs.load(std::memory_order_relaxed);
+    for (int i = 0; i < IO_LAT_BUCKETS; ++i) {
+        snap.latency[i] = m_latency[i].load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+void C_IoStats::reset() {
+    m_ops.store(0, std::memory_order_relaxed);
+    m_syscalls.store(0, std::memory_order_relaxed);
+    m_bytes.store(0, std::memory_order_relaxed);
+    m_errors.store(0, std::memory_order_relaxed);
+    m_maxUs.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint32_t>& bucket : m_latency) bucket.store(0, std::memory_order_relaxed);
+}
+
+void C_IoStats::log() const {
+    const S_IoSnapshot s = snapshot();
+    if (s.ops == 0 && s.syscalls == 0) return;
+    LOG_INFO("[IO] %s %s: %llu ops, %llu syscalls (%.1f/op), %llu bytes, %llu erros, "
+             "latência p50<%u us p99<%u us max %u us",
+             m_kind, m_name.c_str(),
+             static_cast<unsigned long long>(s.ops), static_cast<unsigned long long>(s.syscalls),
+             s.ops ? static_cast<double>(s.syscalls) / static_cast<double>(s.ops) : 0.0,
+             static_cast<unsigned long long>(s.bytes), static_cast<unsigned long long>(s.errors),
+             s.percentileUs(0.5), s.percentileUs(0.99), s.maxUs);
+}
+
+void C_IoStats::logAll() {
+#if HAL_IO_STATS
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    for (const C_IoStats* stats = s_registry; stats; stats = stats->m_next) stats->log();
+#endif
+}
@@ -0,0 +1,108 @@
+#ifndef C_IOSTATS_H
+#define C_IOSTATS_H
+
+/*
+ * Per-device HAL I/O accounting: operations, syscalls, bytes, errors and a
+ * latency histogram of the operations (log2 buckets in microseconds).
+ * Each HAL object owns one; counters are relaxed atomics so any thread can read
+ * a snapshot while the owner keeps working. Every live instance is listed for
+ * logAll() (SIGUSR1 and shutdown). Build with HAL_IO_STATS=0 to compile it out.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#ifndef HAL_IO_STATS
+#define HAL_IO_STATS 1
+#endif
+
+// Bucket i counts operations that took [2^(i-1), 2^i) us; bucket 0 is < 1 us and
+// the last one everything from 2^(IO_LAT_BUCKETS-2) us up.
+#define IO_LAT_BUCKETS 16
+
+struct S_IoSnapshot {
+    uint64_t ops;
+    uint64_t syscalls;
+    uint64_t bytes;
+    uint64_t errors;
+    uint32_t maxUs;
+    uint32_t latency[IO_LAT_BUCKETS];
+
+    // Upper bound of the bucket holding the given fraction (0..1) of operations.
+    uint32_t percentileUs(double fraction) const;
+};
+
+class C_IoStats {
+public:
+    explicit C_IoStats(const char* kind);
+    ~C_IoStats();
+
+    C_IoStats(const C_IoStats&) = delete;
+    C_IoStats& operator=(const C_IoStats&) = delete;
+
+    // Device label for the logs (path, bus/address).
+    void setName(const std::string& name);
+
+#if HAL_IO_STATS
+    void syscall(unsigned count = 1) { m_syscalls.fetch_add(count, std::memory_order_relaxed); }
+    void bytes(size_t count) { m_bytes.fetch_add(count, std::memory_order_relaxed); }
+    void error() { m_errors.fetch_add(1, std::memory_order_relaxed); }
+    void op(uint64_t elapsedNs);
+#else
+    void syscall(unsigned = 1) {}
+    void bytes(size_t) {}
+    void error() {}
+    void op(uint64_t) {}
+#endif
+
+    S_IoSnapshot snapshot() const;
+    void reset();
+    void log() const;
+
+    // Every live HAL device with at least one operation.
+    static void logAll();
+
+private:
+    const char* m_kind;
+    std::string m_name;
+    std::atomic<uint64_t> m_ops{0};
+    std::atomic<uint64_t> m_syscalls{0};
+    std::atomic<uint64_t> m_bytes{0};
+    std::atomic<uint64_t> m_errors{0};
+    std::atomic<uint32_t> m_maxUs{0};
+    std::atomic<uint32_t> m_latency[IO_LAT_BUCKETS] = {};
+
+    C_IoStats* m_next;   // Registry links (guarded by the registry mutex).
+    C_IoStats* m_prev;
+};
+
+// Times one operation, from construction to the end of the scope.
+class C_IoOp {
+public:
+#if HAL_IO_STATS
+    explicit C_IoOp(C_IoStats& stats) : m_stats(stats), m_startNs(nowNs()) {}
+    ~C_IoOp() { m_stats.op(nowNs() - m_startNs); }
+#else
+    explicit C_IoOp(C_IoStats&) {}
+#endif
+
+    C_IoOp(const C_IoOp&) = delete;
+    C_IoOp& operator=(const C_IoOp&) = delete;
+
+private:
+#if HAL_IO_STATS
+    C_IoStats& m_stats;
+    uint64_t m_startNs;
+
+    static uint64_t nowNs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+#endif
+};
+
+#endif
@@ -5,8 +5,10 @@
 #include "C_PWM.h"
 #include <fcntl.h>
 #include <unistd.h>
-#include <string>
-#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include "C_Logger.h"
+#include "C_HalPaths.h"
 #include <cerrno>   
 #include <cstring>  
 
@@ -14,129 +16,202 @@ using namespace std;
 
 C_PWM::C_PWM(int chip, int channel)
     : m_pwmChip(chip), m_pwmChannel(channel),
-      m_fd_period(0), m_fd_duty(0),m_fd_enable(false)
+      m_fd_period(-1), m_fd_duty(-1), m_fd_enable(-1),
+      m_periodNs(-1), m_dutyNs(-1), m_enabled(-1),
+      m_io("pwm")
 {
+    m_path = C_HalPaths::path("/sys/class/pwm/pwmchip" + to_string(m_pwmChip) + "/pwm" + to_string(m_pwmChannel));
+    m_io.setName(m_path);
 }
 
 C_PWM::~C_PWM()
 {
     // Disable and unexport the PWM channel.
     setEnable(false);
-    string unexportPath = "/sys/class/pwm/pwmchip" + to_string(m_pwmChip) + "/unexport";
-    int fd = open(unexportPath.c_str(), O_WRONLY);
-    if (fd >= 0) {
-        string channel = to_string(m_pwmChannel);
-        write(fd, channel.c_str(), channel.size());
-        close(fd);
+    closeAttrs();
+    writeSysfs(C_HalPaths::path("/sys/class/pwm/pwmchip" + to_string(m_pwmChip) + "/unexport"),
+               to_string(m_pwmChannel));
+}
+
+bool C_PWM::writeSysfs(const string& path, const string& value)
+{
+    // One-off attribute (export/unexport): open + write + close.
+    C_IoOp op(m_io);
+    int fd = open(path.c_str(), O_WRONLY);
+    m_io.syscall();
+    if (fd < 0)
+    {
+        m_io.error();
+        return false;
     }
+    bool ok = write(fd, value.c_str(), value.size()) >= 0;
+    int err = errno;
+    close(fd);
+    m_io.syscall(2);
+    if (ok) m_io.bytes(value.size());
+    else m_io.error();
+    errno = err;
+    return ok;
 }
 
 bool C_PWM::init()
 {
-    string pwmPath = "/sys/class/pwm/pwmchip" + to_string(m_pwmChip) + "/pwm" + to_string(m_pwmChannel);
-
-    // If it already exists, consider it initialized.
-    if (access(pwmPath.c_str(), F_OK) == 0)
+    // If it already exists, consider it exported.
+    m_io.syscall();
+    if (access(m_path.c_str(), F_OK) != 0)
     {
-        return true;
+        // Export the PWM channel in sysfs.
+        string exportPath = C_HalPaths::path("/sys/class/pwm/pwmchip" + to_string(m_pwmChip) + "/export");
+        if (!writeSysfs(exportPath, to_string(m_pwmChannel)) && errno != EBUSY)
+        {
+            LOG_ERROR("Erro ao exportar PWM: %s", strerror(errno));
+            return false;
+        }
     }
 
-    // Export the PWM channel in sysfs.
-    string exportPath = "/sys/class/pwm/pwmchip" + to_string(m_pwmChip) + "/export";
-    int fd = open(exportPath.c_str(), O_WRONLY);
-    if (fd < 0)
+    return openAttrs();
+}
+
+bool C_PWM::openAttrs()
+{
+    closeAttrs();
+    m_fd_period = open((m_path + "/period").c_str(), O_RDWR | O_CLOEXEC);
+    m_fd_duty = open((m_path + "/duty_cycle").c_str(), O_RDWR | O_CLOEXEC);
+    m_fd_enable = open((m_path + "/enable").c_str(), O_RDWR | O_CLOEXEC);
+    m_io.syscall(3);
+    if (m_fd_period < 0 || m_fd_duty < 0 || m_fd_enable < 0)
     {
-        // Error opening export.
-        cerr << "Erro ao abrir export: " << strerror(errno) << endl;
+        LOG_ERROR("Erro ao abrir atributos de %s: %s", m_path.c_str(), strerror(errno));
+        closeAttrs();
         return false;
     }
 
-    string channel = to_string(m_pwmChannel);
-    if (write(fd, channel.c_str(), channel.size()) < 0)
+    // Start from what the hardware has (the channel may survive a restart).
+    m_periodNs = readAttr(m_fd_period);
+    m_dutyNs = readAttr(m_fd_duty);
+    m_enabled = static_cast<int>(readAttr(m_fd_enable));
+    return true;
+}
+
+void C_PWM::closeAttrs()
+{
+    int* fds[] = {&m_fd_period, &m_fd_duty, &m_fd_enable};
+    for (int* fd : fds)
     {
-        if (errno != EBUSY) 
+        if (*fd >= 0)
         {
-            cerr << "Erro ao exportar PWM: " << strerror(errno) << endl;
-            close(fd);
-            return false;
+            close(*fd);
+            m_io.syscall();
         }
+        *fd = -1;
     }
+    m_periodNs = -1;
+    m_dutyNs = -1;
+    m_enabled = -1;
+}
 
-    close(fd);
-    return true;
+long C_PWM::readAttr(int fd)
+{
+    char buf[24];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    m_io.syscall();
+    if (n <= 0) return -1;
+    m_io.bytes(static_cast<size_t>(n));
+    buf[n] = '\0';
+    return strtol(buf, nullptr, 10);
 }
 
-bool C_PWM::setPeriodns(int s) {
-    // Set period in nanoseconds.
-    m_fd_period = s;
-    string periodPath =
-            "/sys/class/pwm/pwmchip" + to_string(m_pwmChip) +
-            "/pwm" + to_string(m_pwmChannel) + "/period";
-    int fd = open(periodPath.c_str(), O_WRONLY);
+bool C_PWM::writeAttr(int fd, long value, const char* name)
+{
     if (fd < 0)
     {
-        cerr << "Erro ao abrir period\n";
+        LOG_ERROR("Erro: PWM %s sem init", name);
         return false;
     }
-    string val = to_string(s);
-    if (write(fd, val.c_str(), val.size()) < 0) {
-        cerr << "Erro ao escrever period\n";
-        close(fd);
+    char buf[24];
+    int len = snprintf(buf, sizeof(buf), "%ld", value);
+    m_io.syscall();
+    if (pwrite(fd, buf, static_cast<size_t>(len), 0) < 0)
+    {
+        m_io.error();
+        LOG_ERROR("Erro ao escrever %s: %s", name, strerror(errno));
         return false;
     }
-    close(fd);
+    m_io.bytes(static_cast<size_t>(len));
     return true;
 }
 
-
-bool C_PWM::setDutyCycle(uint8_t duty) {
-    if (duty > 100) duty = 100;
-    m_fd_duty = duty;
-    int dutyns = (m_fd_period * duty) / 100;
-
-    // Duty cycle in nanoseconds computed from the period.
-    string dutyPath =
-            "/sys/class/pwm/pwmchip" + to_string(m_pwmChip) +
-            "/pwm" + to_string(m_pwmChannel) + "/duty_cycle";
-    int fd = open(dutyPath.c_str(), O_WRONLY);
-    if (fd < 0) {
-        cerr << "Erro ao abrir duty_cycle\n";
+bool C_PWM::writePeriod(long periodNs)
+{
+    if (periodNs == m_periodNs) return true;
+    if (!writeAttr(m_fd_period, periodNs, "period"))
+    {
+        m_periodNs = -1;
         return false;
     }
+    m_periodNs = periodNs;
+    return true;
+}
 
-    string val = to_string(dutyns);
-    if (write(fd, val.c_str(), val.size()) < 0) {
-        cerr << "Erro ao escrever duty_cycle\n";
-        close(fd);
+bool C_PWM::writeDuty(long dutyNs)
+{
+    if (dutyNs == m_dutyNs) return true;
+    if (!writeAttr(m_fd_duty, dutyNs, "duty_cycle"))
+    {
+        m_dutyNs = -1;
         return false;
     }
-
-    close(fd);
+    m_dutyNs = dutyNs;
     return true;
 }
 
+bool C_PWM::setPeriodns(int s) {
+    // Set period in nanoseconds.
+    C_IoOp op(m_io);
+    return writePeriod(s);
+}
+
+
+bool C_PWM::setDutyCycle(uint8_t duty) {
+    if (duty > 100) duty = 100;
+    // Duty cycle in nanoseconds computed from the period.
+    C_IoOp op(m_io);
+    return writeDuty((m_periodNs > 0) ? (m_periodNs * duty) / 100 : 0);
+}
+
 
 bool C_PWM::setEnable(bool enable)
 {
-    m_fd_enable = enable;
     // Enable/disable the PWM channel.
-    string enablePath =
-            "/sys/class/pwm/pwmchip" + to_string(m_pwmChip) +
-            "/pwm" + to_string(m_pwmChannel) + "/enable";
+    C_IoOp op(m_io);
+    return writeEnable(enable);
+}
 
-    int fd = open(enablePath.c_str(), O_WRONLY);
-    if (fd < 0)
-    {
-        cerr << "Erro ao abrir enable\n";
-        return false;
-    }
-    string val = enable ? "1" : "0";
-    if (write(fd, val.c_str(), val.size()) < 0)
+bool C_PWM::writeEnable(bool enable)
+{
+    int value = enable ? 1 : 0;
+    if (value == m_enabled) return true;
+    if (!writeAttr(m_fd_enable, value, "enable"))
     {
-        cerr << "Erro ao escrever enable\n";
-        close(fd);
+        m_enabled = -1;
         return false;
     }
-    close(fd);
+    m_enabled = value;
     return true;
 }
+
+bool C_PWM::update(int periodNs, uint8_t duty, bool enable)
+{
+    if (duty > 100) duty = 100;
+    long dutyNs = (static_cast<long>(periodNs) * duty) / 100;
+    C_IoOp op(m_io);
+
+    // The kernel rejects a period below the current duty: shrink duty first then.
+    bool ok;
+    if (m_dutyNs > periodNs) {
+        ok = writeDuty(dutyNs) && writePeriod(periodNs);
+    } else {
+        ok = writePeriod(periodNs) && writeDuty(dutyNs);
+    }
+    return ok && writeEnable(enable);
+}
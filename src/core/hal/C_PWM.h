@@ -2,23 +2,58 @@
 #define UNTITLED_C_PWM_H
 /*
  * PWM abstraction via sysfs.
+ * The period, duty_cycle and enable attributes stay open after init() and the
+ * values last written are cached: a call that changes nothing costs no syscall.
  */
 #include <cstdint>
+#include <string>
+
+#include "C_IoStats.h"
 
 class C_PWM
 {
 private:
     int m_pwmChip;
     int m_pwmChannel;
+    std::string m_path;
+
+    // Attribute descriptors (-1 until init()).
     int m_fd_period;
-    uint8_t m_fd_duty;
-    bool m_fd_enable;
+    int m_fd_duty;
+    int m_fd_enable;
+
+    // Hardware state as last written or read back; -1 = unknown.
+    long m_periodNs;
+    long m_dutyNs;
+    int m_enabled;
+
+    C_IoStats m_io;
+
+    bool openAttrs();
+    void closeAttrs();
+    long readAttr(int fd);
+    bool writeSysfs(const std::string& path, const std::string& value);
+    bool writeAttr(int fd, long value, const char* name);
+    bool writePeriod(long periodNs);
+    bool writeDuty(long dutyNs);
+    bool writeEnable(bool enable);
 public:
     C_PWM(int chip, int channel);
     ~C_PWM();
+
+    C_PWM(const C_PWM&) = delete;
+    C_PWM& operator=(const C_PWM&) = delete;
+
     bool init();
     bool setPeriodns(int s);
     bool setDutyCycle(uint8_t duty);
     bool setEnable(bool enable);
+
+    // Period, duty and enable in one call, written in an order the kernel accepts
+    // (duty never above period) and with enable last so no glitch reaches the output.
+    bool update(int periodNs, uint8_t duty, bool enable);
+
+    long periodNs() const { return m_periodNs; }
+    const C_IoStats& ioStats() const { return m_io; }
 };
 #endif 
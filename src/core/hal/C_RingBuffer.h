@@ -0,0 +1,58 @@
+#ifndef C_RINGBUFFER_H
+#define C_RINGBUFFER_H
+
+/*
+ * Fixed-size byte ring for UART receive data.
+ * Filled in place from read() (writeSpan/commit) and consumed by frame decoders.
+ * Not thread-safe: the owning C_UART serializes access.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define RING_CAPACITY 1024   // Power of two.
+
+class C_RingBuffer {
+    uint8_t m_buf[RING_CAPACITY];
+    size_t m_head;    // Index of the oldest byte.
+    size_t m_count;
+
+    static constexpr size_t MASK = RING_CAPACITY - 1;
+    static_assert((RING_CAPACITY & MASK) == 0, "RING_CAPACITY must be a power of two");
+
+public:
+    C_RingBuffer() : m_buf{}, m_head(0), m_count(0) {}
+
+    size_t size() const { return m_count; }
+    size_t space() const { return RING_CAPACITY - m_count; }
+    bool empty() const { return m_count == 0; }
+    void clear() { m_head = 0; m_count = 0; }
+
+    // i-th unread byte (i < size()).
+    uint8_t operator[](size_t i) const { return m_buf[(m_head + i) & MASK]; }
+
+    void consume(size_t n) {
+        if (n > m_count) n = m_count;
+        m_head = (m_head + n) & MASK;
+        m_count -= n;
+    }
+
+    // First n bytes into dst (n <= size()), without consuming them.
+    void copyOut(uint8_t* dst, size_t n) const {
+        size_t first = RING_CAPACITY - m_head;
+        if (first > n) first = n;
+        memcpy(dst, m_buf + m_head, first);
+        memcpy(dst + first, m_buf, n - first);
+    }
+
+    // Contiguous free region for a direct read(); commit what was written.
+    uint8_t* writeSpan(size_t& len) {
+        size_t tail = (m_head + m_count) & MASK;
+        len = (tail >= m_head && m_count < RING_CAPACITY) ? RING_CAPACITY - tail : space();
+        return m_buf + tail;
+    }
+    void commit(size_t n) { m_count += n; }
+};
+
+#endif
@@ -3,20 +3,41 @@
  */
 
 #include "C_UART.h"
-#include <iostream>
+#include "C_UARTLoop.h"
+#include "C_Logger.h"
+#include "C_HalPaths.h"
 #include <fcntl.h>      
 #include <termios.h>    
 #include <unistd.h>     
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#include <poll.h>
 #include <cstring>      
 #include <cerrno> 
+#include <ctime>
+#include <chrono>
 
 using namespace std;
 
-C_UART::C_UART(int portnumber)
-    : m_fd(-1)
+static int64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+C_UART::C_UART(int portnumber, C_UARTLoop* loop)
+    : m_fd(-1),
+      m_portNumber(portnumber),
+      m_loop(loop),
+      m_frameSize(0),
+      m_stats{},
+      m_io("uart"),
+      m_decoder(nullptr),
+      m_framesLost(0)
 {
     // Map number to /dev/ttyAMA{n}.
-    m_portPath = "/dev/ttyAMA" + to_string(portnumber);
+    m_portPath = C_HalPaths::path("/dev/ttyAMA" + to_string(portnumber));
+    m_io.setName(m_portPath);
 }
 
 C_UART::~C_UART() {
@@ -24,12 +45,16 @@ C_UART::~C_UART() {
 }
 
 bool C_UART::openPort() {
-    // Open the port in non-blocking mode.
+    // Open the port in non-blocking mode (a retry reopens it).
+    closePort();
     m_fd = open(m_portPath.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    m_io.syscall();
     if (m_fd == -1) {
-        perror("C_UART: Erro ao abrir porta");
+        m_io.error();
+        LOG_ERROR("C_UART: Erro ao abrir porta: %s", strerror(errno));
         return false;
     }
+    if (m_loop) m_loop->add(*this);
     
     return true;
 }
@@ -38,8 +63,13 @@ bool C_UART::openPort() {
 
 void C_UART::closePort() {
     if (m_fd != -1) {
+        if (m_loop) m_loop->remove(*this);
+        logStats();
+        std::lock_guard<std::mutex> lock(m_mutex);
         close(m_fd);
+        m_io.syscall();
         m_fd = -1;
+        m_rx.clear();
     }
 }
 
@@ -51,7 +81,7 @@ bool C_UART::configPort(int baud, int bits, char parity) {
 
     // Load current configuration.
     if (tcgetattr(m_fd, &options) != 0) {
-        perror("C_UART: Erro no tcgetattr");
+        LOG_ERROR("C_UART: Erro no tcgetattr: %s", strerror(errno));
         return false;
     }
 
@@ -67,7 +97,7 @@ bool C_UART::configPort(int baud, int bits, char parity) {
         case 460800: speed = B460800; break;
         case 921600: speed = B921600; break;
         default:
-            cerr << "C_UART: Baudrate não suportado!" << endl;
+            LOG_ERROR("C_UART: Baudrate não suportado!");
             return false;
     }
     cfsetispeed(&options, speed);
@@ -80,7 +110,7 @@ bool C_UART::configPort(int baud, int bits, char parity) {
     } else if (bits == 7) {
         options.c_cflag |= CS7;
     } else {
-        cerr << "C_UART: Bits deve ser 7 ou 8" << endl;
+        LOG_ERROR("C_UART: Bits deve ser 7 ou 8");
         return false;
     }
     // Configure parity.
@@ -93,37 +123,89 @@ bool C_UART::configPort(int baud, int bits, char parity) {
         options.c_cflag |= PARENB;  
         options.c_cflag |= PARODD;  
     } else {
-        cerr << "C_UART: Paridade inválida (use 'N', 'E', 'O')" << endl;
+        LOG_ERROR("C_UART: Paridade inválida (use 'N', 'E', 'O')");
         return false;
     }
 
     options.c_cflag &= ~CSTOPB;
     options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
     options.c_oflag &= ~OPOST;
-    options.c_iflag &= ~(IXON | IXOFF | IXANY);
+    // Binary protocols: no CR/LF translation, stripping or break handling on input.
+    options.c_iflag &= ~(IXON | IXOFF | IXANY | IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
     options.c_cflag &= ~CRTSCTS;
     options.c_cflag |= (CLOCAL | CREAD);
-    options.c_cc[VMIN] = 0;
-    options.c_cc[VTIME] = 1;
+    // Reads stay non-blocking; VMIN/VTIME decide when poll reports the port.
+    if (m_options.timing == UART_TIMING_FRAME && m_frameSize > 0) {
+        options.c_cc[VMIN] = m_frameSize;
+        options.c_cc[VTIME] = 0;
+    } else {
+        options.c_cc[VMIN] = 0;
+        options.c_cc[VTIME] = 1;
+    }
 
     // Apply configuration immediately.
     if (tcsetattr(m_fd, TCSANOW, &options) != 0) {
-        cerr<<"C_UART: Erro no tcsetattr\n";
+        LOG_ERROR("C_UART: Erro no tcsetattr");
         return false;
     }
 
     tcflush(m_fd, TCIOFLUSH);
+    m_io.syscall(3);   // tcgetattr, tcsetattr, tcflush.
 
+    if (m_options.lowLatency) applyLowLatency();
+    if (m_options.rxTrigger > 0) applyRxTrigger();
     return true;
 }
 
+void C_UART::applyLowLatency() {
+    struct serial_struct serial;
+    if (ioctl(m_fd, TIOCGSERIAL, &serial) != 0) {
+        LOG_WARN("C_UART: %s sem TIOCGSERIAL (low_latency ignorado): %s", m_portPath.c_str(), strerror(errno));
+        return;
+    }
+    serial.flags |= ASYNC_LOW_LATENCY;
+    if (ioctl(m_fd, TIOCSSERIAL, &serial) != 0) {
+        LOG_WARN("C_UART: %s: ASYNC_LOW_LATENCY recusado: %s", m_portPath.c_str(), strerror(errno));
+    }
+}
+
+void C_UART::applyRxTrigger() {
+    // Only some drivers (8250 family) expose the FIFO trigger level.
+    string path = C_HalPaths::path("/sys/class/tty/ttyAMA" + to_string(m_portNumber) + "/rx_trig_bytes");
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        LOG_WARN("C_UART: %s sem rx_trig_bytes (rx_trigger ignorado)", m_portPath.c_str());
+        return;
+    }
+    string val = to_string(m_options.rxTrigger);
+    if (write(fd, val.c_str(), val.size()) < 0) {
+        LOG_WARN("C_UART: %s: rx_trig_bytes=%d recusado: %s", m_portPath.c_str(), m_options.rxTrigger, strerror(errno));
+    }
+    close(fd);
+}
+
+void C_UART::logStats() const {
+    if (m_stats.wakeups == 0) return;
+    LOG_INFO("C_UART: %s: %u despertares, %u leituras, %llu bytes (%.1f B/despertar), %u tramas",
+             m_portPath.c_str(), m_stats.wakeups, m_stats.reads,
+             static_cast<unsigned long long>(m_stats.bytes),
+             static_cast<double>(m_stats.bytes) / m_stats.wakeups, m_stats.frames);
+}
+
 
 int C_UART::writeBuffer(const void* data, size_t len) {
     if (m_fd == -1) return -1;
 
     // Write bytes to the port.
+    C_IoOp op(m_io);
     int count = write(m_fd, data, len);
-    if (count < 0) cerr<<"C_UART: Erro ao escrever";
+    m_io.syscall();
+    if (count < 0) {
+        m_io.error();
+        LOG_ERROR("C_UART: Erro ao escrever");
+    } else {
+        m_io.bytes(static_cast<size_t>(count));
+    }
 
     return count;
 }
@@ -132,7 +214,9 @@ int C_UART::readBuffer(void* buffer, size_t len) {
     if (m_fd == -1) return -1;
 
     // Non-blocking read.
+    C_IoOp op(m_io);
     int count = read(m_fd, buffer, len);
+    m_io.syscall();
 
     if (count < 0) {
         // No data available.
@@ -140,9 +224,128 @@ int C_UART::readBuffer(void* buffer, size_t len) {
             return 0;
         }
         // Real I/O error.
-        perror("C_UART: Erro real no read");
+        m_io.error();
+        LOG_ERROR("C_UART: Erro real no read: %s", strerror(errno));
         return -1;
     }
 
+    m_io.bytes(static_cast<size_t>(count));
     return count;
 }
+
+void C_UART::setDecoder(C_FrameDecoder* decoder, FrameFn onFrame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoder = decoder;
+    m_onFrame = std::move(onFrame);
+    m_rx.clear();
+    m_frames.clear();
+}
+
+void C_UART::deliver(const S_UartFrame& frame) {
+    if (m_onFrame) {
+        m_onFrame(frame);
+        return;
+    }
+    if (m_frames.size() >= UART_FRAME_QUEUE) {
+        m_frames.pop_front();
+        ++m_framesLost;
+    }
+    m_frames.push_back(frame);
+}
+
+int C_UART::pump() {
+    int frames = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_fd == -1) return -1;
+        ++m_stats.wakeups;
+        C_IoOp op(m_io);
+
+        S_UartFrame frame;
+        for (;;) {
+            size_t span = 0;
+            uint8_t* dst = m_rx.writeSpan(span);
+            if (span == 0) {
+                // Ring full of bytes no decoder accepts: start over.
+                m_rx.clear();
+                dst = m_rx.writeSpan(span);
+            }
+            ssize_t n = read(m_fd, dst, span);
+            m_io.syscall();
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                m_io.error();
+                LOG_RATELIMITED(LOG_LVL_ERROR, 1000, "C_UART: Erro real no read (%s): %s", m_portPath.c_str(), strerror(errno));
+                return -1;
+            }
+            if (n == 0) break;
+            m_rx.commit(static_cast<size_t>(n));
+            ++m_stats.reads;
+            m_stats.bytes += static_cast<uint64_t>(n);
+            m_io.bytes(static_cast<size_t>(n));
+
+            if (!m_decoder) {
+                m_rx.clear();
+                continue;
+            }
+            while (m_decoder->decode(m_rx, frame)) {
+                frame.tsMs = monotonicMs();
+                deliver(frame);
+                ++frames;
+            }
+            if (static_cast<size_t>(n) < span) break;   // Drained.
+        }
+        m_stats.frames += static_cast<uint32_t>(frames);
+    }
+    if (frames > 0 && !m_onFrame) m_cv.notify_all();
+    return frames;
+}
+
+bool C_UART::waitFrame(S_UartFrame& frame, int timeoutMs) {
+    if (!m_decoder || m_onFrame) return false;
+
+    if (m_loop && m_loop->running()) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                           [this] { return !m_frames.empty(); })) {
+            return false;
+        }
+        frame = m_frames.front();
+        m_frames.pop_front();
+        return true;
+    }
+
+    // No receive thread: poll and decode on the caller.
+    const int64_t deadline = monotonicMs() + timeoutMs;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_frames.empty()) {
+                frame = m_frames.front();
+                m_frames.pop_front();
+                return true;
+            }
+        }
+        int64_t left = deadline - monotonicMs();
+        if (left < 0 || m_fd == -1) return false;
+
+        struct pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        int ret = ::poll(&pfd, 1, static_cast<int>(left));
+        m_io.syscall();
+        if (ret < 0 && errno != EINTR) return false;
+        if (ret > 0 && pump() < 0) return false;
+    }
+}
+
+void C_UART::discardInput() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rx.clear();
+    m_frames.clear();
+    if (m_fd != -1) {
+        tcflush(m_fd, TCIFLUSH);
+        m_io.syscall();
+    }
+}
@@ -3,28 +3,111 @@
 
 /*
  * UART abstraction (ttyAMA*) with baud/bits/parity config.
+ * Receive path: bytes are read in bulk into a per-port ring and cut into frames by
+ * the protocol's C_FrameDecoder. With a running C_UARTLoop the port is drained on
+ * the loop thread and waitFrame() just blocks on the frame queue; without one,
+ * waitFrame() polls and decodes inline.
+ * Read timing (S_UartOptions): "stream" wakes the reader on every byte (VMIN 0,
+ * VTIME 1); "frame" sets VMIN to the device's fixed frame size and VTIME 0 so
+ * poll/epoll only report the port once a whole frame is buffered.
  */
 
 #include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 #include <cstddef> 
 #include <cstdint> 
+
+#include "C_RingBuffer.h"
+#include "C_FrameDecoder.h"
+#include "C_IoStats.h"
+
 using namespace std;
 
+class C_UARTLoop;
+
+#define UART_FRAME_QUEUE 16   // Oldest frame dropped when a reader falls behind.
+
+enum UartTiming_enum : uint8_t {
+    UART_TIMING_STREAM = 0,
+    UART_TIMING_FRAME
+};
+
+struct S_UartOptions {
+    UartTiming_enum timing = UART_TIMING_FRAME;
+    bool lowLatency = false;   // ASYNC_LOW_LATENCY (TIOCSSERIAL), where the driver honours it.
+    int rxTrigger = -1;        // Hardware RX FIFO trigger level (rx_trig_bytes); -1 = driver default.
+};
+
+// Receive-side counters, logged when the port closes.
+struct S_UartStats {
+    uint32_t wakeups;    // pump() calls.
+    uint32_t reads;      // read() calls that returned data.
+    uint64_t bytes;
+    uint32_t frames;
+};
+
 class C_UART {
+public:
+    typedef std::function<void(const S_UartFrame&)> FrameFn;
 
+private:
     int m_fd;
+    int m_portNumber;
     string m_portPath;
+    C_UARTLoop* m_loop;
+    S_UartOptions m_options;
+    uint8_t m_frameSize;
+    S_UartStats m_stats;
+    C_IoStats m_io;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    C_RingBuffer m_rx;
+    C_FrameDecoder* m_decoder;
+    FrameFn m_onFrame;
+    std::deque<S_UartFrame> m_frames;
+    uint32_t m_framesLost;
+
+    void deliver(const S_UartFrame& frame);
+    void applyLowLatency();
+    void applyRxTrigger();
+    void logStats() const;
+
 public:
-    C_UART(int portnumber);
+    C_UART(int portnumber, C_UARTLoop* loop = nullptr);
     ~C_UART();
+
+    C_UART(const C_UART&) = delete;
+    C_UART& operator=(const C_UART&) = delete;
+
     bool openPort();
     void closePort();
+    // Applied by the next configPort().
+    void setOptions(const S_UartOptions& options) { m_options = options; }
+    // Fixed frame length of the device protocol (0 = variable); used by "frame" timing.
+    void setFrameSize(uint8_t frameSize) { m_frameSize = frameSize; }
     bool configPort(int baud, int bits, char parity);
     int writeBuffer(const void* data, size_t len);
     int readBuffer(void* buffer, size_t len);
     int getFd() const { return m_fd; }
+    const string& path() const { return m_portPath; }
+
+    // Frame mode. Without onFrame, frames are queued for waitFrame(); a callback
+    // runs on the receiving thread with the port locked and must not call back into it.
+    void setDecoder(C_FrameDecoder* decoder, FrameFn onFrame = nullptr);
+    bool waitFrame(S_UartFrame& frame, int timeoutMs);
+    // Drop queued frames, partial bytes and the kernel RX buffer.
+    void discardInput();
+    uint32_t framesLost() const { return m_framesLost; }
+    S_UartStats stats() const { return m_stats; }
+    const C_IoStats& ioStats() const { return m_io; }
 
+    // Read everything available and decode it; frames decoded, or -1 on I/O error.
+    int pump();
 };
 
 #endif 
@@ -0,0 +1,66 @@
+/*
+ * UART receive loop: epoll over the open ports, pump on readiness.
+ */
+
+#include "C_UARTLoop.h"
+#include "C_UART.h"
+#include "C_Logger.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#define UART_LOOP_EVENTS 8
+
+C_UARTLoop::C_UARTLoop()
+    : m_epfd(epoll_create1(EPOLL_CLOEXEC)),
+      m_running(false)
+{
+    if (m_epfd < 0) {
+        LOG_ERROR("[UARTLoop] epoll_create1: %s (leitura síncrona)", strerror(errno));
+    }
+}
+
+C_UARTLoop::~C_UARTLoop() {
+    if (m_epfd >= 0) close(m_epfd);
+}
+
+bool C_UARTLoop::add(C_UART& uart) {
+    if (m_epfd < 0 || uart.getFd() < 0) return false;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &uart;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, uart.getFd(), &ev) != 0 && errno != EEXIST) {
+        LOG_ERROR("[UARTLoop] epoll_ctl ADD: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void C_UARTLoop::remove(C_UART& uart) {
+    if (m_epfd < 0 || uart.getFd() < 0) return;
+    epoll_ctl(m_epfd, EPOLL_CTL_DEL, uart.getFd(), nullptr);
+}
+
+void C_UARTLoop::poll(int timeoutMs) {
+    if (m_epfd < 0) {
+        usleep(static_cast<useconds_t>(timeoutMs) * 1000);
+        return;
+    }
+
+    struct epoll_event events[UART_LOOP_EVENTS];
+    int n = epoll_wait(m_epfd, events, UART_LOOP_EVENTS, timeoutMs);
+    for (int i = 0; i < n; ++i) {
+        C_UART* uart = static_cast<C_UART*>(events[i].data.ptr);
+        // A port that keeps failing is dropped until it is reopened (device retry).
+        if (uart->pump() < 0 || (events[i].events & (EPOLLERR | EPOLLHUP))) {
+            LOG_ERROR("[UARTLoop] %s com erro: removida do ciclo de leitura", uart->path().c_str());
+            remove(*uart);
+        }
+    }
+}
+
+void C_UARTLoop::setRunning(bool running) {
+    m_running = running && m_epfd >= 0;
+}
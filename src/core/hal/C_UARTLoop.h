@@ -0,0 +1,36 @@
+#ifndef C_UARTLOOP_H
+#define C_UARTLOOP_H
+
+/*
+ * Receive event loop shared by all UART ports (epoll).
+ * Ports register while open; a ready port is drained into its ring and decoded
+ * on the loop thread (C_tUartRx), so device threads only wait for frames.
+ */
+
+#include <atomic>
+
+class C_UART;
+
+class C_UARTLoop {
+    int m_epfd;
+    std::atomic<bool> m_running;
+
+public:
+    C_UARTLoop();
+    ~C_UARTLoop();
+
+    C_UARTLoop(const C_UARTLoop&) = delete;
+    C_UARTLoop& operator=(const C_UARTLoop&) = delete;
+
+    bool add(C_UART& uart);
+    void remove(C_UART& uart);
+
+    // Wait up to timeoutMs and pump every ready port.
+    void poll(int timeoutMs);
+
+    // Ports wait on frames from this loop only while its thread is running.
+    void setRunning(bool running);
+    bool running() const { return m_running; }
+};
+
+#endif
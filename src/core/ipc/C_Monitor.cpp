@@ -3,14 +3,14 @@
  */
 
 #include "C_Monitor.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <time.h>
 #include <errno.h>
 using namespace std;
 
-C_Monitor::C_Monitor() {
+C_Monitor::C_Monitor() : m_generation(0), m_edgeNs(0) {
     if (pthread_mutex_init(&m_mutex, NULL) != 0){
-        cerr << "Mutex init failed" << endl;
+        LOG_ERROR("Mutex init failed");
     }
     
     pthread_condattr_t attr;
@@ -18,7 +18,7 @@ C_Monitor::C_Monitor() {
     pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
 
     if (pthread_cond_init(&m_cond, &attr) != 0) {
-        cerr << "Cond init failed" << endl;
+        LOG_ERROR("Cond init failed");
     }
 
     pthread_condattr_destroy(&attr);
@@ -38,9 +38,11 @@ void C_Monitor::wait() {
 }
 
 
-void C_Monitor::signal() {
+void C_Monitor::signal(uint64_t edgeNs) {
     // Wake all waiting threads.
     pthread_mutex_lock(&m_mutex);
+    ++m_generation;
+    m_edgeNs = edgeNs;
     pthread_cond_broadcast(&m_cond);
     pthread_mutex_unlock(&m_mutex);
 }
@@ -61,6 +63,44 @@ bool C_Monitor::timedWait(int seconds) {
     if (result == ETIMEDOUT) {
         return true;
     }
-    std::cerr << "[C_Monitor] timedWait error: " << result << std::endl;
+    LOG_ERROR("[C_Monitor] timedWait error: %d", result);
     return true;
 }
+
+bool C_Monitor::timedWait(int seconds, uint32_t& seen) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += seconds;
+
+    pthread_mutex_lock(&m_mutex);
+    int result = 0;
+    // The generation filters spurious wakeups and keeps signals nobody waited for.
+    while (m_generation == seen && result == 0) {
+        result = pthread_cond_timedwait(&m_cond, &m_mutex, &ts);
+    }
+    bool signaled = (m_generation != seen);
+    seen = m_generation;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (signaled) {
+        return false;
+    }
+    if (result != ETIMEDOUT) {
+        LOG_ERROR("[C_Monitor] timedWait error: %d", result);
+    }
+    return true;
+}
+
+uint32_t C_Monitor::generation() {
+    pthread_mutex_lock(&m_mutex);
+    uint32_t generation = m_generation;
+    pthread_mutex_unlock(&m_mutex);
+    return generation;
+}
+
+uint64_t C_Monitor::edgeNs() {
+    pthread_mutex_lock(&m_mutex);
+    uint64_t edgeNs = m_edgeNs;
+    pthread_mutex_unlock(&m_mutex);
+    return edgeNs;
+}
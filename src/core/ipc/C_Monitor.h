@@ -3,20 +3,32 @@
 
 /*
  * Simple monitor (mutex + cond) for thread signaling.
+ * Every signal() bumps a generation: a waiter that tracks it (timedWait with
+ * 'seen') also catches signals raised while it was busy elsewhere.
+ * signal() may carry the time the input fired (CLOCK_MONOTONIC ns).
  */
 
 #include <pthread.h>
+#include <cstdint>
 
 class C_Monitor {
     pthread_mutex_t m_mutex;
     pthread_cond_t m_cond;
+    uint32_t m_generation;
+    uint64_t m_edgeNs;
 
 public:
     C_Monitor();
     ~C_Monitor();
     void wait();
-    void signal();
+    void signal(uint64_t edgeNs = 0);
     bool timedWait(int seconds);
+    // Latched wait: returns false at once if signal() ran since 'seen', which is
+    // advanced to the current generation. Returns true on timeout.
+    bool timedWait(int seconds, uint32_t& seen);
+    uint32_t generation();
+    // Edge time of the latest signal (0: unknown).
+    uint64_t edgeNs();
 
 };
 
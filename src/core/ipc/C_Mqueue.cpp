@@ -69,6 +69,25 @@ bool C_Mqueue::send(const void* msg, size_t size, unsigned int prio) {
     return true;
 }
 
+bool C_Mqueue::trySend(const void* msg, size_t size, unsigned int prio) {
+    if (id == static_cast<mqd_t>(-1)) return false;
+
+    if (size > maxMsgSize) {
+        cerr << "[Erro C_Mqueue] Mensagem demasiado grande" << endl;
+        return false;
+    }
+
+    // Absolute timeout already in the past: mq_timedsend never blocks.
+    struct timespec tm = {0, 0};
+    if (mq_timedsend(id, reinterpret_cast<const char*>(msg), size, prio, &tm) == -1) {
+        if (errno != ETIMEDOUT && errno != EAGAIN) {
+            cerr << "[Erro C_Mqueue] Falha no trySend: " << strerror(errno) << endl;
+        }
+        return false;
+    }
+    return true;
+}
+
 
 
 ssize_t C_Mqueue::receive(void* buffer, size_t size) {
@@ -116,3 +135,15 @@ void C_Mqueue::unregister() {
 bool C_Mqueue::isOwner() const {
     return m_owner;
 }
+
+long C_Mqueue::pending() const {
+    if (id == static_cast<mqd_t>(-1)) return -1;
+
+    struct mq_attr attr{};
+    if (mq_getattr(id, &attr) == -1) return -1;
+    return attr.mq_curmsgs;
+}
+
+long C_Mqueue::capacity() const {
+    return maxMsgCount;
+}
@@ -0,0 +1,52 @@
+/*
+ * Occupancy tracker implementation.
+ */
+
+#include "C_Occupancy.h"
+
+C_Occupancy::C_Occupancy() : m_unknown(0), m_count(0) {
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+C_Occupancy::~C_Occupancy() {
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void C_Occupancy::publish() {
+    // Caller holds the mutex; readers only see the counter.
+    m_count.store(static_cast<uint32_t>(m_inside.size()) + m_unknown, std::memory_order_release);
+}
+
+void C_Occupancy::enter(uint32_t userId) {
+    pthread_mutex_lock(&m_mutex);
+    m_inside.insert(userId);
+    publish();
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void C_Occupancy::leave(uint32_t userId) {
+    pthread_mutex_lock(&m_mutex);
+    // Users seeded from the DB have no ID here: consume one of them instead.
+    if (m_inside.erase(userId) == 0 && m_unknown > 0) {
+        --m_unknown;
+    }
+    publish();
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void C_Occupancy::seed(uint32_t count) {
+    // Persisted count (IsInside) at startup; known IDs are already included.
+    pthread_mutex_lock(&m_mutex);
+    uint32_t known = static_cast<uint32_t>(m_inside.size());
+    m_unknown = (count > known) ? (count - known) : 0;
+    publish();
+    pthread_mutex_unlock(&m_mutex);
+}
+
+uint32_t C_Occupancy::count() const {
+    return m_count.load(std::memory_order_acquire);
+}
+
+bool C_Occupancy::isEmpty() const {
+    return count() == 0;
+}
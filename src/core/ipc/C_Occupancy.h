@@ -0,0 +1,32 @@
+#ifndef C_OCCUPANCY_H
+#define C_OCCUPANCY_H
+
+/*
+ * In-memory room occupancy shared by the access threads and the PIR thread.
+ * Entries/exits update it under a mutex; the PIR check reads a lock-free counter.
+ */
+
+#include <pthread.h>
+#include <atomic>
+#include <cstdint>
+#include <set>
+
+class C_Occupancy {
+    pthread_mutex_t m_mutex;
+    std::set<uint32_t> m_inside;
+    uint32_t m_unknown;
+    std::atomic<uint32_t> m_count;
+
+    void publish();
+
+public:
+    C_Occupancy();
+    ~C_Occupancy();
+    void enter(uint32_t userId);
+    void leave(uint32_t userId);
+    void seed(uint32_t count);
+    uint32_t count() const;
+    bool isEmpty() const;
+};
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * Durable outbox implementation (mmap segment file, ordered replay).
+ */
+
+#include "C_Outbox.h"
+#include "C_Mqueue.h"
+#include "C_Logger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr uint32_t OUTBOX_MAGIC = 0x4F425831;   // "OBX1"
+static constexpr uint32_t OUTBOX_VERSION = 2;
+
+
+C_Outbox::C_Outbox(C_Mqueue& mqToDatabase, const std::string& path, uint32_t capacity)
+    : m_mqToDatabase(mqToDatabase),
+      m_path(path),
+      m_capacity(capacity),
+      m_fd(-1),
+      m_map(MAP_FAILED),
+      m_mapSize(0),
+      m_header(nullptr),
+      m_slots(nullptr),
+      m_dropped(0),
+      m_dirty(false) {
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+C_Outbox::~C_Outbox() {
+    close();
+    pthread_mutex_destroy(&m_mutex);
+}
+
+bool C_Outbox::open() {
+    m_mapSize = sizeof(S_Header) + static_cast<size_t>(m_capacity) * sizeof(S_Slot);
+
+    m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (m_fd < 0) {
+        LOG_WARN("[Outbox] Sem ficheiro %s (%s): envio sem persistência", m_path.c_str(), strerror(errno));
+        return false;
+    }
+
+    // A size mismatch means a different layout: start a new segment.
+    struct stat st{};
+    bool fresh = (fstat(m_fd, &st) != 0) || (static_cast<size_t>(st.st_size) != m_mapSize);
+    if (fresh && ftruncate(m_fd, static_cast<off_t>(m_mapSize)) != 0) {
+        LOG_WARN("[Outbox] ftruncate falhou: %s", strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_map = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (m_map == MAP_FAILED) {
+        LOG_WARN("[Outbox] mmap falhou: %s", strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_header = static_cast<S_Header*>(m_map);
+    m_slots = reinterpret_cast<S_Slot*>(static_cast<char*>(m_map) + sizeof(S_Header));
+
+    bool valid = !fresh &&
+                 m_header->magic == OUTBOX_MAGIC &&
+                 m_header->version == OUTBOX_VERSION &&
+                 m_header->slotSize == sizeof(S_Slot) &&
+                 m_header->capacity == m_capacity &&
+                 (m_header->tail - m_header->head) <= m_capacity;
+    if (!valid) {
+        resetHeader();
+    } else if (!m_header->clean) {
+        recoverUnclean();
+    }
+    m_header->clean = 0;
+    msync(m_map, sizeof(S_Header), MS_SYNC);
+
+    uint32_t pending = backlog();
+    if (pending > 0) {
+        LOG_INFO("[Outbox] %u mensagens pendentes de execução anterior", pending);
+    }
+    return true;
+}
+
+void C_Outbox::close() {
+    pthread_mutex_lock(&m_mutex);
+    if (m_map != MAP_FAILED) {
+        msync(m_map, m_mapSize, MS_SYNC);
+        // nextSeq is now on disk: the next open() may keep this epoch.
+        m_header->clean = 1;
+        msync(m_map, sizeof(S_Header), MS_SYNC);
+        munmap(m_map, m_mapSize);
+        m_map = MAP_FAILED;
+        m_header = nullptr;
+        m_slots = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void C_Outbox::resetHeader() {
+    // New epoch: sequence numbers restart, the DB resets its dedup state.
+    memset(m_header, 0, sizeof(S_Header));
+    m_header->magic = OUTBOX_MAGIC;
+    m_header->version = OUTBOX_VERSION;
+    m_header->slotSize = sizeof(S_Slot);
+    m_header->capacity = m_capacity;
+    m_header->epoch = static_cast<uint32_t>(time(nullptr));
+    m_header->nextSeq = 1;
+}
+
+void C_Outbox::recoverUnclean() {
+    // Pages reach the disk in any order: keep the stored slots up to the first
+    // one that was not written in this lap (zeroed or out of sequence).
+    uint32_t prevEpoch = 0;
+    uint32_t prevSeq = 0;
+    uint32_t kept = m_header->head;
+    for (; kept != m_header->tail; ++kept) {
+        const S_Slot& slot = m_slots[kept % m_capacity];
+        uint32_t epoch = slot.msg.outboxEpoch;
+        bool ordered = epoch > prevEpoch || (epoch == prevEpoch && slot.seq > prevSeq);
+        if (slot.seq == 0 || slot.seq != slot.msg.outboxSeq ||
+            epoch > m_header->epoch || !ordered) {
+            break;
+        }
+        prevEpoch = epoch;
+        prevSeq = slot.seq;
+    }
+    if (kept != m_header->tail) {
+        LOG_WARN("[Outbox] %u mensagens incompletas descartadas após falha de energia",
+                 m_header->tail - kept);
+        m_header->tail = kept;
+    }
+
+    // nextSeq may be behind what the DB already applied: a new epoch keeps the
+    // DB from dropping fresh messages as duplicates. Stored slots keep theirs.
+    m_header->epoch++;
+    m_header->nextSeq = 1;
+    LOG_WARN("[Outbox] Segmento não fechado corretamente: nova época %u", m_header->epoch);
+}
+
+bool C_Outbox::directSendAllowed() const {
+    // Keep room in /mq_to_db for access requests (they wait for a reply).
+    long pending = m_mqToDatabase.pending();
+    return pending >= 0 && pending < m_mqToDatabase.capacity() - OUTBOX_QUEUE_RESERVE;
+}
+
+bool C_Outbox::post(DatabaseMsg& msg) {
+    pthread_mutex_lock(&m_mutex);
+
+    if (!m_header) {
+        msg.outboxEpoch = 0;
+        msg.outboxSeq = 0;
+        bool sent = directSendAllowed() && m_mqToDatabase.trySend(&msg, sizeof(DatabaseMsg));
+        pthread_mutex_unlock(&m_mutex);
+        if (!sent) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return sent;
+    }
+
+    msg.outboxEpoch = m_header->epoch;
+    msg.outboxSeq = m_header->nextSeq++;
+
+    uint32_t head = m_header->head;
+    uint32_t tail = m_header->tail;
+
+    // Direct path only with no backlog, otherwise ordering would break.
+    if (head == tail && directSendAllowed() &&
+        m_mqToDatabase.trySend(&msg, sizeof(DatabaseMsg))) {
+        pthread_mutex_unlock(&m_mutex);
+        return true;
+    }
+
+    if (tail - head >= m_capacity) {
+        pthread_mutex_unlock(&m_mutex);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        LOG_RATELIMITED(LOG_LVL_WARN, 10000, "[Outbox] Cheio (%u): mensagem descartada", m_capacity);
+        return false;
+    }
+
+    S_Slot& slot = m_slots[tail % m_capacity];
+    slot.seq = msg.outboxSeq;
+    slot.msg = msg;
+    // Publish the slot only after it is fully written; sync() writes it out.
+    __atomic_store_n(&m_header->tail, tail + 1, __ATOMIC_RELEASE);
+    m_dirty.store(true, std::memory_order_release);
+
+    pthread_mutex_unlock(&m_mutex);
+    return true;
+}
+
+uint32_t C_Outbox::flush(uint32_t maxBatch) {
+    uint32_t delivered = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_header) {
+        while (delivered < maxBatch && m_header->head != m_header->tail) {
+            if (!directSendAllowed()) break;
+
+            const S_Slot& slot = m_slots[m_header->head % m_capacity];
+            if (!m_mqToDatabase.trySend(&slot.msg, sizeof(DatabaseMsg))) break;
+
+            // A crash before this store replays the slot; the DB drops it by seq.
+            __atomic_store_n(&m_header->head, m_header->head + 1, __ATOMIC_RELEASE);
+            ++delivered;
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    if (delivered > 0) {
+        m_dirty.store(true, std::memory_order_release);
+    }
+    return delivered;
+}
+
+void C_Outbox::sync() {
+    // Runs without m_mutex so post() is never stuck behind flash I/O;
+    // close() only runs after the flush thread has been joined.
+    if (!m_header || !m_dirty.exchange(false, std::memory_order_acq_rel)) return;
+    if (msync(m_map, m_mapSize, MS_SYNC) != 0) {
+        m_dirty.store(true, std::memory_order_release);
+        LOG_RATELIMITED(LOG_LVL_WARN, 10000, "[Outbox] msync falhou: %s", strerror(errno));
+    }
+}
+
+uint32_t C_Outbox::backlog() const {
+    if (!m_header) return 0;
+    return __atomic_load_n(&m_header->tail, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&m_header->head, __ATOMIC_ACQUIRE);
+}
+
+uint32_t C_Outbox::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
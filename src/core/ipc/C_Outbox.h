@@ -0,0 +1,88 @@
+#ifndef C_OUTBOX_H
+#define C_OUTBOX_H
+
+/*
+ * Durable outbox for fire-and-forget messages to the DB daemon (logs, asset updates).
+ * Messages go straight to /mq_to_db while it has room; otherwise they are appended
+ * to a memory-mapped segment file and replayed in order by C_tOutboxFlush.
+ * post() never touches the disk: C_tOutboxFlush calls sync() to write appended
+ * slots out, so a power loss can cost at most the last sync period.
+ * Every message carries (epoch, seq) so dDatabase can drop replayed duplicates.
+ * A segment not closed cleanly reopens with a new epoch, since its nextSeq may
+ * be older than what the DB has already applied.
+ */
+
+#include <pthread.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "SharedTypes.h"
+
+class C_Mqueue;
+
+#define OUTBOX_DEFAULT_SLOTS   1024
+#define OUTBOX_QUEUE_RESERVE   2
+
+class C_Outbox {
+    struct S_Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slotSize;
+        uint32_t capacity;
+        uint32_t epoch;
+        uint32_t nextSeq;
+        uint32_t head;          // Next slot to replay (monotonic).
+        uint32_t tail;          // Next slot to write (monotonic).
+        uint32_t clean;         // Set by close(), cleared by open().
+        uint32_t reserved;
+    };
+
+    struct S_Slot {
+        uint32_t seq;
+        uint32_t reserved;
+        DatabaseMsg msg;
+    };
+
+    C_Mqueue& m_mqToDatabase;
+    std::string m_path;
+    uint32_t m_capacity;
+
+    pthread_mutex_t m_mutex;
+    int m_fd;
+    void* m_map;
+    size_t m_mapSize;
+    S_Header* m_header;
+    S_Slot* m_slots;
+
+    std::atomic<uint32_t> m_dropped;
+    std::atomic<bool> m_dirty;
+
+    bool directSendAllowed() const;
+    void resetHeader();
+    void recoverUnclean();
+
+public:
+    C_Outbox(C_Mqueue& mqToDatabase, const std::string& path,
+             uint32_t capacity = OUTBOX_DEFAULT_SLOTS);
+    ~C_Outbox();
+
+    bool open();
+    void close();
+
+    // Never blocks on the queue; returns false only if the message was dropped.
+    // Without a segment file messages are sent unsequenced and dropped when full.
+    bool post(DatabaseMsg& msg);
+
+    // Replay up to maxBatch stored messages; returns how many were delivered.
+    uint32_t flush(uint32_t maxBatch);
+
+    // Write appended slots to disk (blocking); call from the flush thread only.
+    void sync();
+
+    uint32_t backlog() const;
+    uint32_t dropped() const;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Pre-wake policy implementation.
+ */
+
+#include "C_PowerPolicy.h"
+#include "C_Logger.h"
+#include <ctime>
+
+static const char* const MODULE_NAMES[PREWAKE_COUNT] = { "Fingerprint", "UHF" };
+
+static int64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+C_PowerPolicy::C_PowerPolicy(uint32_t budgetMw)
+    : m_budgetMw(budgetMw),
+      m_usedMw(0) {
+    pthread_mutex_init(&m_mutex, NULL);
+    m_holdMs[PREWAKE_FINGERPRINT] = PREWAKE_FINGER_HOLD_MS_DEFAULT;
+    m_holdMs[PREWAKE_UHF] = PREWAKE_UHF_HOLD_MS_DEFAULT;
+    for (S_Grant& g : m_grants) {
+        g = {false, false, 0};
+    }
+}
+
+C_PowerPolicy::~C_PowerPolicy() {
+    pthread_mutex_destroy(&m_mutex);
+}
+
+uint32_t C_PowerPolicy::cost(PreWake_enum module) {
+    return (module == PREWAKE_UHF) ? PREWAKE_COST_UHF_MW : PREWAKE_COST_FINGERPRINT_MW;
+}
+
+void C_PowerPolicy::drop(PreWake_enum module) {
+    // Caller holds the mutex.
+    S_Grant& g = m_grants[module];
+    if (!g.granted) return;
+    g.granted = false;
+    g.applied = false;
+    m_usedMw -= cost(module);
+}
+
+bool C_PowerPolicy::request(PreWake_enum module) {
+    if (module >= PREWAKE_COUNT) return false;
+
+    pthread_mutex_lock(&m_mutex);
+    S_Grant& g = m_grants[module];
+    uint32_t holdMs = m_holdMs[module];
+    bool ok = true;
+
+    if (g.granted) {
+        g.expiresMs = monotonicMs() + holdMs;
+    } else if (m_usedMw + cost(module) > m_budgetMw) {
+        ok = false;
+    } else {
+        g.granted = true;
+        g.applied = false;
+        g.expiresMs = monotonicMs() + holdMs;
+        m_usedMw += cost(module);
+    }
+    uint32_t used = m_usedMw;
+    uint32_t budget = m_budgetMw;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (ok) {
+        LOG_DEBUG("[PowerPolicy] Pre-wake %s (%u/%u mW)", MODULE_NAMES[module], used, budget);
+    } else {
+        LOG_RATELIMITED(LOG_LVL_INFO, 10000, "[PowerPolicy] Pre-wake %s recusado: orçamento %u mW",
+                        MODULE_NAMES[module], budget);
+    }
+    return ok;
+}
+
+PreWakeAction_enum C_PowerPolicy::poll(PreWake_enum module) {
+    if (module >= PREWAKE_COUNT) return PREWAKE_NONE;
+
+    PreWakeAction_enum action = PREWAKE_NONE;
+    pthread_mutex_lock(&m_mutex);
+    S_Grant& g = m_grants[module];
+
+    if (g.granted) {
+        if (monotonicMs() >= g.expiresMs) {
+            // Not used in time: undo the wake (if it was applied).
+            action = g.applied ? PREWAKE_SLEEP : PREWAKE_NONE;
+            drop(module);
+        } else if (!g.applied) {
+            g.applied = true;
+            action = PREWAKE_WAKE;
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return action;
+}
+
+void C_PowerPolicy::release(PreWake_enum module) {
+    if (module >= PREWAKE_COUNT) return;
+    pthread_mutex_lock(&m_mutex);
+    drop(module);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool C_PowerPolicy::active(PreWake_enum module) {
+    if (module >= PREWAKE_COUNT) return false;
+    pthread_mutex_lock(&m_mutex);
+    bool on = m_grants[module].granted && m_grants[module].applied;
+    pthread_mutex_unlock(&m_mutex);
+    return on;
+}
+
+void C_PowerPolicy::setBudget(uint32_t budgetMw) {
+    // Active grants are kept; the new budget applies to later requests.
+    pthread_mutex_lock(&m_mutex);
+    m_budgetMw = budgetMw;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void C_PowerPolicy::setHold(PreWake_enum module, uint32_t holdMs) {
+    // Takes effect on the next request (an active grant keeps its expiry).
+    if (module >= PREWAKE_COUNT) return;
+    pthread_mutex_lock(&m_mutex);
+    m_holdMs[module] = holdMs;
+    pthread_mutex_unlock(&m_mutex);
+}
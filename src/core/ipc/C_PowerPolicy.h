@@ -0,0 +1,73 @@
+#ifndef C_POWERPOLICY_H
+#define C_POWERPOLICY_H
+
+/*
+ * Pre-wake policy for slow-to-start modules (fingerprint, UHF reader).
+ * Flow threads request a pre-wake when a use is likely soon; the thread owning the
+ * device applies it on its next tick. Grants are bounded by a power budget and
+ * expire after a hold time if the module is not used.
+ */
+
+#include <pthread.h>
+#include <cstdint>
+
+enum PreWake_enum : uint8_t {
+    PREWAKE_FINGERPRINT = 0,
+    PREWAKE_UHF,
+    PREWAKE_COUNT
+};
+
+enum PreWakeAction_enum : uint8_t {
+    PREWAKE_NONE = 0,
+    PREWAKE_WAKE,
+    PREWAKE_SLEEP
+};
+
+// Approximate active draw above sleep, per module.
+#define PREWAKE_COST_FINGERPRINT_MW   150
+#define PREWAKE_COST_UHF_MW           900
+
+// Default grant lifetimes: a vault-level user reaches the vault reader within a
+// minute; the UHF reader stays powered while the vault is open so the closing
+// scan starts warm.
+#define PREWAKE_FINGER_HOLD_MS_DEFAULT   60000
+#define PREWAKE_UHF_HOLD_MS_DEFAULT      120000
+
+class C_PowerPolicy {
+    struct S_Grant {
+        bool granted;
+        bool applied;
+        int64_t expiresMs;
+    };
+
+    pthread_mutex_t m_mutex;
+    uint32_t m_budgetMw;
+    uint32_t m_usedMw;
+    uint32_t m_holdMs[PREWAKE_COUNT];
+    S_Grant m_grants[PREWAKE_COUNT];
+
+    static uint32_t cost(PreWake_enum module);
+    void drop(PreWake_enum module);
+
+public:
+    explicit C_PowerPolicy(uint32_t budgetMw);
+    ~C_PowerPolicy();
+
+    // Anticipating thread: ask for the module to be ready for its hold time;
+    // extends an active grant.
+    bool request(PreWake_enum module);
+
+    // Owning thread, once per tick: what to do with the device now.
+    PreWakeAction_enum poll(PreWake_enum module);
+
+    // Owning thread: module was used (or put to sleep) -> grant ends.
+    void release(PreWake_enum module);
+
+    // True while the owner has applied a grant (device kept awake).
+    bool active(PreWake_enum module);
+
+    void setBudget(uint32_t budgetMw);
+    void setHold(PreWake_enum module, uint32_t holdMs);
+};
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Pending-bit inbox (mutex + monotonic cond).
+ */
+
+#include "C_UnitEvents.h"
+#include <cstring>
+#include <ctime>
+
+C_UnitEvents::C_UnitEvents() : m_pending(0) {
+    memset(m_edgeNs, 0, sizeof(m_edgeNs));
+    pthread_mutex_init(&m_mutex, NULL);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+C_UnitEvents::~C_UnitEvents() {
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void C_UnitEvents::post(unsigned unit, unsigned kind, uint64_t edgeNs) {
+    if (unit >= UNIT_EVENTS_MAX_UNITS || kind >= UNIT_EVENTS_MAX_KINDS) return;
+    unsigned bit = kind * UNIT_EVENTS_MAX_UNITS + unit;
+    pthread_mutex_lock(&m_mutex);
+    // Coalesced posts keep the first edge: latency is measured from it.
+    if (!(m_pending & (1u << bit))) m_edgeNs[bit] = edgeNs;
+    m_pending |= 1u << bit;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void C_UnitEvents::wake() {
+    pthread_mutex_lock(&m_mutex);
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+uint32_t C_UnitEvents::take(int seconds, uint64_t* edgesNs) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += seconds;
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_pending == 0) {
+        pthread_cond_timedwait(&m_cond, &m_mutex, &ts);
+    }
+    uint32_t events = m_pending;
+    m_pending = 0;
+    if (edgesNs) memcpy(edgesNs, m_edgeNs, sizeof(m_edgeNs));
+    pthread_mutex_unlock(&m_mutex);
+    return events;
+}
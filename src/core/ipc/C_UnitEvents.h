@@ -0,0 +1,46 @@
+#ifndef C_UNITEVENTS_H
+#define C_UNITEVENTS_H
+
+/*
+ * Per-thread event inbox for flows shared by several rooms.
+ * post() sets a (kind, unit) bit and wakes the owner; events posted while the
+ * owner is busy stay pending (unlike C_Monitor), repeated posts coalesce.
+ * Each pending bit keeps the time of its first edge (CLOCK_MONOTONIC ns).
+ */
+
+#include <pthread.h>
+#include <cstdint>
+
+#define UNIT_EVENTS_MAX_UNITS  8
+#define UNIT_EVENTS_MAX_KINDS  4
+#define UNIT_EVENTS_BITS       (UNIT_EVENTS_MAX_UNITS * UNIT_EVENTS_MAX_KINDS)
+
+class C_UnitEvents {
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_cond;
+    uint32_t m_pending;
+    uint64_t m_edgeNs[UNIT_EVENTS_BITS];
+
+public:
+    C_UnitEvents();
+    ~C_UnitEvents();
+
+    // edgeNs: when the input fired (0: unknown).
+    void post(unsigned unit, unsigned kind = 0, uint64_t edgeNs = 0);
+
+    // Wait up to 'seconds' and take all pending events (0 on timeout).
+    // edgesNs (UNIT_EVENTS_BITS entries) receives the edge time of each taken event.
+    uint32_t take(int seconds, uint64_t* edgesNs = nullptr);
+
+    // Wake the owner without an event (shutdown).
+    void wake();
+
+    static bool has(uint32_t events, unsigned unit, unsigned kind = 0) {
+        return (events >> (kind * UNIT_EVENTS_MAX_UNITS + unit)) & 1u;
+    }
+    static uint64_t edgeOf(const uint64_t* edgesNs, unsigned unit, unsigned kind = 0) {
+        return edgesNs[kind * UNIT_EVENTS_MAX_UNITS + unit];
+    }
+};
+
+#endif
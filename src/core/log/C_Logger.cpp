@@ -0,0 +1,200 @@
+/*
+ * Asynchronous logger implementation (per-thread SPSC rings + writer thread).
+ */
+
+#include "C_Logger.h"
+#include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+pthread_mutex_t C_Logger::s_registryMutex = PTHREAD_MUTEX_INITIALIZER;
+C_Logger::S_Ring* C_Logger::s_rings = nullptr;
+pthread_t C_Logger::s_writer;
+std::atomic<bool> C_Logger::s_running{false};
+std::atomic<uint32_t> C_Logger::s_dropped{0};
+int C_Logger::s_fd = STDOUT_FILENO;
+
+static constexpr char LEVEL_CHARS[] = {'D', 'I', 'W', 'E'};
+static constexpr int WRITER_IDLE_MS = 20;
+
+namespace {
+// Marks the thread's ring as orphaned on thread exit so the writer can free it.
+struct S_RingHandle {
+    C_Logger::S_Ring* ring = nullptr;
+    ~S_RingHandle() {
+        if (ring) ring->orphaned.store(true, std::memory_order_release);
+    }
+};
+thread_local S_RingHandle t_ring;
+
+size_t formatLine(char* out, size_t size, const struct timespec& ts, uint8_t level,
+                  const char* text, size_t len) {
+    struct tm tmv;
+    time_t sec = ts.tv_sec;
+    localtime_r(&sec, &tmv);
+    int n = std::snprintf(out, size, "%02d:%02d:%02d.%03ld %c %.*s\n",
+                          tmv.tm_hour, tmv.tm_min, tmv.tm_sec, ts.tv_nsec / 1000000L,
+                          LEVEL_CHARS[level & 3], static_cast<int>(len), text);
+    if (n < 0) return 0;
+    return (static_cast<size_t>(n) < size) ? static_cast<size_t>(n) : size - 1;
+}
+}
+
+void C_Logger::start(int fd) {
+    // Call after daemonize(): the writer thread does not survive fork().
+    if (s_running.load()) return;
+    s_fd = fd;
+    s_running.store(true);
+
+    // The writer starts before the core blocks its IRQ signals: keep every signal
+    // off it so a driver/termination signal never lands (or kills) here.
+    sigset_t all, prev;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &prev);
+    if (pthread_create(&s_writer, nullptr, writerMain, nullptr) != 0) {
+        s_running.store(false);
+    }
+    pthread_sigmask(SIG_SETMASK, &prev, nullptr);
+}
+
+void C_Logger::stop() {
+    if (!s_running.exchange(false)) return;
+    pthread_join(s_writer, nullptr);
+    // Lines logged after the writer exited.
+    while (drain()) {}
+}
+
+uint32_t C_Logger::dropped() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+int64_t C_Logger::monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+C_Logger::S_Ring* C_Logger::threadRing() {
+    if (t_ring.ring == nullptr) {
+        // First log from this thread: register a ring (only locked path for producers).
+        S_Ring* ring = new S_Ring();
+        pthread_mutex_lock(&s_registryMutex);
+        ring->next = s_rings;
+        s_rings = ring;
+        pthread_mutex_unlock(&s_registryMutex);
+        t_ring.ring = ring;
+    }
+    return t_ring.ring;
+}
+
+void C_Logger::log(uint8_t level, const char* fmt, ...) {
+    va_list args;
+
+    if (!s_running.load(std::memory_order_acquire)) {
+        // No writer (before start/after stop): write synchronously.
+        S_Entry e;
+        clock_gettime(CLOCK_REALTIME, &e.ts);
+        e.level = level;
+        va_start(args, fmt);
+        int n = std::vsnprintf(e.text, sizeof(e.text), fmt, args);
+        va_end(args);
+        e.len = static_cast<uint16_t>((n < 0) ? 0 : (n >= LOG_LINE_MAX ? LOG_LINE_MAX - 1 : n));
+        writeEntry(e);
+        return;
+    }
+
+    S_Ring* ring = threadRing();
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail >= LOG_RING_SLOTS) {
+        // Ring full: drop rather than block the caller.
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    S_Entry& e = ring->slots[head % LOG_RING_SLOTS];
+    clock_gettime(CLOCK_REALTIME, &e.ts);
+    e.level = level;
+    va_start(args, fmt);
+    int n = std::vsnprintf(e.text, sizeof(e.text), fmt, args);
+    va_end(args);
+    e.len = static_cast<uint16_t>((n < 0) ? 0 : (n >= LOG_LINE_MAX ? LOG_LINE_MAX - 1 : n));
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+bool C_Logger::rateLimit(std::atomic<int64_t>& last, std::atomic<uint32_t>& skipped,
+                         int intervalMs, uint32_t& skippedOut) {
+    int64_t now = monotonicMs();
+    int64_t prev = last.load(std::memory_order_relaxed);
+    if (now - prev < intervalMs || !last.compare_exchange_strong(prev, now)) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    skippedOut = skipped.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+void C_Logger::writeEntry(const S_Entry& e) {
+    char line[LOG_LINE_MAX + 32];
+    size_t n = formatLine(line, sizeof(line), e.ts, e.level, e.text, e.len);
+    (void)write(s_fd, line, n);
+}
+
+bool C_Logger::drain() {
+    // Copy pending lines out under the registry lock; write them outside it.
+    std::string batch;
+    static uint32_t reportedDrops = 0;
+
+    pthread_mutex_lock(&s_registryMutex);
+    S_Ring** link = &s_rings;
+    while (*link) {
+        S_Ring* ring = *link;
+        bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+
+        while (tail != head) {
+            const S_Entry& e = ring->slots[tail % LOG_RING_SLOTS];
+            char line[LOG_LINE_MAX + 32];
+            batch.append(line, formatLine(line, sizeof(line), e.ts, e.level, e.text, e.len));
+            ++tail;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+
+        if (orphaned) {
+            // Owner thread exited and its ring is empty.
+            *link = ring->next;
+            delete ring;
+        } else {
+            link = &ring->next;
+        }
+    }
+    pthread_mutex_unlock(&s_registryMutex);
+
+    uint32_t drops = s_dropped.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+        char line[96];
+        int n = std::snprintf(line, sizeof(line), "[Logger] %u linhas descartadas (buffer cheio)\n",
+                              drops - reportedDrops);
+        batch.append(line, static_cast<size_t>(n));
+        reportedDrops = drops;
+    }
+
+    if (batch.empty()) return false;
+    (void)write(s_fd, batch.data(), batch.size());
+    return true;
+}
+
+void* C_Logger::writerMain(void*) {
+    while (s_running.load(std::memory_order_acquire)) {
+        if (!drain()) {
+            struct timespec ts = {0, WRITER_IDLE_MS * 1000000L};
+            nanosleep(&ts, nullptr);
+        }
+    }
+    return nullptr;
+}
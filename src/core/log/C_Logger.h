@@ -0,0 +1,104 @@
+#ifndef C_LOGGER_H
+#define C_LOGGER_H
+
+/*
+ * Asynchronous logger.
+ * Each thread formats into its own lock-free ring; a background writer
+ * drains the rings to the daemon log (stdout), so callers never block on I/O.
+ */
+
+#include <pthread.h>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+
+#define LOG_LVL_DEBUG   0
+#define LOG_LVL_INFO    1
+#define LOG_LVL_WARN    2
+#define LOG_LVL_ERROR   3
+
+// Levels below LOG_MIN_LEVEL are removed at compile time.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL   LOG_LVL_DEBUG
+#endif
+
+#define LOG_RING_SLOTS  64
+#define LOG_LINE_MAX    240
+
+class C_Logger {
+public:
+    struct S_Entry {
+        struct timespec ts;
+        uint8_t level;
+        uint16_t len;
+        char text[LOG_LINE_MAX];
+    };
+
+    struct S_Ring {
+        S_Entry slots[LOG_RING_SLOTS];
+        std::atomic<uint32_t> head{0};
+        std::atomic<uint32_t> tail{0};
+        std::atomic<bool> orphaned{false};
+        S_Ring* next{nullptr};
+    };
+
+    static void start(int fd = 1);
+    static void stop();
+    static void log(uint8_t level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    static uint32_t dropped();
+
+    // Per-call-site limiter used by LOG_RATELIMITED (true = emit now).
+    static bool rateLimit(std::atomic<int64_t>& last, std::atomic<uint32_t>& skipped,
+                          int intervalMs, uint32_t& skippedOut);
+
+private:
+    static S_Ring* threadRing();
+    static void* writerMain(void*);
+    static bool drain();
+    static void writeEntry(const S_Entry& e);
+    static int64_t monotonicMs();
+
+    static pthread_mutex_t s_registryMutex;
+    static S_Ring* s_rings;
+    static pthread_t s_writer;
+    static std::atomic<bool> s_running;
+    static std::atomic<uint32_t> s_dropped;
+    static int s_fd;
+};
+
+#if LOG_MIN_LEVEL <= LOG_LVL_DEBUG
+#define LOG_DEBUG(...) C_Logger::log(LOG_LVL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LVL_INFO
+#define LOG_INFO(...) C_Logger::log(LOG_LVL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LVL_WARN
+#define LOG_WARN(...) C_Logger::log(LOG_LVL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#define LOG_ERROR(...) C_Logger::log(LOG_LVL_ERROR, __VA_ARGS__)
+
+// At most one line per intervalMs from this call site; skipped lines are counted.
+#define LOG_RATELIMITED(level, intervalMs, fmt, ...)                                   \
+    do {                                                                               \
+        if ((level) >= LOG_MIN_LEVEL) {                                                \
+            static std::atomic<int64_t> _logLast{INT64_MIN / 2};                       \
+            static std::atomic<uint32_t> _logSkipped{0};                               \
+            uint32_t _logN = 0;                                                        \
+            if (C_Logger::rateLimit(_logLast, _logSkipped, (intervalMs), _logN)) {     \
+                if (_logN > 0) C_Logger::log((level), fmt " (+%u suprimidas)", ##__VA_ARGS__, _logN); \
+                else C_Logger::log((level), fmt, ##__VA_ARGS__);                       \
+            }                                                                          \
+        }                                                                              \
+    } while (0)
+
+#endif
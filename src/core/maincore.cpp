@@ -2,6 +2,8 @@
 /*
  * SecureAssetCore main process.
  * Daemonizes, initializes the C_SecureAsset singleton, and manages lifecycle.
+ * "--bench-gpio [toggles]" instead runs the GPIO write-path benchmark in the
+ * foreground (on the alarm LED line, or the simulated board) and exits.
  */
 
 #include <iostream>
@@ -11,16 +13,28 @@
 #include <sys/stat.h>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <string>
 
 #include "C_SecureAsset.h"
+#include "C_Config.h"
+#include "C_SiteMap.h"
+#include "C_Logger.h"
 #include "C_Mqueue.h"
+#include "C_SimHardware.h"
+#include "C_IoStats.h"
 #include "SharedTypes.h"
 
 static const char* CORE_PIDFILE = "/var/run/SecureAssetCore.pid";
+static const int GPIO_BENCH_TOGGLES = 10000;
 static volatile sig_atomic_t g_shutdown = 0;
+static volatile sig_atomic_t g_reload = 0;
+static volatile sig_atomic_t g_dumpIo = 0;
 static int g_shutdown_fd = -1;
 
 static void handleSignal(int) { g_shutdown = 1; }
+static void handleReload(int) { g_reload = 1; }
+static void handleDumpIo(int) { g_dumpIo = 1; }
 
 static void sendShutdownAck() {
     if (g_shutdown_fd >= 0) {
@@ -79,23 +93,67 @@ static void daemonize(const char* pidfile, const char* logfile = nullptr) {
     }
 }
 
-int main() {
+static int benchGpio(const C_Config& config, bool sim, int toggles) {
+    C_Logger::start(STDOUT_FILENO);
+
+    std::unique_ptr<C_SimHardware> simHw;
+    if (sim) {
+        simHw = std::make_unique<C_SimHardware>(config);
+        if (!simHw->setup()) {
+            simHw.reset();
+            C_Logger::stop();
+            return -1;
+        }
+    }
+
+    C_SiteMap site;
+    site.load(config);
+    C_GPIO::benchmark(site.alarmLedPin, toggles);
+
+    simHw.reset();
+    C_Logger::stop();
+    return 0;
+}
+
+int main(int argc, char** argv) {
     int notify_fd = -1;
     if (const char* env = std::getenv("NOTIFY_FD")) notify_fd = std::atoi(env);
     if (const char* env = std::getenv("SHUTDOWN_FD")) g_shutdown_fd = std::atoi(env);
 
-    // Load external IRQ driver before daemonizing.
-    if (system("insmod /root/my_irq.ko") != 0) {
-        std::cerr << "[AVISO] Falha ao carregar driver ou já estava carregado." << std::endl;
+    // Load external IRQ driver before daemonizing (not needed with GPIO edge events
+    // or on simulated hardware).
+    C_Config config;
+    config.load(SYSTEM_CONFIG_PATH);
+    const bool sim = config.getInt("sim", "enabled", 0) != 0 || std::getenv("SECUREASSET_SIM");
+    if (argc > 1 && std::strcmp(argv[1], "--bench-gpio") == 0) {
+        return benchGpio(config, sim, (argc > 2) ? std::atoi(argv[2]) : GPIO_BENCH_TOGGLES);
+    }
+    if (!sim && config.getString("site", "irq_source", "driver") != "gpio") {
+        std::string cmd = "insmod " + config.getString("site", "irq_module", IRQ_MODULE_DEFAULT);
+        if (system(cmd.c_str()) != 0) {
+            std::cerr << "[AVISO] Falha ao carregar driver ou já estava carregado." << std::endl;
+        }
     }
     daemonize(CORE_PIDFILE, "/var/log/SecureAssetCore.log");
     unsetenv("NOTIFY_FD");
     unsetenv("SHUTDOWN_FD");
 
+    // Async log writer (stdout is the daemon log file from here on).
+    C_Logger::start(STDOUT_FILENO);
+
+    // Simulated board: the HAL must point at it before the core opens any device.
+    std::unique_ptr<C_SimHardware> simHw;
+    if (sim) {
+        C_Thread::setRealtime(config.getInt("sim", "realtime", geteuid() == 0) != 0);
+        simHw = std::make_unique<C_SimHardware>(config);
+        if (!simHw->setup()) simHw.reset();
+    }
+
     // Initialize core singleton and its threads.
     C_SecureAsset* core = C_SecureAsset::getInstance();
-    bool ok = core->init();
+    bool ok = (!sim || simHw) && core->init();
     if (ok) core->start();
+    if (ok && simHw) simHw->start();
 
     // Startup notify (PID or -1 on failure).
     if (notify_fd >= 0) {
@@ -111,18 +169,41 @@ int main() {
         // Ensure the wrapper does not block waiting for ACK.
         sendShutdownAck();  // closes g_shutdown_fd
         C_SecureAsset::destroyInstance();
+        simHw.reset();
+        C_Logger::stop();
         return -1;
     }
 
     std::signal(SIGINT, handleSignal);
     std::signal(SIGTERM, handleSignal);
-
-    // Main daemon loop: sleep until SIGINT/SIGTERM.
-    while (!g_shutdown) pause();
+    std::signal(SIGHUP, handleReload);
+    std::signal(SIGUSR1, handleDumpIo);
+
+    // Main daemon loop: sleep until SIGINT/SIGTERM; SIGHUP reloads the rules,
+    // SIGUSR1 logs the HAL I/O counters.
+    while (!g_shutdown) {
+        pause();
+        if (g_reload) {
+            g_reload = 0;
+            core->reloadRules();
+        }
+        if (g_dumpIo) {
+            g_dumpIo = 0;
+            C_IoStats::logAll();
+        }
+    }
 
     core->stop();
     core->waitForThreads();
+    C_IoStats::logAll();
+    if (simHw) {
+        simHw->requestStop();
+        simHw->join();
+    }
+    // The core's devices may still talk to the simulated bus while closing.
     C_SecureAsset::destroyInstance();
+    simHw.reset();
+    C_Logger::stop();
 
     sendShutdownAck();
     unlink(CORE_PIDFILE);
@@ -0,0 +1,104 @@
+/*
+ * Incremental environment statistics and early-warning detection.
+ */
+
+#include "C_EnvStats.h"
+#include <cmath>
+#include <cstring>
+
+C_EnvStats::C_EnvStats()
+    : m_samples(0),
+      m_rateRef(0),
+      m_active(ENV_ALERT_NONE) {
+    memset(&m_temp, 0, sizeof(m_temp));
+    memset(&m_hum, 0, sizeof(m_hum));
+    memset(m_times, 0, sizeof(m_times));
+}
+
+void C_EnvStats::push(S_Wedge& q, uint32_t seq, double x, bool keepMin) {
+    // Drop the sample leaving the window, then everything x dominates.
+    if (q.head != q.tail && q.seq[q.head % ENV_WINDOW] + ENV_WINDOW <= seq) {
+        q.head++;
+    }
+    while (q.head != q.tail) {
+        double back = q.value[(q.tail - 1) % ENV_WINDOW];
+        if (keepMin ? (back < x) : (back > x)) break;
+        q.tail--;
+    }
+    q.seq[q.tail % ENV_WINDOW] = seq;
+    q.value[q.tail % ENV_WINDOW] = x;
+    q.tail++;
+}
+
+void C_EnvStats::fold(S_Tracker& t, double x, double spanS) {
+    S_Channel& c = t.stats;
+
+    if (m_samples == 0) {
+        c.mean = x;
+        c.var = 0.0;
+        c.ratePerMin = 0.0;
+        c.deviation = 0.0;
+        c.zScore = 0.0;
+    } else {
+        // EWMA mean/variance (West); z-score against the state before x.
+        double delta = x - c.mean;
+        double sigma = std::sqrt(c.var);
+        c.deviation = delta;
+        c.zScore = (sigma > 1e-9) ? delta / sigma : 0.0;
+        c.mean += ENV_EWMA_ALPHA * delta;
+        c.var = (1.0 - ENV_EWMA_ALPHA) * (c.var + ENV_EWMA_ALPHA * delta * delta);
+        c.ratePerMin = (spanS > 0.0) ? (x - t.history[m_rateRef % ENV_WINDOW]) * 60.0 / spanS : 0.0;
+    }
+    c.last = x;
+    t.history[m_samples % ENV_WINDOW] = x;
+
+    push(t.minQ, m_samples, x, true);
+    push(t.maxQ, m_samples, x, false);
+    c.min = t.minQ.value[t.minQ.head % ENV_WINDOW];
+    c.max = t.maxQ.value[t.maxQ.head % ENV_WINDOW];
+}
+
+uint8_t C_EnvStats::update(double temp, double hum, double nowS) {
+    // Rate reference: newest sample at least ENV_RATE_SPAN_S old that is still
+    // in the window (the index only moves forward: O(1) amortized).
+    uint32_t seq = m_samples;
+    if (seq >= ENV_WINDOW && m_rateRef < seq - ENV_WINDOW + 1) {
+        m_rateRef = seq - ENV_WINDOW + 1;
+    }
+    while (m_rateRef + 1 < seq && nowS - m_times[(m_rateRef + 1) % ENV_WINDOW] >= ENV_RATE_SPAN_S) {
+        m_rateRef++;
+    }
+    double span = (seq > 0) ? nowS - m_times[m_rateRef % ENV_WINDOW] : 0.0;
+    if (span < ENV_RATE_MIN_SPAN_S) span = 0.0;
+    m_times[seq % ENV_WINDOW] = nowS;
+
+    fold(m_temp, temp, span);
+    fold(m_hum, hum, span);
+    m_samples++;
+
+    const S_Channel& t = m_temp.stats;
+    const S_Channel& h = m_hum.stats;
+    uint8_t current = ENV_ALERT_NONE;
+
+    if (m_samples > 1 && t.ratePerMin >= ENV_RISE_C_PER_MIN) {
+        current |= ENV_ALERT_RAPID_RISE;
+    }
+
+    if (m_samples > ENV_WARMUP_SAMPLES) {
+        if (std::fabs(h.zScore) >= ENV_ANOMALY_SIGMA && std::fabs(h.deviation) >= ENV_HUM_SPIKE_MIN_RH) {
+            current |= ENV_ALERT_HUM_SPIKE;
+        }
+        if (std::fabs(t.zScore) >= ENV_ANOMALY_SIGMA && std::fabs(t.deviation) >= ENV_TEMP_DRIFT_MIN_C) {
+            current |= ENV_ALERT_TEMP_DRIFT;
+        }
+    }
+
+    // A live sensor always shows some noise over a full window.
+    if (windowFull() && (t.max - t.min) < ENV_STUCK_EPS && (h.max - h.min) < ENV_STUCK_EPS) {
+        current |= ENV_ALERT_STUCK;
+    }
+
+    uint8_t raised = static_cast<uint8_t>(current & ~m_active);
+    m_active = current;
+    return raised;
+}
@@ -0,0 +1,85 @@
+#ifndef C_ENVSTATS_H
+#define C_ENVSTATS_H
+
+/*
+ * Streaming statistics over the SHT30 samples (O(1) per sample, no history scans).
+ * Per channel: EWMA mean/variance, rate of change and rolling min/max over the
+ * last ENV_WINDOW samples (monotonic ring queues). The rate is the slope to the
+ * newest sample about ENV_RATE_SPAN_S old, so short sampling intervals do not
+ * turn sensor noise into a rise. update() reports the alerts that became active
+ * with the sample (edge-triggered, re-armed once cleared).
+ */
+
+#include <cstdint>
+
+#define ENV_WINDOW            32      // Samples in the rolling min/max window.
+#define ENV_EWMA_ALPHA        0.1
+#define ENV_WARMUP_SAMPLES    8       // No statistical alerts before this.
+#define ENV_ANOMALY_SIGMA     4.0
+#define ENV_RISE_C_PER_MIN    1.0     // Rapid temperature rise.
+#define ENV_RATE_SPAN_S       60.0    // Rate measured over about this span...
+#define ENV_RATE_MIN_SPAN_S   30.0    // ...and never less (no rate until then).
+#define ENV_TEMP_DRIFT_MIN_C  1.0     // Smallest deviation reported as drift.
+#define ENV_HUM_SPIKE_MIN_RH  5.0     // Smallest humidity jump reported as spike.
+#define ENV_STUCK_EPS         0.001   // Below one SHT30 LSB: identical raw codes.
+
+enum EnvAlert_enum : uint8_t {
+    ENV_ALERT_NONE       = 0,
+    ENV_ALERT_RAPID_RISE = 1 << 0,
+    ENV_ALERT_HUM_SPIKE  = 1 << 1,
+    ENV_ALERT_STUCK      = 1 << 2,
+    ENV_ALERT_TEMP_DRIFT = 1 << 3
+};
+
+class C_EnvStats {
+public:
+    struct S_Channel {
+        double mean;
+        double var;
+        double ratePerMin;
+        double last;
+        double deviation;        // Sample minus the mean before it was folded in.
+        double zScore;
+        double min;
+        double max;
+    };
+
+    C_EnvStats();
+
+    // Fold one sample in; returns the ENV_ALERT_* bits that became active.
+    uint8_t update(double temp, double hum, double nowS);
+
+    const S_Channel& temp() const { return m_temp.stats; }
+    const S_Channel& hum() const { return m_hum.stats; }
+    uint8_t active() const { return m_active; }
+    uint32_t samples() const { return m_samples; }
+    bool windowFull() const { return m_samples >= ENV_WINDOW; }
+
+private:
+    // Monotonic queue of (seq, value); front is the window extreme.
+    struct S_Wedge {
+        uint32_t seq[ENV_WINDOW];
+        double value[ENV_WINDOW];
+        uint32_t head;
+        uint32_t tail;
+    };
+
+    struct S_Tracker {
+        S_Channel stats;
+        S_Wedge minQ;
+        S_Wedge maxQ;
+        double history[ENV_WINDOW];   // Raw samples, indexed like m_times.
+    };
+
+    S_Tracker m_temp;
+    S_Tracker m_hum;
+    uint32_t m_samples;
+    double m_times[ENV_WINDOW];
+    uint32_t m_rateRef;       // Sample the rate is measured from.
+    uint8_t m_active;
+
+    void fold(S_Tracker& t, double x, double spanS);
+    static void push(S_Wedge& q, uint32_t seq, double x, bool keepMin);
+};
+
+#endif
@@ -0,0 +1,365 @@
+/*
+ * Rule engine implementation: text compiler, dispatch and actions.
+ */
+
+#include "C_RuleEngine.h"
+#include "C_Mqueue.h"
+#include "C_Outbox.h"
+#include "C_Logger.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+static const char* const EVENT_NAMES[REVT_COUNT] = {
+    "ACCESS_GRANTED", "ACCESS_DENIED", "EXIT_GRANTED", "PIR", "ENV_SAMPLE", "ENV_ALERT"
+};
+
+static const char* const VAR_NAMES[RVAR_COUNT] = {
+    "failed_swipes", "occupancy", "temperature", "humidity",
+    "temp_threshold", "fan", "last_user", "env_alert",
+    "max_failed_swipes"
+};
+
+// Indexed by LogEvent_enum.
+static const char* const LOG_EVENT_NAMES[] = {
+    "NONE", "ROOM_ENTER", "ROOM_DENIED", "ROOM_LEAVE", "VAULT_OPEN", "VAULT_DENIED",
+    "PIR_EMPTY_ROOM", "PIR_MOTION", "INVENTORY_SCAN", "ENV_READING", "ACTUATOR_STATE",
+    "ENV_RAPID_RISE", "ENV_HUM_SPIKE", "ENV_STUCK", "ENV_TEMP_DRIFT", "ASSET_APPEARED",
+    "ASSET_MISSING"
+};
+
+static const char* const DEFAULT_RULES =
+    "# Room entry: repeated failed swipes raise the alarm.\n"
+    "on ACCESS_DENIED do inc failed_swipes\n"
+    "on ACCESS_DENIED if failed_swipes >= max_failed_swipes do actuate ALARM_ACTUATOR 1 ; log ROOM_DENIED ; set failed_swipes 0\n"
+    "on ACCESS_GRANTED do set failed_swipes 0\n"
+    "# Intrusion: movement with nobody inside.\n"
+    "on PIR if occupancy == 0 do actuate ALARM_ACTUATOR 1 ; log PIR_EMPTY_ROOM\n"
+    "# Environment: fan follows the temperature threshold.\n"
+    "on ENV_SAMPLE if temperature > temp_threshold and fan == 0 do actuate FAN 1 ; set fan 1\n"
+    "on ENV_SAMPLE if temperature <= temp_threshold and fan != 0 do actuate FAN 0 ; set fan 0\n";
+
+static constexpr size_t MAX_PENDING_ACTIONS = 16;
+
+// A denied swipe in one room must not count towards (or reset) another room.
+static bool roomScoped(RuleVar_enum var) {
+    return var == RVAR_FAILED_SWIPES || var == RVAR_LAST_USER;
+}
+
+template <size_t N>
+static int lookup(const char* const (&names)[N], const std::string& token) {
+    for (size_t i = 0; i < N; ++i) {
+        if (token == names[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+static bool parseNumber(const std::string& token, double& out) {
+    char* end = nullptr;
+    out = strtod(token.c_str(), &end);
+    return end && *end == '\0' && end != token.c_str();
+}
+
+static bool parseOp(const std::string& token, C_RuleEngine::Op_enum& op) {
+    if (token == ">")  { op = C_RuleEngine::OP_GT; return true; }
+    if (token == ">=") { op = C_RuleEngine::OP_GE; return true; }
+    if (token == "<")  { op = C_RuleEngine::OP_LT; return true; }
+    if (token == "<=") { op = C_RuleEngine::OP_LE; return true; }
+    if (token == "==") { op = C_RuleEngine::OP_EQ; return true; }
+    if (token == "!=") { op = C_RuleEngine::OP_NE; return true; }
+    return false;
+}
+
+static LogType_enum logTypeFor(LogEvent_enum code) {
+    switch (code) {
+        case EVT_ROOM_DENIED:
+        case EVT_VAULT_DENIED:
+        case EVT_PIR_EMPTY_ROOM:
+        case EVT_ASSET_MISSING:  return LOG_TYPE_ALERT;
+        case EVT_INVENTORY_SCAN:
+        case EVT_ASSET_APPEARED: return LOG_TYPE_INVENTORY;
+        case EVT_ENV_READING:    return LOG_TYPE_SENSOR;
+        case EVT_ACTUATOR_STATE: return LOG_TYPE_ACTUATOR;
+        case EVT_NONE:           return LOG_TYPE_SYSTEM;
+        default:                 return LOG_TYPE_ACCESS;
+    }
+}
+
+// Compile one line; returns false (with reason) on syntax error.
+static bool compileLine(const std::string& line, C_RuleEngine::RuleTable& table, std::string& error) {
+    std::string spaced;
+    for (char c : line) {
+        if (c == '#') break;
+        if (c == ';') spaced += " ; ";
+        else spaced += c;
+    }
+
+    std::istringstream in(spaced);
+    std::vector<std::string> tok;
+    std::string t;
+    while (in >> t) tok.push_back(t);
+    if (tok.empty()) return true;
+
+    size_t i = 0;
+    if (tok.size() < 4 || tok[i++] != "on") { error = "esperado 'on <EVENTO>'"; return false; }
+
+    int event = lookup(EVENT_NAMES, tok[i++]);
+    if (event < 0) { error = "evento desconhecido '" + tok[i - 1] + "'"; return false; }
+
+    C_RuleEngine::S_Rule rule = {};
+
+    if (tok[i] == "if") {
+        ++i;
+        while (true) {
+            if (i + 3 > tok.size()) { error = "condição incompleta"; return false; }
+            if (rule.nConditions >= RULE_MAX_CONDITIONS) { error = "demasiadas condições"; return false; }
+
+            C_RuleEngine::S_Condition& c = rule.conditions[rule.nConditions++];
+            int var = lookup(VAR_NAMES, tok[i]);
+            if (var < 0) { error = "variável desconhecida '" + tok[i] + "'"; return false; }
+            c.var = static_cast<RuleVar_enum>(var);
+            if (!parseOp(tok[i + 1], c.op)) { error = "operador inválido '" + tok[i + 1] + "'"; return false; }
+
+            int rhs = lookup(VAR_NAMES, tok[i + 2]);
+            if (rhs >= 0) {
+                c.rhsIsVar = true;
+                c.rhsVar = static_cast<RuleVar_enum>(rhs);
+            } else if (!parseNumber(tok[i + 2], c.rhsValue)) {
+                error = "valor inválido '" + tok[i + 2] + "'";
+                return false;
+            }
+            i += 3;
+
+            if (i < tok.size() && tok[i] == "and") { ++i; continue; }
+            break;
+        }
+    }
+
+    if (i >= tok.size() || tok[i++] != "do") { error = "esperado 'do'"; return false; }
+
+    while (i < tok.size()) {
+        if (rule.nActions >= RULE_MAX_ACTIONS) { error = "demasiadas ações"; return false; }
+        C_RuleEngine::S_Action& a = rule.actions[rule.nActions];
+        const std::string& verb = tok[i++];
+        int target = -1;
+
+        if (verb == "inc" && i < tok.size()) {
+            a.type = C_RuleEngine::ACT_INC;
+            target = lookup(VAR_NAMES, tok[i++]);
+        } else if (verb == "set" && i + 1 < tok.size()) {
+            a.type = C_RuleEngine::ACT_SET;
+            target = lookup(VAR_NAMES, tok[i++]);
+            if (!parseNumber(tok[i++], a.value)) { error = "valor inválido em 'set'"; return false; }
+        } else if (verb == "actuate" && i + 1 < tok.size()) {
+            a.type = C_RuleEngine::ACT_ACTUATE;
+            target = lookup(ACTUATOR_NAMES, tok[i++]);
+            if (!parseNumber(tok[i++], a.value)) { error = "valor inválido em 'actuate'"; return false; }
+        } else if (verb == "log" && i < tok.size()) {
+            a.type = C_RuleEngine::ACT_LOG;
+            target = lookup(LOG_EVENT_NAMES, tok[i++]);
+        } else {
+            error = "ação inválida '" + verb + "'";
+            return false;
+        }
+
+        if (target < 0) { error = "alvo desconhecido em '" + verb + "'"; return false; }
+        if ((a.type == C_RuleEngine::ACT_INC || a.type == C_RuleEngine::ACT_SET) &&
+            target == RVAR_OCCUPANCY) {
+            error = "'occupancy' é só de leitura";
+            return false;
+        }
+        a.target = static_cast<uint8_t>(target);
+        ++rule.nActions;
+
+        if (i < tok.size()) {
+            if (tok[i] != ";") { error = "esperado ';' entre ações"; return false; }
+            ++i;
+        }
+    }
+
+    if (rule.nActions == 0) { error = "regra sem ações"; return false; }
+
+    table[event].push_back(rule);
+    return true;
+}
+
+C_RuleEngine::C_RuleEngine(C_Mqueue& mqToActuator, C_Outbox& outbox, OccupancyFn occupancy)
+    : m_mqToActuator(mqToActuator),
+      m_outbox(outbox),
+      m_occupancy(std::move(occupancy)),
+      m_eventRoom(0) {
+    pthread_mutex_init(&m_mutex, NULL);
+    memset(m_vars, 0, sizeof(m_vars));
+    m_vars[RVAR_MAX_FAILED_SWIPES] = RULE_MAX_FAILED_SWIPES_DEFAULT;
+}
+
+C_RuleEngine::~C_RuleEngine() {
+    pthread_mutex_destroy(&m_mutex);
+}
+
+bool C_RuleEngine::loadDefaults() {
+    return loadText(DEFAULT_RULES, "default");
+}
+
+bool C_RuleEngine::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        LOG_WARN("[Rules] Ficheiro %s indisponível: regras mantidas", path.c_str());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return loadText(buffer.str(), path.c_str());
+}
+
+bool C_RuleEngine::loadText(const std::string& text, const char* origin) {
+    auto table = std::make_shared<RuleTable>();
+    std::istringstream in(text);
+    std::string line;
+    int lineNo = 0;
+    size_t count = 0;
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        std::string error;
+        if (!compileLine(line, *table, error)) {
+            LOG_ERROR("[Rules] %s:%d: %s (regras mantidas)", origin, lineNo, error.c_str());
+            return false;
+        }
+    }
+
+    for (const auto& rules : *table) count += rules.size();
+
+    // Readers keep the old table alive until their fire() returns.
+    std::atomic_store(&m_table, std::shared_ptr<const RuleTable>(table));
+    LOG_INFO("[Rules] %zu regras ativas (%s)", count, origin);
+    return true;
+}
+
+void C_RuleEngine::setVar(RuleVar_enum var, double value, uint16_t roomId) {
+    if (var >= RVAR_COUNT || var == RVAR_OCCUPANCY) return;
+    pthread_mutex_lock(&m_mutex);
+    varRef(var, roomId) = value;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+double C_RuleEngine::getVar(RuleVar_enum var, uint16_t roomId) {
+    if (var >= RVAR_COUNT) return 0.0;
+    pthread_mutex_lock(&m_mutex);
+    m_eventRoom = roomId;
+    double value = readVar(var);
+    pthread_mutex_unlock(&m_mutex);
+    return value;
+}
+
+// Caller holds m_mutex. A room's bank starts zeroed on its first event.
+double& C_RuleEngine::varRef(RuleVar_enum var, uint16_t roomId) {
+    if (roomScoped(var)) return m_roomVars[roomId][var];
+    return m_vars[var];
+}
+
+double C_RuleEngine::readVar(RuleVar_enum var) {
+    if (var == RVAR_OCCUPANCY) return static_cast<double>(m_occupancy(m_eventRoom));
+    return varRef(var, m_eventRoom);
+}
+
+bool C_RuleEngine::matches(const S_Rule& rule) {
+    for (uint8_t i = 0; i < rule.nConditions; ++i) {
+        const S_Condition& c = rule.conditions[i];
+        double lhs = readVar(c.var);
+        double rhs = c.rhsIsVar ? readVar(c.rhsVar) : c.rhsValue;
+        bool ok = false;
+        switch (c.op) {
+            case OP_GT: ok = lhs > rhs;  break;
+            case OP_GE: ok = lhs >= rhs; break;
+            case OP_LT: ok = lhs < rhs;  break;
+            case OP_LE: ok = lhs <= rhs; break;
+            case OP_EQ: ok = lhs == rhs; break;
+            case OP_NE: ok = lhs != rhs; break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+void C_RuleEngine::fire(RuleEvent_enum event, double a, double b, uint16_t roomId) {
+    if (event >= REVT_COUNT) return;
+
+    std::shared_ptr<const RuleTable> table = std::atomic_load(&m_table);
+    if (!table) return;
+
+    S_Action pending[MAX_PENDING_ACTIONS];
+    size_t nPending = 0;
+    uint32_t entityId = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    m_eventRoom = roomId;
+
+    // Event parameters land in state vars before the rules run.
+    switch (event) {
+        case REVT_ENV_SAMPLE:
+            m_vars[RVAR_TEMPERATURE] = a;
+            m_vars[RVAR_HUMIDITY] = b;
+            break;
+        case REVT_ENV_ALERT:
+            m_vars[RVAR_ENV_ALERT] = a;
+            break;
+        case REVT_ACCESS_GRANTED:
+        case REVT_EXIT_GRANTED:
+            varRef(RVAR_LAST_USER, roomId) = a;
+            entityId = static_cast<uint32_t>(a);
+            break;
+        default:
+            break;
+    }
+
+    // Rules of one event run in file order; state actions apply immediately.
+    for (const S_Rule& rule : (*table)[event]) {
+        if (!matches(rule)) continue;
+
+        for (uint8_t i = 0; i < rule.nActions; ++i) {
+            const S_Action& action = rule.actions[i];
+            RuleVar_enum var = static_cast<RuleVar_enum>(action.target);
+            if (action.type == ACT_INC) {
+                varRef(var, roomId) += 1.0;
+            } else if (action.type == ACT_SET) {
+                varRef(var, roomId) = action.value;
+            } else if (nPending < MAX_PENDING_ACTIONS) {
+                pending[nPending++] = action;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+
+    // Side effects (queue sends) run outside the lock.
+    for (size_t i = 0; i < nPending; ++i) {
+        execute(pending[i], entityId, roomId);
+    }
+}
+
+void C_RuleEngine::execute(const S_Action& action, uint32_t entityId, uint16_t roomId) {
+    if (action.type == ACT_ACTUATE) {
+        // Door actuation targets the event's room.
+        ActuatorCmd cmd(static_cast<ActuatorID_enum>(action.target),
+                        static_cast<uint8_t>(action.value), roomId);
+        m_mqToActuator.send(&cmd, sizeof(cmd));
+        return;
+    }
+
+    if (action.type == ACT_LOG) {
+        LogEvent_enum code = static_cast<LogEvent_enum>(action.target);
+        DatabaseMsg msg = {};
+        msg.command = DB_CMD_WRITE_LOG;
+        msg.roomId = roomId;
+        msg.payload.log.logType = logTypeFor(code);
+        msg.payload.log.eventCode = code;
+        msg.payload.log.entityID = entityId;
+        msg.payload.log.value = action.value;
+        msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
+        m_outbox.post(msg);
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef C_RULEENGINE_H
+#define C_RULEENGINE_H
+
+/*
+ * Table-driven reactions (access, intrusion, environment).
+ * Rules are compiled into a dense table indexed by event type; fire() scans only
+ * the rules of that event. The compiled table is swapped atomically (hot reload).
+ *
+ * Rule syntax (one per line, '#' comments):
+ *   on <EVENT> [if <var> <op> <var|number> [and ...]] do <action> [; <action> ...]
+ *   actions: inc <var> | set <var> <number> | actuate <ACTUATOR> <value> | log <EVENT_CODE>
+ */
+
+#include <pthread.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SharedTypes.h"
+
+class C_Mqueue;
+class C_Outbox;
+
+enum RuleEvent_enum : uint8_t {
+    REVT_ACCESS_GRANTED = 0,
+    REVT_ACCESS_DENIED,
+    REVT_EXIT_GRANTED,
+    REVT_PIR,
+    REVT_ENV_SAMPLE,
+    REVT_ENV_ALERT,          // a -> LogEvent_enum of the early warning.
+    REVT_COUNT
+};
+
+// failed_swipes and last_user are kept per room; the rest are site-wide.
+enum RuleVar_enum : uint8_t {
+    RVAR_FAILED_SWIPES = 0,
+    RVAR_OCCUPANCY,          // Live occupancy of the event's room (read-only).
+    RVAR_TEMPERATURE,
+    RVAR_HUMIDITY,
+    RVAR_TEMP_THRESHOLD,
+    RVAR_FAN,
+    RVAR_LAST_USER,
+    RVAR_ENV_ALERT,
+    RVAR_MAX_FAILED_SWIPES,  // Denied swipes before the alarm (configuration).
+    RVAR_COUNT
+};
+
+#define RULE_MAX_FAILED_SWIPES_DEFAULT  3
+
+#define RULE_MAX_CONDITIONS  4
+#define RULE_MAX_ACTIONS     4
+
+class C_RuleEngine {
+public:
+    enum Op_enum : uint8_t { OP_GT, OP_GE, OP_LT, OP_LE, OP_EQ, OP_NE };
+    enum Action_enum : uint8_t { ACT_INC, ACT_SET, ACT_ACTUATE, ACT_LOG };
+
+    struct S_Condition {
+        RuleVar_enum var;
+        Op_enum op;
+        bool rhsIsVar;
+        RuleVar_enum rhsVar;
+        double rhsValue;
+    };
+
+    struct S_Action {
+        Action_enum type;
+        uint8_t target;          // Var, actuator ID or log event code.
+        double value;
+    };
+
+    struct S_Rule {
+        uint8_t nConditions;
+        uint8_t nActions;
+        S_Condition conditions[RULE_MAX_CONDITIONS];
+        S_Action actions[RULE_MAX_ACTIONS];
+    };
+
+    typedef std::array<std::vector<S_Rule>, REVT_COUNT> RuleTable;
+    // Occupancy of a room by ID (0: whole site).
+    typedef std::function<uint32_t(uint16_t roomId)> OccupancyFn;
+
+    C_RuleEngine(C_Mqueue& mqToActuator, C_Outbox& outbox, OccupancyFn occupancy);
+    ~C_RuleEngine();
+
+    // Built-in rules (max_failed_swipes, PIR in empty room, fan threshold).
+    bool loadDefaults();
+    // Compile a rules file; the active table is kept if it does not parse.
+    bool loadFile(const std::string& path);
+    bool loadText(const std::string& text, const char* origin);
+
+    // Event parameters: a -> temperature/user, b -> humidity (see event map).
+    // roomId scopes occupancy, door actuation and logs (0: site-wide event).
+    void fire(RuleEvent_enum event, double a = 0.0, double b = 0.0, uint16_t roomId = 0);
+    // roomId selects the bank of room-scoped variables (ignored for site-wide ones).
+    void setVar(RuleVar_enum var, double value, uint16_t roomId = 0);
+    double getVar(RuleVar_enum var, uint16_t roomId = 0);
+
+private:
+    C_Mqueue& m_mqToActuator;
+    C_Outbox& m_outbox;
+    OccupancyFn m_occupancy;
+
+    pthread_mutex_t m_mutex;
+    double m_vars[RVAR_COUNT];
+    std::unordered_map<uint16_t, std::array<double, RVAR_COUNT>> m_roomVars;
+    uint16_t m_eventRoom;
+    std::shared_ptr<const RuleTable> m_table;
+
+    double& varRef(RuleVar_enum var, uint16_t roomId);
+    double readVar(RuleVar_enum var);
+    bool matches(const S_Rule& rule);
+    void execute(const S_Action& action, uint32_t entityId, uint16_t roomId);
+};
+
+#endif
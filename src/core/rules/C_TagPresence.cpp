@@ -0,0 +1,45 @@
+/*
+ * Tag presence table: appear/missing transitions of background inventory.
+ */
+
+#include "C_TagPresence.h"
+#include "SharedTypes.h"
+
+C_TagPresence::C_TagPresence(int64_t missingMs)
+    : m_missingMs(missingMs),
+      m_present(0) {
+}
+
+bool C_TagPresence::seen(const uint8_t* epc, int64_t nowMs) {
+    std::string key(reinterpret_cast<const char*>(epc), INVENTORY_EPC_BYTES);
+    S_TagPresence& tag = m_tags[key];
+    tag.lastSeenMs = nowMs;
+    ++tag.reads;
+    if (tag.present) return false;
+
+    tag.present = true;
+    ++m_present;
+    return true;
+}
+
+void C_TagPresence::seed(const uint8_t* epc, int64_t nowMs) {
+    std::string key(reinterpret_cast<const char*>(epc), INVENTORY_EPC_BYTES);
+    auto inserted = m_tags.emplace(key, S_TagPresence{nowMs, 0, true});
+    if (inserted.second) ++m_present;
+}
+
+void C_TagPresence::expire(int64_t nowMs, const MissingFn& onMissing) {
+    for (auto& entry : m_tags) {
+        S_TagPresence& tag = entry.second;
+        if (!tag.present || nowMs - tag.lastSeenMs <= m_missingMs) continue;
+
+        tag.present = false;
+        --m_present;
+        onMissing(reinterpret_cast<const uint8_t*>(entry.first.data()), tag);
+    }
+}
+
+const S_TagPresence* C_TagPresence::find(const uint8_t* epc) const {
+    auto it = m_tags.find(std::string(reinterpret_cast<const char*>(epc), INVENTORY_EPC_BYTES));
+    return (it == m_tags.end()) ? nullptr : &it->second;
+}
@@ -0,0 +1,50 @@
+#ifndef C_TAGPRESENCE_H
+#define C_TAGPRESENCE_H
+
+/*
+ * Presence table of the vault's tags for background inventory.
+ * Rounds fold their reads in with seen(); a present tag stays present until it
+ * has gone unread for the missing time. Only transitions are reported, so the
+ * events sent on grow with the changes, not with the number of rounds.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+struct S_TagPresence {
+    int64_t lastSeenMs;    // Monotonic time of the last read.
+    uint32_t reads;        // Rounds that read the tag.
+    bool present;
+};
+
+class C_TagPresence {
+public:
+    typedef std::function<void(const uint8_t* epc, const S_TagPresence& tag)> MissingFn;
+
+    explicit C_TagPresence(int64_t missingMs);
+
+    // One read of epc in a round; true if the tag appeared (new or back).
+    bool seen(const uint8_t* epc, int64_t nowMs);
+
+    // Tag known present from a previous run: present as of nowMs, not reported.
+    // A tag already in the table keeps its state.
+    void seed(const uint8_t* epc, int64_t nowMs);
+
+    // Present tags unread for more than missingMs become missing; onMissing runs
+    // once per transition.
+    void expire(int64_t nowMs, const MissingFn& onMissing);
+
+    const S_TagPresence* find(const uint8_t* epc) const;
+    size_t presentCount() const { return m_present; }
+
+private:
+    // Key: the raw INVENTORY_EPC_BYTES of the EPC.
+    std::unordered_map<std::string, S_TagPresence> m_tags;
+    int64_t m_missingMs;
+    size_t m_present;
+};
+
+#endif
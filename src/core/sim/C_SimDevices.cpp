@@ -0,0 +1,291 @@
+/*
+ * Device emulators: pty-backed UART modules and the SHT30 bus model.
+ */
+
+#include "C_SimDevices.h"
+#include "C_Logger.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static int64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ---------------------------------------------------------------- pty base
+
+C_SimUartDevice::C_SimUartDevice()
+    : m_master(-1),
+      m_slave(-1) {
+}
+
+C_SimUartDevice::~C_SimUartDevice() {
+    if (!m_link.empty()) unlink(m_link.c_str());
+    if (m_slave >= 0) close(m_slave);
+    if (m_master >= 0) close(m_master);
+}
+
+bool C_SimUartDevice::open(const std::string& link) {
+    m_master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (m_master < 0 || grantpt(m_master) != 0 || unlockpt(m_master) != 0) {
+        LOG_ERROR("[Sim] posix_openpt: %s", strerror(errno));
+        return false;
+    }
+    char name[64];
+    if (ptsname_r(m_master, name, sizeof(name)) != 0) return false;
+
+    // Raw line discipline from the start; the core re-applies its own settings.
+    m_slave = ::open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (m_slave < 0) {
+        LOG_ERROR("[Sim] %s: %s", name, strerror(errno));
+        return false;
+    }
+    struct termios tio;
+    if (tcgetattr(m_slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(m_slave, TCSANOW, &tio);
+    }
+
+    if (symlink(name, link.c_str()) != 0) {
+        LOG_ERROR("[Sim] symlink %s -> %s: %s", link.c_str(), name, strerror(errno));
+        return false;
+    }
+    m_link = link;
+    return true;
+}
+
+void C_SimUartDevice::send(const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(m_master, data, len);
+        if (n <= 0) {
+            // Nobody has the slave open (device down): the frame is lost, as on a wire.
+            return;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+void C_SimUartDevice::service() {
+    uint8_t buf[256];
+    for (;;) {
+        ssize_t n = read(m_master, buf, sizeof(buf));
+        if (n <= 0) break;
+        m_in.insert(m_in.end(), buf, buf + n);
+    }
+    if (!m_in.empty()) onInput();
+}
+
+// ---------------------------------------------------------------- RDM6300
+
+void C_SimRDM6300::present(const std::string& tag10) {
+    uint8_t frame[14];
+    frame[0] = 0x02;
+    memcpy(frame + 1, tag10.c_str(), 10);
+    uint8_t sum = 0;
+    for (int i = 0; i < 5; ++i) {
+        char pair[3] = {tag10[i * 2], tag10[i * 2 + 1], '\0'};
+        sum ^= static_cast<uint8_t>(strtol(pair, nullptr, 16));
+    }
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02X", sum);
+    frame[11] = static_cast<uint8_t>(hex[0]);
+    frame[12] = static_cast<uint8_t>(hex[1]);
+    frame[13] = 0x03;
+    send(frame, sizeof(frame));
+}
+
+// ---------------------------------------------------------------- YRM1001
+
+#define SIM_YRM_NOTIFY_MS 10
+
+C_SimYRM1001::C_SimYRM1001(int tags)
+    : m_tags(tags),
+      m_inventory(false),
+      m_next(0),
+      m_lastMs(0),
+      m_powerCentiDbm(2600) {
+}
+
+void C_SimYRM1001::reply(uint8_t cmd, const uint8_t* payload, uint16_t len, uint8_t type) {
+    std::vector<uint8_t> frame;
+    frame.reserve(len + 7u);
+    frame.push_back(0xBB);
+    frame.push_back(type);
+    frame.push_back(cmd);
+    frame.push_back(static_cast<uint8_t>(len >> 8));
+    frame.push_back(static_cast<uint8_t>(len & 0xFF));
+    frame.insert(frame.end(), payload, payload + len);
+    uint8_t sum = 0;
+    for (size_t i = 1; i < frame.size(); ++i) sum += frame[i];
+    frame.push_back(sum);
+    frame.push_back(0x7E);
+    send(frame.data(), frame.size());
+}
+
+void C_SimYRM1001::onInput() {
+    for (;;) {
+        size_t start = 0;
+        while (start < m_in.size() && m_in[start] != 0xBB) ++start;
+        m_in.erase(m_in.begin(), m_in.begin() + static_cast<long>(start));
+        if (m_in.size() < 5) return;
+        size_t total = 7u + ((m_in[3] << 8) | m_in[4]);
+        if (m_in.size() < total) return;
+
+        const uint8_t cmd = m_in[2];
+        const uint8_t ok = 0x00;
+        switch (cmd) {
+            case 0xB6:
+                m_powerCentiDbm = static_cast<uint16_t>((m_in[5] << 8) | m_in[6]);
+                reply(cmd, &ok, 1);
+                break;
+            case 0xB7: {
+                uint8_t power[2] = {static_cast<uint8_t>(m_powerCentiDbm >> 8),
+                                    static_cast<uint8_t>(m_powerCentiDbm & 0xFF)};
+                reply(cmd, power, 2);
+                break;
+            }
+            case 0x0E:
+                reply(cmd, &ok, 1);
+                break;
+            case 0x27:
+                m_inventory = true;
+                m_next = 0;
+                break;
+            case 0x28:
+                m_inventory = false;
+                reply(cmd, &ok, 1);
+                break;
+            default:
+                break;
+        }
+        m_in.erase(m_in.begin(), m_in.begin() + static_cast<long>(total));
+    }
+}
+
+void C_SimYRM1001::tick(int64_t nowMs) {
+    if (!m_inventory || m_tags <= 0 || nowMs - m_lastMs < SIM_YRM_NOTIFY_MS) return;
+    m_lastMs = nowMs;
+
+    // RSSI, PC, 12-byte EPC (tag index in the last bytes), CRC.
+    uint8_t payload[17] = {0xC8, 0x30, 0x00, 0xE2, 0x00, 0x00, 0x00, 0x00, 0x00,
+                           0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    uint32_t index = static_cast<uint32_t>(m_next % m_tags);
+    payload[11] = static_cast<uint8_t>(index >> 24);
+    payload[12] = static_cast<uint8_t>(index >> 16);
+    payload[13] = static_cast<uint8_t>(index >> 8);
+    payload[14] = static_cast<uint8_t>(index);
+    reply(0x22, payload, sizeof(payload), 0x02);
+    ++m_next;
+}
+
+// ---------------------------------------------------------------- fingerprint
+
+C_SimFingerprint::C_SimFingerprint(int userId)
+    : m_userId(userId) {
+}
+
+void C_SimFingerprint::onInput() {
+    for (;;) {
+        size_t start = 0;
+        while (start < m_in.size() && m_in[start] != 0xF5) ++start;
+        m_in.erase(m_in.begin(), m_in.begin() + static_cast<long>(start));
+        if (m_in.size() < 8) return;
+
+        const uint8_t cmd = m_in[1];
+        uint8_t rx[8] = {0xF5, cmd, 0, 0, 0x00, 0, 0, 0xF5};
+        if (cmd == 0x0C) {
+            // Match: user found (Q3 = permission 1).
+            rx[2] = static_cast<uint8_t>(m_userId >> 8);
+            rx[3] = static_cast<uint8_t>(m_userId & 0xFF);
+            rx[4] = 1;
+        }
+        rx[6] = rx[1] ^ rx[2] ^ rx[3] ^ rx[4] ^ rx[5];
+        send(rx, sizeof(rx));
+        m_in.erase(m_in.begin(), m_in.begin() + 8);
+    }
+}
+
+// ---------------------------------------------------------------- SHT30
+
+#define SIM_SHT30_SWING_PERIOD_S 600.0
+
+static uint8_t crc8(const uint8_t* data, size_t len) {
+    // Same CRC-8 as the sensor (poly 0x31, init 0xFF).
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++) crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+    }
+    return crc;
+}
+
+C_SimSHT30::C_SimSHT30(float baseTemp, float swing)
+    : m_baseTemp(baseTemp),
+      m_swing(swing),
+      m_periodic(false),
+      m_periodMs(1000),
+      m_startMs(monotonicMs()),
+      m_lastFetchMs(0) {
+}
+
+void C_SimSHT30::sample(uint8_t* out) const {
+    const double t = (monotonicMs() - m_startMs) / 1000.0;
+    const double phase = 2.0 * M_PI * t / SIM_SHT30_SWING_PERIOD_S;
+    const double temp = m_baseTemp + m_swing * std::sin(phase);
+    const double hum = 45.0 + 5.0 * std::cos(phase);
+
+    const uint16_t rawT = static_cast<uint16_t>((temp + 45.0) / 175.0 * 65535.0);
+    const uint16_t rawH = static_cast<uint16_t>(hum / 100.0 * 65535.0);
+    out[0] = static_cast<uint8_t>(rawT >> 8);
+    out[1] = static_cast<uint8_t>(rawT & 0xFF);
+    out[2] = crc8(out, 2);
+    out[3] = static_cast<uint8_t>(rawH >> 8);
+    out[4] = static_cast<uint8_t>(rawH & 0xFF);
+    out[5] = crc8(out + 3, 2);
+}
+
+bool C_SimSHT30::transfer(uint8_t addr, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) {
+    if (addr != SHT30_ADDR || txLen < 2) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    static const uint16_t PERIODIC_CMDS[] = {0x2032, 0x2130, 0x2236, 0x2334, 0x2737};
+    static const int PERIODIC_MS[] = {2000, 1000, 500, 250, 100};
+
+    const uint16_t cmd = static_cast<uint16_t>((tx[0] << 8) | tx[1]);
+    const int64_t now = monotonicMs();
+
+    if (cmd == 0x3093) {
+        m_periodic = false;
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(PERIODIC_CMDS) / sizeof(PERIODIC_CMDS[0]); ++i) {
+        if (cmd == PERIODIC_CMDS[i]) {
+            m_periodic = true;
+            m_periodMs = PERIODIC_MS[i];
+            m_lastFetchMs = now;
+            return true;
+        }
+    }
+    if (rxLen < 6) return false;
+    if (cmd == 0xE000) {
+        // No new sample since the last fetch: NACK.
+        if (!m_periodic || now - m_lastFetchMs < m_periodMs) return false;
+        m_lastFetchMs = now;
+        sample(rx);
+        return true;
+    }
+    if (cmd == 0x2C06 && !m_periodic) {
+        sample(rx);
+        return true;
+    }
+    return false;
+}
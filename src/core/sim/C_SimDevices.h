@@ -0,0 +1,97 @@
+#ifndef C_SIMDEVICES_H
+#define C_SIMDEVICES_H
+
+/*
+ * Device emulators for the hardware simulation.
+ * UART devices sit on the master side of a pseudo-terminal whose slave is what the
+ * core opens as /dev/ttyAMA<n> (symlink under the simulation root). They answer
+ * the core's commands with the same frames the real modules send. The SHT30 is
+ * an in-process I2C bus model.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "C_I2C.h"
+#include "C_TH_SHT30.h"
+
+class C_SimUartDevice {
+protected:
+    int m_master;
+    int m_slave;                  // Held open so the master never reports a hangup.
+    std::string m_link;
+    std::vector<uint8_t> m_in;    // Bytes written by the core, not yet parsed.
+
+    void send(const uint8_t* data, size_t len);
+    // Parse m_in; consume what was handled.
+    virtual void onInput() {}
+
+public:
+    C_SimUartDevice();
+    virtual ~C_SimUartDevice();
+
+    C_SimUartDevice(const C_SimUartDevice&) = delete;
+    C_SimUartDevice& operator=(const C_SimUartDevice&) = delete;
+
+    // Create the pty and link its slave at 'link' (e.g. <root>/dev/ttyAMA2).
+    bool open(const std::string& link);
+    int fd() const { return m_master; }
+
+    // Drain the master after poll() reported it.
+    void service();
+    // Periodic output (streams); nowMs is CLOCK_MONOTONIC.
+    virtual void tick(int64_t /*nowMs*/) {}
+};
+
+// 125 kHz reader: sends a tag frame when a card is presented.
+class C_SimRDM6300 final : public C_SimUartDevice {
+public:
+    void present(const std::string& tag10);
+};
+
+// UHF reader: power get/set replies and a notification stream during inventory.
+class C_SimYRM1001 final : public C_SimUartDevice {
+    int m_tags;
+    bool m_inventory;
+    int m_next;
+    int64_t m_lastMs;
+    uint16_t m_powerCentiDbm;
+
+    void reply(uint8_t cmd, const uint8_t* payload, uint16_t len, uint8_t type = 0x01);
+    void onInput() override;
+
+public:
+    explicit C_SimYRM1001(int tags);
+    void tick(int64_t nowMs) override;
+};
+
+// Fingerprint module: every match succeeds for the configured user.
+class C_SimFingerprint final : public C_SimUartDevice {
+    int m_userId;
+    void onInput() override;
+
+public:
+    explicit C_SimFingerprint(int userId);
+};
+
+// SHT30 with a slow temperature swing around 'baseTemp' (periodic + single shot).
+class C_SimSHT30 final : public C_I2CSimBus {
+    std::mutex m_mutex;
+    float m_baseTemp;
+    float m_swing;
+    bool m_periodic;
+    int m_periodMs;
+    int64_t m_startMs;
+    int64_t m_lastFetchMs;
+
+    void sample(uint8_t* out) const;
+
+public:
+    C_SimSHT30(float baseTemp, float swing);
+    bool transfer(uint8_t addr, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) override;
+};
+
+#endif
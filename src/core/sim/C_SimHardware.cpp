@@ -0,0 +1,223 @@
+/*
+ * Simulated board: fake sysfs tree, pty devices and the load scenario.
+ */
+
+#include "C_SimHardware.h"
+#include "C_Config.h"
+#include "C_GPIO.h"
+#include "C_I2C.h"
+#include "C_HalPaths.h"
+#include "C_Logger.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <ftw.h>
+#include <poll.h>
+#include <set>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool makeDirs(const std::string& path) {
+    for (size_t pos = 1; pos != std::string::npos; ) {
+        pos = path.find('/', pos + 1);
+        std::string part = path.substr(0, pos);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) {
+            LOG_ERROR("[Sim] mkdir %s: %s", part.c_str(), strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool makeFile(const std::string& path, const char* content) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("[Sim] %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    (void)write(fd, content, strlen(content));
+    close(fd);
+    return true;
+}
+
+static int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+    remove(path);
+    return 0;
+}
+
+C_SimHardware::C_SimHardware(const C_Config& config)
+    : C_Thread(0),
+      m_site(),
+      m_root(config.getString("sim", "root", "")),
+      m_ownsRoot(false),
+      m_intervalMs(config.getInt("sim", "interval_ms", SIM_INTERVAL_MS_DEFAULT)),
+      m_card(config.getString("sim", "card", SIM_CARD_DEFAULT)),
+      m_fingerprint(config.getInt("sim", "user_id", SIM_USER_DEFAULT)),
+      m_uhf(config.getInt("sim", "tags", SIM_TAGS_DEFAULT)),
+      m_sht30(static_cast<float>(config.getDouble("sim", "temp_base", 24.0)),
+              static_cast<float>(config.getDouble("sim", "temp_swing", 3.0))),
+      m_step(0)
+{
+    // Same wiring as the core will build from this configuration.
+    m_site.load(config);
+    if (m_intervalMs < 10) m_intervalMs = 10;
+    if (m_card.size() != 10) m_card = SIM_CARD_DEFAULT;
+}
+
+C_SimHardware::~C_SimHardware() {
+    if (started() && !stopRequested()) {
+        requestStop();
+        join();
+    }
+    C_I2C::setSimBus(nullptr);
+    // Close the ptys (and their links) before removing the tree.
+    m_rfidEntry.clear();
+    m_rfidExit.clear();
+    m_uarts.clear();
+    if (m_ownsRoot && !m_root.empty()) {
+        nftw(m_root.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+}
+
+bool C_SimHardware::setup() {
+    if (m_root.empty()) {
+        char tmpl[] = "/tmp/secureasset-sim.XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            LOG_ERROR("[Sim] mkdtemp: %s", strerror(errno));
+            return false;
+        }
+        m_root = tmpl;
+        m_ownsRoot = true;
+    }
+    if (!buildTree()) return false;
+
+    if (!openUart(m_fingerprint, m_site.vault.fingerprintUart)) return false;
+    if (!openUart(m_uhf, m_site.vault.uhfUart)) return false;
+    for (const S_RoomMap& room : m_site.rooms) {
+        m_rfidEntry.push_back(std::make_unique<C_SimRDM6300>());
+        m_rfidExit.push_back(std::make_unique<C_SimRDM6300>());
+        if (!openUart(*m_rfidEntry.back(), room.rfidEntryUart)) return false;
+        if (!openUart(*m_rfidExit.back(), room.rfidExitUart)) return false;
+    }
+
+    C_I2C::setSimBus(&m_sht30);
+    C_HalPaths::setRoot(m_root);
+    LOG_INFO("[Sim] Hardware simulado em %s (%zu sala(s), evento a cada %d ms)",
+             m_root.c_str(), m_site.rooms.size(), m_intervalMs);
+    return true;
+}
+
+bool C_SimHardware::buildTree() {
+    const std::string gpio = m_root + "/sys/class/gpio";
+    if (!makeDirs(gpio) || !makeDirs(m_root + "/dev")) return false;
+    makeFile(gpio + "/export", "");
+    makeFile(gpio + "/unexport", "");
+    for (int line = 0; line < SIM_GPIO_LINES; ++line) {
+        const std::string dir = gpio + "/gpio" + std::to_string(line + GPIO_BASE);
+        if (!makeDirs(dir)) return false;
+        makeFile(dir + "/direction", "in");
+        makeFile(dir + "/edge", "none");
+        makeFile(dir + "/value", "0");
+    }
+
+    // Every PWM channel used by a door servo.
+    std::set<std::pair<int, int>> channels;
+    for (const S_RoomMap& room : m_site.rooms) channels.insert({room.servoPwmChip, room.servoPwmChannel});
+    channels.insert({m_site.vault.servoPwmChip, m_site.vault.servoPwmChannel});
+    for (const auto& ch : channels) {
+        const std::string chip = m_root + "/sys/class/pwm/pwmchip" + std::to_string(ch.first);
+        const std::string dir = chip + "/pwm" + std::to_string(ch.second);
+        if (!makeDirs(dir)) return false;
+        makeFile(chip + "/export", "");
+        makeFile(chip + "/unexport", "");
+        makeFile(dir + "/period", "0");
+        makeFile(dir + "/duty_cycle", "0");
+        makeFile(dir + "/enable", "0");
+    }
+
+    // Bus node for the startup check; transfers go to the SHT30 model.
+    return makeFile(m_root + "/dev/i2c-" + std::to_string(m_site.i2cBus), "");
+}
+
+bool C_SimHardware::openUart(C_SimUartDevice& dev, int port) {
+    if (!dev.open(m_root + "/dev/ttyAMA" + std::to_string(port))) return false;
+    m_uarts.push_back(&dev);
+    return true;
+}
+
+void C_SimHardware::raise(int sig, int pin) {
+    // What the IRQ module does: an RT signal to the core with the pin as payload.
+    union sigval value;
+    value.sival_int = (pin >= 0) ? pin : 0;
+    if (sigqueue(getpid(), sig, value) != 0) {
+        LOG_RATELIMITED(LOG_LVL_WARN, 5000, "[Sim] sigqueue %d: %s", sig, strerror(errno));
+    }
+}
+
+void C_SimHardware::playStep() {
+    // Per room: entry swipe, door, PIR, vault fingerprint, vault door, exit swipe.
+    static const int STEPS = 6;
+    const size_t r = (m_step / STEPS) % m_site.rooms.size();
+    const S_RoomMap& room = m_site.rooms[r];
+
+    switch (m_step % STEPS) {
+        case 0:
+            m_rfidEntry[r]->present(m_card);
+            raise(47, room.irqPin[IRQ_RFID_ENTRY]);
+            break;
+        case 1:
+            raise(44, room.irqPin[IRQ_ROOM_REED]);
+            break;
+        case 2:
+            raise(45, room.irqPin[IRQ_ROOM_PIR]);
+            break;
+        case 3:
+            raise(46, m_site.vault.fingerprintIrqPin);
+            break;
+        case 4:
+            raise(43, m_site.vault.reedIrqPin);
+            break;
+        default:
+            m_rfidExit[r]->present(m_card);
+            raise(48, room.irqPin[IRQ_RFID_EXIT]);
+            break;
+    }
+    ++m_step;
+}
+
+void C_SimHardware::run() {
+    LOG_INFO("[Sim] Thread iniciada.");
+
+    std::vector<struct pollfd> fds(m_uarts.size());
+    for (size_t i = 0; i < m_uarts.size(); ++i) {
+        fds[i].fd = m_uarts[i]->fd();
+        fds[i].events = POLLIN;
+    }
+
+    int64_t next = monotonicMs() + m_intervalMs;
+    while (!stopRequested()) {
+        // Short slices: the UHF stream and the scenario are paced from here.
+        int ready = poll(fds.data(), fds.size(), 5);
+        for (size_t i = 0; ready > 0 && i < fds.size(); ++i) {
+            if (fds[i].revents & POLLIN) m_uarts[i]->service();
+        }
+
+        const int64_t now = monotonicMs();
+        for (C_SimUartDevice* dev : m_uarts) dev->tick(now);
+        if (now >= next) {
+            playStep();
+            next += m_intervalMs;
+            if (next < now) next = now + m_intervalMs;
+        }
+    }
+
+    LOG_INFO("[Sim] Thread terminada");
+}
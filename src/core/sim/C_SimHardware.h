@@ -0,0 +1,64 @@
+#ifndef C_SIMHARDWARE_H
+#define C_SIMHARDWARE_H
+
+/*
+ * Simulated board for running SecureAssetCore without a Pi ([sim] enabled = 1 or
+ * SECUREASSET_SIM=1).
+ * setup() builds a temporary root with a fake sysfs (GPIO, PWM), an I2C node and
+ * one pty per UART of the site map, and points the HAL at it (C_HalPaths); it must
+ * run before the core is constructed. The thread then serves the device emulators
+ * and plays a load scenario: badge swipes, door/PIR edges and vault access per room
+ * every interval_ms, delivered as the IRQ driver's signals.
+ *
+ * [sim] keys: root, interval_ms, card, user_id, tags, temp_base, temp_swing.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "C_Thread.h"
+#include "C_SiteMap.h"
+#include "C_SimDevices.h"
+
+class C_Config;
+
+#define SIM_INTERVAL_MS_DEFAULT 2000
+#define SIM_CARD_DEFAULT        "0102030405"
+#define SIM_USER_DEFAULT        1
+#define SIM_TAGS_DEFAULT        4
+#define SIM_GPIO_LINES          64
+
+class C_SimHardware : public C_Thread {
+private:
+    C_SiteMap m_site;
+    std::string m_root;
+    bool m_ownsRoot;
+    int m_intervalMs;
+    std::string m_card;
+
+    std::vector<std::unique_ptr<C_SimRDM6300>> m_rfidEntry;
+    std::vector<std::unique_ptr<C_SimRDM6300>> m_rfidExit;
+    C_SimFingerprint m_fingerprint;
+    C_SimYRM1001 m_uhf;
+    C_SimSHT30 m_sht30;
+    std::vector<C_SimUartDevice*> m_uarts;
+
+    unsigned m_step;
+
+    bool buildTree();
+    bool openUart(C_SimUartDevice& dev, int port);
+    void raise(int sig, int pin);
+    void playStep();
+
+public:
+    explicit C_SimHardware(const C_Config& config);
+    ~C_SimHardware() override;
+
+    bool setup();
+    const std::string& root() const { return m_root; }
+
+    void run() override;
+};
+
+#endif
@@ -3,14 +3,18 @@
  */
 
 #include "C_Thread.h"
+#include "C_Logger.h"
 #include <sched.h>      
 #include <cstring>      
 #include <cerrno>
+#include <ctime>
 
-C_Thread::C_Thread(int priority) : m_priority(priority) {
+bool C_Thread::s_realtime = true;
+
+C_Thread::C_Thread(int priority) : m_priority(priority), m_basePriority(priority) {
     pthread_attr_init(&m_attributes);
 
-    if (m_priority > 0) {
+    if (m_priority > 0 && s_realtime) {
         // RT FIFO policy for threads with priority > 0.
         pthread_attr_setschedpolicy(&m_attributes, SCHED_FIFO);
 
@@ -29,9 +33,10 @@ bool C_Thread::start() {
     int result = pthread_create(&m_thread, &m_attributes, internalRun, this );
     
     if (result != 0) {
-        cerr << "[Erro C_Thread] Falha ao criar thread: " << strerror(result) << endl;
+        LOG_ERROR("[Erro C_Thread] Falha ao criar thread: %s", strerror(result));
         return false;
     }
+    m_started = true;
     return true;
 }
 
@@ -53,21 +58,47 @@ C_Thread::~C_Thread() {
 }
 
 void C_Thread::join() {
-    
+    // Threads started late (or never) may still be joined on shutdown.
+    if (!m_started) return;
     pthread_join(m_thread, NULL);
+    m_started = false;
 }
 
 void C_Thread::detach() {
-    
+    if (!m_started) return;
     pthread_detach(m_thread);
+    m_started = false;
 }
 
 void C_Thread::cancel() {
-    
+    if (!m_started) return;
     pthread_cancel(m_thread);
 }
 
 
+bool C_Thread::setPriority(int priority) {
+    if (m_basePriority <= 0 || priority < 1 || priority > 99) return false;
+    if (priority == m_priority) return true;
+    if (!s_realtime) {
+        m_priority = priority;
+        return true;
+    }
+
+    struct sched_param param;
+    param.sched_priority = priority;
+    pthread_attr_setschedparam(&m_attributes, &param);
+
+    if (m_started) {
+        int rc = pthread_setschedparam(m_thread, SCHED_FIFO, &param);
+        if (rc != 0) {
+            LOG_WARN("[C_Thread] Prioridade %d não aplicada: %s", priority, strerror(rc));
+            return false;
+        }
+    }
+    m_priority = priority;
+    return true;
+}
+
 void C_Thread::requestStop() {
     // Atomic flag checked in thread loops.
     m_stopRequested.store(true, std::memory_order_relaxed);
@@ -76,3 +107,11 @@ void C_Thread::requestStop() {
 bool C_Thread::stopRequested() const {
     return m_stopRequested.load(std::memory_order_relaxed);
 }
+
+uint32_t C_Thread::sinceEdgeUs(uint64_t edgeNs) {
+    if (edgeNs == 0) return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t nowNs = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    return (nowNs > edgeNs) ? static_cast<uint32_t>((nowNs - edgeNs) / 1000ULL) : 0;
+}
@@ -8,6 +8,7 @@
 #include <pthread.h>
 #include <iostream>
 #include <atomic>
+#include <cstdint>
 
 using namespace std;
 
@@ -16,9 +17,16 @@ class C_Thread {
     pthread_t m_thread;           
     pthread_attr_t m_attributes;  
     int m_priority;               
+    int m_basePriority;           // Priority class given at construction.
     std::atomic<bool> m_stopRequested{false};
+    bool m_started{false};
 
     static void* internalRun(void* arg);
+    static bool s_realtime;
+
+protected:
+    // Time since an input edge (CLOCK_MONOTONIC ns from the event); 0 if unknown.
+    static uint32_t sinceEdgeUs(uint64_t edgeNs);
 
 public:
     C_Thread(int priority = 0);
@@ -29,6 +37,13 @@ public:
     void cancel();
     void requestStop();
     bool stopRequested() const;
+    bool started() const { return m_started; }
+    int basePriority() const { return m_basePriority; }
+    // RT FIFO priority; applied to the running thread if already started.
+    bool setPriority(int priority);
+    // Process-wide switch for SCHED_FIFO (off: priorities are recorded only).
+    // Set before threads are constructed.
+    static void setRealtime(bool enabled) { s_realtime = enabled; }
     virtual void run() = 0;
 };
 
@@ -4,8 +4,9 @@
 
 #include "C_tAct.h"
 #include "C_Mqueue.h"
+#include "C_Outbox.h"
 #include "C_Actuator.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <cstdio>
 #include <ctime>
 #include <cstring>
@@ -16,29 +17,35 @@ using namespace std;
 static constexpr const char* MODULE_NAME = "[tAct]";
 
 C_tAct::C_tAct(C_Mqueue& mqIn,
-               C_Mqueue& mqOut,
-               const std::array<C_Actuator*, ID_ACTUATOR_COUNT>& listaAtuadores)
+               C_Outbox& outbox,
+               const std::vector<S_ActuatorSlot>& listaAtuadores)
     : C_Thread(PRIO_HIGH), 
       m_mqToActuator(mqIn),
-      m_mqToDatabase(mqOut),
+      m_outbox(outbox),
       m_actuators(listaAtuadores),
-      m_alarmTimerId(0) 
+      m_alarmTimerId(0),
+      m_alarmSeconds(ALARM_SECONDS_DEFAULT)
 {
-    // Check which actuators are wired/configured.
-    size_t count = 0;
-    for (size_t i = 0; i < m_actuators.size(); ++i) {
-        if (m_actuators[i] != nullptr) {
-            ++count;
-        } else {
-            cerr << MODULE_NAME << " AVISO: Atuador " << i
-                 << " não configurado" << endl;
+    // Check which actuator types are wired/configured.
+    for (int id = 0; id < ID_ACTUATOR_COUNT; ++id) {
+        bool found = false;
+        for (const S_ActuatorSlot& slot : m_actuators) {
+            if (slot.id == id && slot.actuator != nullptr) found = true;
+        }
+        if (!found) {
+            LOG_WARN("%s AVISO: Atuador %s não configurado", MODULE_NAME, ACTUATOR_NAMES[id]);
         }
     }
 
     initTimer();
 
-    cout << MODULE_NAME << " Thread criada (Prio " << PRIO_HIGH << ")"
-         << ". Atuadores: " << count << "/" << m_actuators.size() << endl;
+    LOG_INFO("%s Thread criada (Prio %d). Atuadores: %zu", MODULE_NAME, static_cast<int>(PRIO_HIGH), m_actuators.size());
+}
+
+void C_tAct::setAlarmSeconds(int seconds) {
+    if (seconds < 1) seconds = 1;
+    m_alarmSeconds.store(seconds);
+    LOG_INFO("%s Alarme desliga após %d s", MODULE_NAME, seconds);
 }
 
 C_tAct::~C_tAct() {
@@ -59,7 +66,7 @@ void C_tAct::initTimer() {
     sev.sigev_notify_attributes = nullptr;
 
     if (timer_create(CLOCK_MONOTONIC, &sev, &m_alarmTimerId) == -1) {
-        cerr << MODULE_NAME << " ERRO CRÍTICO: Falha ao criar timer POSIX!" << endl;
+        LOG_ERROR("%s ERRO CRÍTICO: Falha ao criar timer POSIX!", MODULE_NAME);
     }
 }
 
@@ -68,7 +75,7 @@ void C_tAct::alarmTimerCallback(union sigval sv) {
     C_tAct* self = static_cast<C_tAct*>(sv.sival_ptr);
 
     if (self) {
-        cout << "[tAct-Timer] Tempo esgotado! A enviar comando OFF..." << endl;
+        LOG_INFO("[tAct-Timer] Tempo esgotado! A enviar comando OFF...");
 
         // Turn off the alarm after timeout.
         ActuatorCmd cmd;
@@ -90,9 +97,9 @@ void C_tAct::startAlarmTimer(int seconds) {
     its.it_interval.tv_nsec = 0;
 
     if (timer_settime(m_alarmTimerId, 0, &its, nullptr) == -1) {
-        cerr << MODULE_NAME << " ERRO ao armar timer" << endl;
+        LOG_ERROR("%s ERRO ao armar timer", MODULE_NAME);
     } else {
-        cout << MODULE_NAME << " Timer armado para " << seconds << "s" << endl;
+        LOG_INFO("%s Timer armado para %ds", MODULE_NAME, seconds);
     }
 }
 
@@ -108,7 +115,7 @@ void C_tAct::stopAlarmTimer() {
 }
 
 void C_tAct::run() {
-    cout << MODULE_NAME << " Iniciada..." << endl;
+    LOG_INFO("%s Iniciada...", MODULE_NAME);
     ActuatorCmd msg;
 
     while (!stopRequested()) {
@@ -125,30 +132,31 @@ void C_tAct::run() {
                 break;
             }
         } else {
-            cerr << MODULE_NAME << " AVISO: Mensagem corrompida (" << bytes << " bytes)" << endl;
+            LOG_WARN("%s AVISO: Mensagem corrompida (%zd bytes)", MODULE_NAME, bytes);
         }
     }
     stopAlarmTimer();
 
-    cout << MODULE_NAME << " Terminada" << endl;
+    LOG_INFO("%s Terminada", MODULE_NAME);
 }
 
 void C_tAct::processMessage(const ActuatorCmd& msg) {
     
     // Basic ID validation.
     if (!isValidActuatorID(msg.actuatorID)) {
-        cerr << MODULE_NAME << " ERRO: ID inválido " << static_cast<int>(msg.actuatorID) << endl;
+        LOG_ERROR("%s ERRO: ID inválido %d", MODULE_NAME, static_cast<int>(msg.actuatorID));
         return;
     }
 
-    C_Actuator* actuator = m_actuators[msg.actuatorID];
+    C_Actuator* actuator = findActuator(msg);
     if (!actuator) {
-        cerr << MODULE_NAME << " ERRO: Atuador não inicializado" << endl;
+        LOG_ERROR("%s ERRO: Atuador %s/%u não inicializado", MODULE_NAME,
+                  ACTUATOR_NAMES[msg.actuatorID], static_cast<unsigned>(msg.unitId));
         return;
     }
 
-    cout << MODULE_NAME << " Comando: " << ACTUATOR_NAMES[msg.actuatorID]
-         << " -> " << static_cast<int>(msg.value) << endl;
+    LOG_INFO("%s Comando: %s[%u] -> %d", MODULE_NAME, ACTUATOR_NAMES[msg.actuatorID],
+             static_cast<unsigned>(msg.unitId), static_cast<int>(msg.value));
 
     // Execute the command on the concrete actuator.
     bool sucesso = actuator->set_value(msg.value);
@@ -156,7 +164,7 @@ void C_tAct::processMessage(const ActuatorCmd& msg) {
     if (sucesso && msg.actuatorID == ID_ALARM_ACTUATOR) {
         if (msg.value == 1) {
             // Alarm active: arm auto-off timer.
-            startAlarmTimer(30);
+            startAlarmTimer(m_alarmSeconds.load());
         } else {
             // Alarm manually disabled: cancel timer.
             stopAlarmTimer();
@@ -165,71 +173,43 @@ void C_tAct::processMessage(const ActuatorCmd& msg) {
 
     // Log actuation event.
     if (sucesso) {
-        sendLog(msg.actuatorID, msg.value);
+        sendLog(msg.actuatorID, msg.value, msg.unitId);
     } else {
-        cerr << MODULE_NAME << " FALHA Hardware: " << ACTUATOR_NAMES[msg.actuatorID] << endl;
+        LOG_ERROR("%s FALHA Hardware: %s", MODULE_NAME, ACTUATOR_NAMES[msg.actuatorID]);
     }
 }
 
 
 
 
-void C_tAct::generateDescription(ActuatorID_enum id,
-                                uint8_t value,
-                                char* buffer,
-                                size_t size)
-{
-    if (!buffer || size == 0) return;
-
-    // UI-friendly descriptions.
-
-    switch (id) {
-        case ID_SERVO_ROOM:
-        case ID_SERVO_VAULT:
-            if (value == 0) {
-                snprintf(buffer, size, "Porta LIVRE (PWM OFF)");
-            } else {
-                snprintf(buffer, size, "Porta TRANCADA (%d°)", value);
-            }
-            break;
-
-        case ID_FAN:
-            snprintf(buffer, size, "Ventoinha %s",
-                    (value > 0) ? "LIGADA" : "DESLIGADA");
-            break;
-
-        case ID_ALARM_ACTUATOR:
-            snprintf(buffer, size, "Alarme %s",
-                    (value > 0) ? "ATIVADO" : "DESATIVADO");
-            break;
-
-        default:
-            snprintf(buffer, size, "Atuador %d Val %d", static_cast<int>(id), value);
+C_Actuator* C_tAct::findActuator(const ActuatorCmd& msg) const {
+    // Site-wide actuators ignore unitId; unitId 0 selects the first door.
+    bool perUnit = (msg.actuatorID == ID_SERVO_ROOM || msg.actuatorID == ID_SERVO_VAULT);
+    for (const S_ActuatorSlot& slot : m_actuators) {
+        if (slot.id != msg.actuatorID) continue;
+        if (!perUnit || msg.unitId == 0 || slot.unitId == msg.unitId) return slot.actuator;
     }
-
-    buffer[size - 1] = '\0';
+    return nullptr;
 }
 
-
-
-
-void C_tAct::sendLog(ActuatorID_enum id, uint8_t value) {
+void C_tAct::sendLog(ActuatorID_enum id, uint8_t value, uint16_t unitId) {
     
     DatabaseMsg msg = {};
     msg.command = DB_CMD_WRITE_LOG; 
+    msg.roomId = (id == ID_SERVO_ROOM) ? unitId : 0;
+    msg.vaultId = (id == ID_SERVO_VAULT) ? unitId : 0;
 
     // Actuation log (current state).
     msg.payload.log.logType = LOG_TYPE_ACTUATOR;
+    msg.payload.log.eventCode = EVT_ACTUATOR_STATE;
     msg.payload.log.entityID = static_cast<uint8_t>(id);
     msg.payload.log.value = static_cast<double>(value);
     msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
 
-    generateDescription(id, value, msg.payload.log.description, sizeof(msg.payload.log.description));
-
     
-    bool enviado = m_mqToDatabase.send(&msg, sizeof(DatabaseMsg), 0);
+    bool enviado = m_outbox.post(msg);
 
     if (!enviado) {
-        cerr << MODULE_NAME << " ERRO ao enviar log (DatabaseMsg)" << endl;
+        LOG_ERROR("%s ERRO ao enviar log (DatabaseMsg)", MODULE_NAME);
     }
 }
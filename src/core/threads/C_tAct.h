@@ -7,41 +7,52 @@
 
 #include "C_Thread.h"
 #include "SharedTypes.h"
-#include <array>
+#include <atomic>
+#include <vector>
 #include <signal.h>  
 #include <time.h>    
 
+#define ALARM_SECONDS_DEFAULT  30
+
 class C_Mqueue;
+class C_Outbox;
 class C_Actuator;
 
+// Door servos exist once per room/vault (unitId); fan and alarm are site-wide.
+struct S_ActuatorSlot {
+    ActuatorID_enum id;
+    uint16_t unitId;
+    C_Actuator* actuator;
+};
+
 class C_tAct : public C_Thread {
 private:
     C_Mqueue& m_mqToActuator;
-    C_Mqueue& m_mqToDatabase;
-    std::array<C_Actuator*, ID_ACTUATOR_COUNT> m_actuators;
+    C_Outbox& m_outbox;
+    std::vector<S_ActuatorSlot> m_actuators;
 
     timer_t m_alarmTimerId;
+    // Alarm auto-off delay; changed live by the configuration.
+    std::atomic<int> m_alarmSeconds;
 
 public:
     C_tAct(C_Mqueue& mqIn,
-           C_Mqueue& mqOut,
-           const std::array<C_Actuator*, ID_ACTUATOR_COUNT>& listaAtuadores);
+           C_Outbox& outbox,
+           const std::vector<S_ActuatorSlot>& listaAtuadores);
 
     ~C_tAct() override;
 
     void run() override;
+    void setAlarmSeconds(int seconds);
 
 private:
     void processMessage(const ActuatorCmd& msg);
-    void sendLog(ActuatorID_enum id, uint8_t value);
+    C_Actuator* findActuator(const ActuatorCmd& msg) const;
+    void sendLog(ActuatorID_enum id, uint8_t value, uint16_t unitId);
     void initTimer();
     void startAlarmTimer(int seconds);
     void stopAlarmTimer();
     static void alarmTimerCallback(union sigval sv);
-    static void generateDescription(ActuatorID_enum id,
-                                   uint8_t value,
-                                   char* buffer,
-                                   size_t size);
 
     bool isValidActuatorID(ActuatorID_enum id) const {
         return id < ID_ACTUATOR_COUNT;
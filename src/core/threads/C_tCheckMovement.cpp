@@ -1,87 +1,116 @@
 /*
- * Flow: wait for PIR -> ask DB if users are present -> alarm/log.
+ * Flow: wait for PIR of any room -> check in-memory occupancy -> alarm/log.
  */
 
 #include "C_tCheckMovement.h"
-#include <iostream>
-#include <cerrno>
+#include "C_Logger.h"
+#include <ctime>
 
-C_tCheckMovement::C_tCheckMovement(C_Mqueue& m_mqToCheckMovement, C_Mqueue& m_mqToDatabase,C_Mqueue& m_mqToActuator,C_Monitor& m_monitor)
-    : C_Thread(PRIO_MEDIUM), m_monitor(m_monitor),
-      m_mqToActuator(m_mqToActuator),
+static int64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+C_tCheckMovement::C_tCheckMovement(C_Mqueue& m_mqToCheckMovement, C_Mqueue& m_mqToDatabase, C_UnitEvents& events, const std::vector<C_Room*>& rooms, C_RuleEngine& rules)
+    : C_Thread(PRIO_MEDIUM),
+      m_mqToCheckMovement(m_mqToCheckMovement),
       m_mqToDatabase(m_mqToDatabase),
-      m_mqToCheckMovement(m_mqToCheckMovement)
+      m_events(events),
+      m_rooms(rooms),
+      m_rules(rules),
+      m_seeded(0),
+      m_allRooms(0),
+      m_seedAttempts(0),
+      m_nextSeedMs(0)
 {
+    for (const C_Room* room : m_rooms) m_allRooms |= 1u << room->index();
 }
 
-void C_tCheckMovement::run() {
+void C_tCheckMovement::requestSeeds(int64_t nowMs) {
+    // Load of the persisted occupancy (IsInside) after a restart, retried until the DB answers.
+    m_nextSeedMs = nowMs + OCCUPANCY_SEED_RETRY_MS;
+    bool giveUp = (++m_seedAttempts > OCCUPANCY_SEED_ATTEMPTS);
 
-    while (!stopRequested()) {
+    for (C_Room* room : m_rooms) {
+        if (m_seeded & (1u << room->index())) continue;
 
-        // Wait for PIR event via monitor.
-        if (m_monitor.timedWait(1)) {
+        if (giveUp) {
+            LOG_WARN("[CheckMovement] AVISO: BD não respondeu, ocupação inicial de %s = 0", room->name());
+            m_seeded |= 1u << room->index();
             continue;
         }
 
-        // Ask DB if there is a user inside the room.
         DatabaseMsg msg = {};
         msg.command = DB_CMD_USER_IN_PIR;
-        m_mqToDatabase.send(&msg, sizeof(msg));
+        msg.roomId = room->id();
+        if (!m_mqToDatabase.trySend(&msg, sizeof(msg))) {
+            LOG_RATELIMITED(LOG_LVL_WARN, 10000, "[CheckMovement] AVISO: BD indisponível, ocupação de %s por carregar", room->name());
+        }
+    }
+}
 
-        AuthResponse resp = {};
-        
-        while (!stopRequested()) {
+void C_tCheckMovement::takeSeedReplies() {
+    // Replies to a retried request (or after giving up) are stale: only the first one seeds.
+    AuthResponse resp = {};
+    while (m_mqToCheckMovement.timedReceive(&resp, sizeof(resp), 0) > 0) {
+        if (resp.command != DB_CMD_USER_IN_PIR) continue;
 
-            ssize_t bytes = m_mqToCheckMovement.timedReceive(&resp, sizeof(resp), 1);
+        for (C_Room* room : m_rooms) {
+            if (room->id() != resp.roomId) continue;
+            if (m_seeded & (1u << room->index())) {
+                LOG_DEBUG("[CheckMovement] Resposta de ocupação repetida de %s ignorada", room->name());
+                break;
+            }
+            room->occupancy().seed(resp.payload.occupancy);
+            m_seeded |= 1u << room->index();
+            LOG_INFO("[CheckMovement] Ocupação inicial de %s: %u", room->name(), room->occupancy().count());
+            break;
+        }
+    }
+}
 
-            if (bytes > 0) {
-                // DB replied: authorized vs. unauthorized.
-                if (!resp.payload.auth.authorized) {
-                    std::cout << "[ALERTA] Movimento NÃO autorizado! ATIVANDO ALARME." << std::endl;
+void C_tCheckMovement::run() {
 
-                    ActuatorCmd alarm = {ID_ALARM_ACTUATOR, 1};
-                    m_mqToActuator.send(&alarm, sizeof(alarm));
+    requestSeeds(monotonicMs());
 
-                    sendLog(false);
-                } else {
-                    std::cout << "[CheckMovement] Movimento autorizado: Utilizadores presentes." << std::endl;
-                }
+    while (!stopRequested()) {
 
-                // Exit wait after response.
-                break;
-            }
-            if (bytes < 0 && errno == ETIMEDOUT) {
+        // Wait for PIR events of any room.
+        uint64_t edgesNs[UNIT_EVENTS_BITS];
+        uint32_t events = m_events.take(1, edgesNs);
 
-                std::cout << "[CheckMovement] DB ainda não respondeu... a tentar ler a fila novamente." << std::endl;
-                continue;
-            }
-            else {
-                // Unexpected queue error.
-                std::cerr << "[CheckMovement] Erro crítico na Message Queue. A sair da espera." << std::endl;
-                break;
-            }
+        takeSeedReplies();
+        if (m_seeded != m_allRooms && monotonicMs() >= m_nextSeedMs) {
+            requestSeeds(monotonicMs());
         }
 
-    }
-
-    std::cout << "[CheckMovement] Thread terminada com sucesso." << std::endl;
-}
+        if (events == 0) {
+            continue;
+        }
 
-void C_tCheckMovement::sendLog(bool authorized) {
-    DatabaseMsg msg = {};
-    msg.command = DB_CMD_WRITE_LOG;
-    msg.payload.log.logType = authorized ? LOG_TYPE_ACCESS : LOG_TYPE_ALERT;
-    msg.payload.log.entityID = 0; 
-    msg.payload.log.value = authorized ? 1.0 : 0.0;
-    msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
+        for (C_Room* room : m_rooms) {
+            if (!C_UnitEvents::has(events, room->index())) continue;
 
-    generateDescription(authorized, msg.payload.log.description, sizeof(msg.payload.log.description));
+            // Nobody known inside yet, but the DB count is still loading: no alarm.
+            if (!(m_seeded & (1u << room->index())) && room->occupancy().isEmpty()) {
+                LOG_RATELIMITED(LOG_LVL_WARN, 10000, "[CheckMovement] %s: movimento com ocupação por carregar, alarme suspenso", room->name());
+                continue;
+            }
 
-    m_mqToDatabase.send(&msg, sizeof(DatabaseMsg));
-}
+            // Occupancy is kept by the access threads; the alarm reaction is a rule.
+            if (room->occupancy().isEmpty()) {
+                LOG_WARN("[ALERTA] %s: movimento NÃO autorizado! (%u us após o PIR)", room->name(),
+                         sinceEdgeUs(C_UnitEvents::edgeOf(edgesNs, room->index())));
+            } else {
+                // PIR retriggers constantly while people are inside.
+                LOG_RATELIMITED(LOG_LVL_INFO, 10000, "[CheckMovement] %s: movimento autorizado: %u utilizadores presentes.",
+                                room->name(), room->occupancy().count());
+            }
 
-void C_tCheckMovement::generateDescription(bool authorized, char* buffer, size_t size) {
-    if (!authorized) {
-        snprintf(buffer, size, "ALERTA: Movimento detetado em sala VAZIA!");
+            m_rules.fire(REVT_PIR, 0.0, 0.0, room->id());
+        }
     }
+
+    LOG_INFO("[CheckMovement] Thread terminada com sucesso.");
 }
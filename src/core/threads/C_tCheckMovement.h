@@ -1,26 +1,42 @@
 #ifndef _C_TCHECKMOVEMENT_H_
 #define _C_TCHECKMOVEMENT_H_
 /*
- * PIR movement thread: validates active user and triggers alarm if needed.
+ * PIR movement thread: checks in-memory occupancy of the room and triggers alarm if needed.
+ * The persisted occupancy is loaded from the DB without blocking the PIR loop;
+ * an empty-room alarm waits until the room's count has been loaded.
  */
-#include "C_Monitor.h"
+#include <cstdint>
+#include <vector>
+
+#include "C_UnitEvents.h"
 #include "C_Thread.h"
 #include "SharedTypes.h"
 #include "C_Mqueue.h"
+#include "C_Room.h"
+#include "C_RuleEngine.h"
+
+// Occupancy load: retry period and attempts before assuming an empty room.
+#define OCCUPANCY_SEED_RETRY_MS  5000
+#define OCCUPANCY_SEED_ATTEMPTS  6
 
 class C_tCheckMovement : public C_Thread{
 public:
-    C_tCheckMovement(C_Mqueue& m_mqToCheckMovement, C_Mqueue& m_mqToDatabase,C_Mqueue& m_mqToActuator,C_Monitor& m_monitor);
+    C_tCheckMovement(C_Mqueue& m_mqToCheckMovement, C_Mqueue& m_mqToDatabase, C_UnitEvents& events, const std::vector<C_Room*>& rooms, C_RuleEngine& rules);
     ~C_tCheckMovement() override = default;
     void run() override;
 
 private:
-    void sendLog(bool authorized);
-    void generateDescription(bool authorized, char* buffer, size_t size);
+    void requestSeeds(int64_t nowMs);
+    void takeSeedReplies();
     C_Mqueue& m_mqToCheckMovement;
     C_Mqueue& m_mqToDatabase;
-    C_Mqueue& m_mqToActuator;
-    C_Monitor& m_monitor;
+    C_UnitEvents& m_events;
+    std::vector<C_Room*> m_rooms;
+    C_RuleEngine& m_rules;
+    uint32_t m_seeded;          // One bit per room index: occupancy loaded.
+    uint32_t m_allRooms;
+    int m_seedAttempts;
+    int64_t m_nextSeedMs;
 
 };
 
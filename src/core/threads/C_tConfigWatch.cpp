@@ -0,0 +1,22 @@
+/*
+ * Flow: wait for inotify (1 s ticks) -> reload -> notify changed subsystems.
+ */
+
+#include "C_tConfigWatch.h"
+#include "C_Logger.h"
+
+C_tConfigWatch::C_tConfigWatch(C_ConfigWatch& watch)
+    : C_Thread(PRIO_LOW),
+      m_watch(watch)
+{
+}
+
+void C_tConfigWatch::run() {
+    LOG_INFO("[ConfigWatch] Thread iniciada (%s).", m_watch.path().c_str());
+
+    while (!stopRequested()) {
+        m_watch.poll(1000);
+    }
+
+    LOG_INFO("[ConfigWatch] Thread terminada");
+}
@@ -0,0 +1,23 @@
+#ifndef C_TCONFIGWATCH_H
+#define C_TCONFIGWATCH_H
+
+/*
+ * Configuration reload thread: applies safe changes to the running core.
+ */
+
+#include "C_Thread.h"
+#include "C_ConfigWatch.h"
+#include "SharedTypes.h"
+
+class C_tConfigWatch : public C_Thread {
+private:
+    C_ConfigWatch& m_watch;
+
+public:
+    explicit C_tConfigWatch(C_ConfigWatch& watch);
+    ~C_tConfigWatch() override = default;
+
+    void run() override;
+};
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Flow: wait (exponential backoff) -> retry pending devices -> exit when all are up.
+ */
+
+#include "C_tDeviceRetry.h"
+#include "C_Logger.h"
+#include <ctime>
+
+static constexpr int RETRY_FIRST_S = 2;
+static constexpr int RETRY_MAX_S = 60;
+
+C_tDeviceRetry::C_tDeviceRetry(C_DeviceInit& devices)
+    : C_Thread(PRIO_LOW),
+      m_devices(devices)
+{
+}
+
+void C_tDeviceRetry::run() {
+    LOG_INFO("[DeviceRetry] Thread iniciada (%u dispositivos em falta).", m_devices.pending());
+
+    int backoff = RETRY_FIRST_S;
+    int waited = 0;
+
+    while (!stopRequested()) {
+        // 1 s ticks keep shutdown responsive during long backoffs.
+        struct timespec ts = {1, 0};
+        nanosleep(&ts, nullptr);
+        if (++waited < backoff) continue;
+        waited = 0;
+
+        if (m_devices.retryPending() == 0) {
+            LOG_INFO("[DeviceRetry] Todos os dispositivos disponíveis.");
+            break;
+        }
+        backoff = (backoff * 2 > RETRY_MAX_S) ? RETRY_MAX_S : backoff * 2;
+    }
+
+    LOG_INFO("[DeviceRetry] Thread terminada.");
+}
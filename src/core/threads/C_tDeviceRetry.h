@@ -0,0 +1,23 @@
+#ifndef C_TDEVICERETRY_H
+#define C_TDEVICERETRY_H
+
+/*
+ * Background bring-up of non-critical devices that failed at startup.
+ */
+
+#include "C_Thread.h"
+#include "C_DeviceInit.h"
+#include "SharedTypes.h"
+
+class C_tDeviceRetry : public C_Thread {
+private:
+    C_DeviceInit& m_devices;
+
+public:
+    explicit C_tDeviceRetry(C_DeviceInit& devices);
+    ~C_tDeviceRetry() override = default;
+
+    void run() override;
+};
+
+#endif
@@ -3,61 +3,242 @@
  */
 
 #include "C_tInventoryScan.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <cstring>
 #include <ctime>
 
-C_tInventoryScan::C_tInventoryScan(C_Monitor& m_monitorservovault, C_YRM1001& m_rfidInventoy, C_Mqueue& m_mqToDatabase)
+static int64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+C_tInventoryScan::C_tInventoryScan(C_Monitor& m_monitorservovault, C_YRM1001& m_rfidInventoy, C_Outbox& outbox,
+                                   C_Mqueue& mqToDatabase, C_Mqueue& mqFromDatabase, C_PowerPolicy& power, const S_VaultMap& vault)
     : C_Thread(PRIO_LOW), m_monitorservovault(m_monitorservovault),
       m_rfidInventoy(m_rfidInventoy),
-      m_mqToDatabase(m_mqToDatabase)
+      m_outbox(outbox),
+      m_mqToDatabase(mqToDatabase),
+      m_mqFromDatabase(mqFromDatabase),
+      m_power(power),
+      m_vaultId(vault.id),
+      m_roomId(vault.roomId),
+      m_lastSession(0),
+      m_backgroundMs(vault.uhfBackgroundMs),
+      m_nextBackgroundMs(0),
+      m_presence(vault.uhfMissingMs),
+      m_reedSeen(0),
+      m_seeded(vault.uhfBackgroundMs <= 0),
+      m_silentRound(false),
+      m_seedRequest(0),
+      m_seedBatches(0),
+      m_seedAttempts(0),
+      m_nextSeedMs(0)
 {
 }
 
-void C_tInventoryScan::run() {
-    std::cout << "[InventoryScan] Thread iniciada. Monitorizando cofre..." << std::endl;
+uint32_t C_tInventoryScan::nextSessionId() {
+    // Wall-clock seconds keep IDs increasing across restarts; bumped if two scans share one.
+    uint32_t id = static_cast<uint32_t>(time(nullptr));
+    if (id <= m_lastSession) id = m_lastSession + 1;
+    m_lastSession = id;
+    return id;
+}
 
-    while (!stopRequested()) {
-        // Wait for vault reed switch event.
-        if (m_monitorservovault.timedWait(1)) {
+void C_tInventoryScan::requestSeed(int64_t nowMs) {
+    // Tags present before the restart, retried until the DB answers.
+    m_nextSeedMs = nowMs + PRESENCE_SEED_RETRY_MS;
+    if (++m_seedAttempts > PRESENCE_SEED_ATTEMPTS) {
+        LOG_WARN("[InventoryScan] AVISO: BD não respondeu, primeira ronda de fundo sem alertas");
+        m_seeded = true;
+        m_silentRound = true;
+        return;
+    }
+
+    DatabaseMsg msg = {};
+    msg.command = DB_CMD_GET_PRESENT_TAGS;
+    msg.roomId = m_roomId;
+    msg.vaultId = m_vaultId;
+    msg.payload.requestId = ++m_seedRequest;
+    m_seedBatches = 0;
+    if (!m_mqToDatabase.trySend(&msg, sizeof(msg))) {
+        LOG_RATELIMITED(LOG_LVL_WARN, 10000, "[InventoryScan] AVISO: BD indisponível, presenças por carregar");
+    }
+}
+
+void C_tInventoryScan::takeSeedReplies() {
+    // Replies to an older request, or after a lost batch, wait for the retry.
+    AuthResponse resp = {};
+    int64_t now = monotonicMs();
+    while (m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 0) > 0) {
+        const Data_PresentTags& reply = resp.payload.presentTags;
+        if (m_seeded || resp.command != DB_CMD_GET_PRESENT_TAGS ||
+            reply.requestId != m_seedRequest || reply.batchIndex != m_seedBatches) {
             continue;
         }
-        std::cout << "[InventoryScan] pia.." << std::endl;
 
-        SensorData data = {};
+        uint16_t count = (reply.tagCount > PRESENT_TAGS_PER_REPLY) ? PRESENT_TAGS_PER_REPLY : reply.tagCount;
+        for (uint16_t i = 0; i < count; ++i) {
+            m_presence.seed(reply.epc[i], now);
+        }
+        ++m_seedBatches;
+        if (reply.last) {
+            m_seeded = true;
+            LOG_INFO("[InventoryScan] Presença inicial: %zu tags no cofre", m_presence.presentCount());
+        }
+    }
+}
+
+void C_tInventoryScan::run() {
+    LOG_INFO("[InventoryScan] Thread iniciada. Monitorizando cofre...");
+    m_reedSeen = m_monitorservovault.generation();
+    if (!m_seeded) requestSeed(monotonicMs());
 
-        // Read inventory (tag list) from the YRM1001 reader.
-        if (m_rfidInventoy.read(&data)) {
-            DatabaseMsg msg = {};
-            msg.command = DB_CMD_UPDATE_ASSET;
-            msg.payload.rfidInventory.tagCount = data.data.rfid_inventory.tagCount;
+    while (!stopRequested()) {
+        // Pre-power/configure the reader while the vault is open.
+        PreWakeAction_enum preWake = m_power.poll(PREWAKE_UHF);
+        if (preWake == PREWAKE_WAKE) {
+            LOG_INFO("[InventoryScan] Pre-wake do leitor UHF");
+            m_rfidInventoy.prepare();
+        } else if (preWake == PREWAKE_SLEEP) {
+            m_rfidInventoy.release();
+        } else if (!m_power.active(PREWAKE_UHF)) {
+            // No pre-wake pending: a warm reader sleeps on its own timer.
+            m_rfidInventoy.powerDownIfIdle();
+        }
 
-            for(int i = 0; i < data.data.rfid_inventory.tagCount; ++i) {
-                strncpy(msg.payload.rfidInventory.tagList[i],
-                        data.data.rfid_inventory.tagList[i], 31);
-                msg.payload.rfidInventory.tagList[i][31] = '\0';
+        // Wait for vault reed switch event; one raised during a round or scan is kept.
+        if (m_monitorservovault.timedWait(1, m_reedSeen)) {
+            if (m_backgroundMs <= 0) continue;
+            takeSeedReplies();
+            if (!m_seeded && monotonicMs() >= m_nextSeedMs) {
+                requestSeed(monotonicMs());
             }
-            m_mqToDatabase.send(&msg, sizeof(DatabaseMsg));
-            sendLog(data.data.rfid_inventory.tagCount);
+            // A pending pre-wake means the vault is about to be used: leave the reader to it.
+            if (m_seeded && monotonicMs() >= m_nextBackgroundMs &&
+                !m_power.active(PREWAKE_UHF)) {
+                backgroundRound();
+            }
+            continue;
         }
+        LOG_DEBUG("[InventoryScan] Cofre fechado: inventário (%u us após o reed)",
+                  sinceEdgeUs(m_monitorservovault.edgeNs()));
+
+        scanSession();
+        // The scan used the reader (powered off unless kept warm); the grant is spent.
+        m_power.release(PREWAKE_UHF);
     }
 }
 
-void C_tInventoryScan::generateDescription(int count, char* buffer, size_t size) {
-    // Audit message for inventory.
-    snprintf(buffer, size, "LEITURA INVENTÁRIO: %d itens confirmados após fecho", count);
+void C_tInventoryScan::scanSession() {
+    DatabaseMsg batch = {};
+    batch.command = DB_CMD_UPDATE_ASSET;
+    batch.roomId = m_roomId;
+    batch.vaultId = m_vaultId;
+    Data_RFID_Inventory& inv = batch.payload.rfidInventory;
+    inv.sessionId = nextSessionId();
+    inv.startedAt = static_cast<uint32_t>(time(nullptr));
+
+    // Batches leave while the reader is still running; the DB applies them as they come.
+    uint16_t batches = 0;
+    auto flush = [&]() {
+        inv.batchIndex = batches++;
+        m_outbox.post(batch);
+        inv.tagCount = 0;
+        memset(inv.tagList, 0, sizeof(inv.tagList));
+    };
+
+    // The session already records every tag read: presence is updated quietly.
+    int64_t now = monotonicMs();
+    int found = m_rfidInventoy.scan([&](const uint8_t* epc) {
+        if (m_backgroundMs > 0) m_presence.seen(epc, now);
+        memcpy(inv.tagList[inv.tagCount], epc, INVENTORY_EPC_BYTES);
+        if (++inv.tagCount == INVENTORY_BATCH_TAGS) flush();
+    });
+    if (found < 0) return;
+    if (inv.tagCount > 0) flush();
+    if (m_backgroundMs > 0) {
+        expireMissing(now);
+        m_nextBackgroundMs = now + m_backgroundMs;
+    }
+
+    DatabaseMsg end = {};
+    end.command = DB_CMD_INVENTORY_END;
+    end.roomId = m_roomId;
+    end.vaultId = m_vaultId;
+    end.payload.rfidInventory.sessionId = inv.sessionId;
+    end.payload.rfidInventory.batchIndex = batches;
+    end.payload.rfidInventory.totalTags = static_cast<uint32_t>(found);
+    end.payload.rfidInventory.startedAt = inv.startedAt;
+    m_outbox.post(end);
+
+    LOG_INFO("[InventoryScan] Sessão %u: %d tags em %u lotes", inv.sessionId, found, batches);
+    // Stamped with the scan start, like every LastRead of the session.
+    sendLog(found, inv.startedAt);
 }
 
-void C_tInventoryScan::sendLog(int count) {
+void C_tInventoryScan::backgroundRound() {
+    int64_t now = monotonicMs();
+    m_nextBackgroundMs = now + m_backgroundMs;
+
+    int appeared = 0;
+    int found = m_rfidInventoy.scan([&](const uint8_t* epc) {
+        if (!m_presence.seen(epc, now) || m_silentRound) return;
+        sendPresence(epc, *m_presence.find(epc), now);
+        ++appeared;
+    });
+    // A round that failed or went unanswered proves nothing: nothing expires.
+    if (found < 0) return;
+    if (m_silentRound) {
+        // Without the DB's view every tag would read as new: this round only learns.
+        m_silentRound = false;
+        LOG_INFO("[InventoryScan] Fundo: presença inicial de %zu tags lida do cofre", m_presence.presentCount());
+        return;
+    }
+
+    int missing = expireMissing(now);
+    if (appeared > 0 || missing > 0) {
+        LOG_INFO("[InventoryScan] Fundo: %d tags lidas, +%d / -%d (%zu presentes)",
+                 found, appeared, missing, m_presence.presentCount());
+    }
+}
+
+int C_tInventoryScan::expireMissing(int64_t nowMs) {
+    int missing = 0;
+    m_presence.expire(nowMs, [&](const uint8_t* epc, const S_TagPresence& tag) {
+        sendPresence(epc, tag, nowMs);
+        ++missing;
+    });
+    return missing;
+}
+
+void C_tInventoryScan::sendPresence(const uint8_t* epc, const S_TagPresence& tag, int64_t nowMs) {
+    DatabaseMsg msg = {};
+    msg.command = DB_CMD_TAG_PRESENCE;
+    msg.roomId = m_roomId;
+    msg.vaultId = m_vaultId;
+
+    Data_TagPresence& p = msg.payload.tagPresence;
+    memcpy(p.epc, epc, INVENTORY_EPC_BYTES);
+    p.present = tag.present ? 1 : 0;
+    p.reads = tag.reads;
+    // Monotonic age of the last read, on the wall clock the DB stores.
+    p.lastSeen = static_cast<uint32_t>(time(nullptr) - (nowMs - tag.lastSeenMs) / 1000);
+
+    m_outbox.post(msg);
+}
+
+void C_tInventoryScan::sendLog(int count, uint32_t timestamp) {
     DatabaseMsg logMsg = {};
     logMsg.command = DB_CMD_WRITE_LOG;
+    logMsg.roomId = m_roomId;
+    logMsg.vaultId = m_vaultId;
 
-    logMsg.payload.log.logType = LOG_TYPE_INVENTORY; 
+    logMsg.payload.log.logType = LOG_TYPE_INVENTORY;
+    logMsg.payload.log.eventCode = EVT_INVENTORY_SCAN;
     logMsg.payload.log.entityID = 0;
     logMsg.payload.log.value = static_cast<double>(count);
-    logMsg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
-
-    generateDescription(count, logMsg.payload.log.description, sizeof(logMsg.payload.log.description));
+    logMsg.payload.log.timestamp = timestamp;
 
-    m_mqToDatabase.send(&logMsg, sizeof(DatabaseMsg));
+    m_outbox.post(logMsg);
 }
@@ -3,25 +3,65 @@
 
 /*
  * Inventory thread: RFID read in the vault and tag push to DB.
+ * Each scan is a session: tags are posted in INVENTORY_BATCH_TAGS batches as the
+ * reader reports them, then an end message closes the session.
+ * Optional background mode (uhf_background_ms): between closures the reader runs
+ * a round every period and only presence changes (tag appeared / missing) are
+ * sent to the DB. Rounds start once the tags the DB holds as present have been
+ * loaded, so a restart reports only what changed while the core was down.
  */
 
 #include "C_Thread.h"
 #include "C_Monitor.h"
-#include "C_YRM1001.h" 
 #include "C_Mqueue.h"
+#include "C_YRM1001.h" 
+#include "C_Outbox.h"
+#include "C_PowerPolicy.h"
+#include "C_SiteMap.h"
+#include "C_TagPresence.h"
 #include "SharedTypes.h"
 
+// Presence load: retry period and attempts before the first round only learns.
+#define PRESENCE_SEED_RETRY_MS  5000
+#define PRESENCE_SEED_ATTEMPTS  6
+
 class C_tInventoryScan : public C_Thread {
 private:
     C_Monitor& m_monitorservovault;
     C_YRM1001& m_rfidInventoy; 
+    C_Outbox& m_outbox;
     C_Mqueue& m_mqToDatabase;
+    C_Mqueue& m_mqFromDatabase;
+    C_PowerPolicy& m_power;
+    uint16_t m_vaultId;
+    uint16_t m_roomId;
+    uint32_t m_lastSession;
+    int m_backgroundMs;
+    int64_t m_nextBackgroundMs;
+    C_TagPresence m_presence;
+    uint32_t m_reedSeen;        // Last vault reed signal handled (latched across rounds).
+
+    // Presence table load (background mode only).
+    bool m_seeded;
+    bool m_silentRound;         // Load gave up: the first round reports nothing.
+    uint32_t m_seedRequest;
+    uint16_t m_seedBatches;     // Reply batches of m_seedRequest taken so far.
+    int m_seedAttempts;
+    int64_t m_nextSeedMs;
 
-    void sendLog(int count);
-    void generateDescription(int count, char* buffer, size_t size);
+    uint32_t nextSessionId();
+    void requestSeed(int64_t nowMs);
+    void takeSeedReplies();
+    void scanSession();
+    void backgroundRound();
+    // Report tags unread for uhf_missing_ms; returns how many went missing.
+    int expireMissing(int64_t nowMs);
+    void sendPresence(const uint8_t* epc, const S_TagPresence& tag, int64_t nowMs);
+    void sendLog(int count, uint32_t timestamp);
 
 public:
-    C_tInventoryScan(C_Monitor& m_monitorservovault, C_YRM1001& m_rfidInventoy, C_Mqueue& m_mqToDatabase);
+    C_tInventoryScan(C_Monitor& m_monitorservovault, C_YRM1001& m_rfidInventoy, C_Outbox& outbox,
+                     C_Mqueue& mqToDatabase, C_Mqueue& mqFromDatabase, C_PowerPolicy& power, const S_VaultMap& vault);
     virtual ~C_tInventoryScan() override = default;
 
     void run() override;
@@ -1,117 +1,147 @@
 /*
- * Flow: wait for exit RFID -> query DB -> open door -> log -> close door.
+ * Flow: wait for exit RFID/reed events of any room -> query DB -> open door -> log -> close door.
  */
 
 #include "C_tLeaveRoomAccess.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <cstring>
 #include <ctime>
 
-C_tLeaveRoomAccess::C_tLeaveRoomAccess(C_Monitor& monitorrfid, C_Monitor& monitorservoroom,
-                                       C_RDM6300& rfid,
+C_tLeaveRoomAccess::C_tLeaveRoomAccess(C_UnitEvents& events,
+                                       const std::vector<C_Room*>& rooms,
                                        C_Mqueue& mqDB,
                                        C_Mqueue& mqFromDB,
-                                       C_Mqueue& mqAct)
-    :C_Thread(PRIO_MEDIUM), m_monitorrfid( monitorrfid),
-      m_monitorservoroom( monitorservoroom),
-      m_rfidExit(rfid),
+                                       C_Mqueue& mqAct,
+                                       C_Outbox& outbox,
+                                       C_RuleEngine& rules)
+    :C_Thread(PRIO_MEDIUM), m_events(events),
+      m_rooms(rooms),
       m_mqToDatabase(mqDB),
       m_mqToLeaveRoom(mqFromDB),
       m_mqToActuator(mqAct),
-      m_maxAttempts(3),
-      m_failedAttempts(0)
+      m_outbox(outbox),
+      m_rules(rules),
+      m_doorsOpen(0),
+      m_replyTimeoutS(ACCESS_REPLY_TIMEOUT_DEFAULT)
 {
 }
 
 C_tLeaveRoomAccess::~C_tLeaveRoomAccess() { 
 }
 
+void C_tLeaveRoomAccess::setReplyTimeout(int seconds) {
+    m_replyTimeoutS.store(seconds);
+}
+
 void C_tLeaveRoomAccess::run() {
-    std::cout << "[LeaveRoom] Thread em execução. À espera de tags para sair..." << std::endl;
+    LOG_INFO("[LeaveRoom] Thread em execução (%zu salas). À espera de tags para sair...", m_rooms.size());
 
-    // Main loop: wait for RFID monitor signal.
+    // Main loop: events of every room arrive in one inbox.
     while (!stopRequested()) {
 
         // Timeout to allow graceful stop.
-        if (m_monitorrfid.timedWait(1)) {
+        uint64_t edgesNs[UNIT_EVENTS_BITS];
+        uint32_t events = m_events.take(1, edgesNs);
+        if (events == 0) {
             continue;
         }
 
-        SensorData data = {};
-        // Read exit RFID.
-        if (m_rfidExit.read(&data)) {
-            const char* rfidRead = data.data.rfid_single.tagID;
-            std::cout << "[RFID-EXIT] Cartão lido: " << rfidRead << std::endl;
-
-            // Send exit request to DB.
-            DatabaseMsg msg = {};
-            msg.command = DB_CMD_LEAVE_ROOM_RFID; 
-            strncpy(msg.payload.rfid, rfidRead, sizeof(msg.payload.rfid) - 1);
-            msg.payload.rfid[sizeof(msg.payload.rfid) - 1] = '\0';
-            m_mqToDatabase.send(&msg, sizeof(msg));
-
-            AuthResponse resp = {};
-
-            // Wait for DB response.
-            while (!stopRequested()) {
-                ssize_t bytes = m_mqToLeaveRoom.timedReceive(&resp, sizeof(resp), 1);
-
-                if (bytes > 0) {
-                    // Authorized: open door and log event.
-                    if (resp.payload.auth.authorized) {
-                        std::cout << "[RFID-EXIT] Saída Autorizada! UserID: " << static_cast<unsigned int>(resp.payload.auth.userId) << std::endl;
-                        m_failedAttempts = 0;
-
-                        ActuatorCmd cmd = {ID_SERVO_ROOM, 0};
-                        m_mqToActuator.send(&cmd, sizeof(cmd));
-
-                        // Exit log.
-                        sendLog(static_cast<uint32_t>(resp.payload.auth.userId),
-                                static_cast<uint32_t>(resp.payload.auth.accessLevel));
-
-                        // Wait for reed switch indicating close.
-                        while (!stopRequested()) {
-                            
-                            if (!m_monitorservoroom.timedWait(1)) {
-                                break;
-                            }
-                        }
-                        
-                        if (stopRequested()) {
-                            break; 
-                        }
-
-                        // Close door after passage.
-                        cmd = {ID_SERVO_ROOM, 90};
-                        m_mqToActuator.send(&cmd, sizeof(cmd));
-                    }
-
-                    // If not authorized, just exit the loop (no action).
-                    break;
-                }
+        for (C_Room* room : m_rooms) {
+            if (stopRequested()) break;
+
+            if (C_UnitEvents::has(events, room->index(), ROOM_EVT_REED) &&
+                (m_doorsOpen & (1u << room->index()))) {
+                closeDoor(*room);
+            }
+
+            if (C_UnitEvents::has(events, room->index(), ROOM_EVT_RFID)) {
+                handleCard(*room, C_UnitEvents::edgeOf(edgesNs, room->index(), ROOM_EVT_RFID));
             }
         }
     }
 
-    std::cout << "[LeaveRoom] Thread terminada com sucesso." << std::endl;
+    LOG_INFO("[LeaveRoom] Thread terminada com sucesso.");
 }
 
-void C_tLeaveRoomAccess::generateDescription(uint32_t userId, char* buffer, size_t size) {
+void C_tLeaveRoomAccess::handleCard(C_Room& room, uint64_t edgeNs) {
+    SensorData data = {};
+    // Read exit RFID.
+    if (!room.rfidExit().read(&data)) {
+        return;
+    }
+
+    const char* rfidRead = data.data.rfid_single.tagID;
+    LOG_INFO("[RFID-EXIT] %s: cartão lido: %s", room.name(), rfidRead);
+
+    // Send exit request to DB.
+    DatabaseMsg msg = {};
+    msg.command = DB_CMD_LEAVE_ROOM_RFID; 
+    msg.roomId = room.id();
+    strncpy(msg.payload.rfid, rfidRead, sizeof(msg.payload.rfid) - 1);
+    msg.payload.rfid[sizeof(msg.payload.rfid) - 1] = '\0';
+
+    // Drop a late reply left over from a request that timed out.
+    AuthResponse resp = {};
+    while (m_mqToLeaveRoom.timedReceive(&resp, sizeof(resp), 0) > 0) {}
+
+    if (!m_mqToDatabase.trySend(&msg, sizeof(msg))) {
+        LOG_WARN("[RFID-EXIT] BD indisponível: saída recusada");
+        return;
+    }
 
-        // Text message for logs.
-        snprintf(buffer, size, "Utilizador %u SAIU da sala", userId);
+    // Wait for DB response.
+    int waited = 0;
+    const int timeoutS = m_replyTimeoutS.load();
+    while (!stopRequested()) {
+        if (waited++ >= timeoutS) {
+            LOG_WARN("[RFID-EXIT] BD sem resposta: saída recusada");
+            return;
+        }
+
+        ssize_t bytes = m_mqToLeaveRoom.timedReceive(&resp, sizeof(resp), 1);
+        if (bytes <= 0) continue;
+
+        // Requests are serialized: a reply for another room is stale.
+        if (resp.roomId != room.id()) continue;
+
+        // Authorized: open door and log event.
+        if (resp.payload.auth.authorized) {
+            uint32_t userId = static_cast<uint32_t>(resp.payload.auth.userId);
+            LOG_INFO("[RFID-EXIT] %s: saída autorizada! UserID: %u", room.name(), static_cast<unsigned int>(userId));
+            room.occupancy().leave(userId);
+            m_rules.fire(REVT_EXIT_GRANTED, static_cast<double>(userId), 0.0, room.id());
+
+            ActuatorCmd cmd(ID_SERVO_ROOM, 0, room.id());
+            m_mqToActuator.send(&cmd, sizeof(cmd));
+            LOG_DEBUG("[RFID-EXIT] %s: porta comandada %u us após o cartão", room.name(), sinceEdgeUs(edgeNs));
+            m_doorsOpen |= 1u << room.index();
+
+            // Exit log.
+            sendLog(room.id(), userId, static_cast<uint32_t>(resp.payload.auth.accessLevel));
+        }
+
+        // If not authorized, no action.
+        return;
+    }
 }
 
-void C_tLeaveRoomAccess::sendLog(uint32_t userId, uint32_t accessLevel) {
+void C_tLeaveRoomAccess::closeDoor(C_Room& room) {
+    // Close door after passage.
+    ActuatorCmd cmd(ID_SERVO_ROOM, 90, room.id());
+    m_mqToActuator.send(&cmd, sizeof(cmd));
+    m_doorsOpen &= ~(1u << room.index());
+}
+
+void C_tLeaveRoomAccess::sendLog(uint16_t roomId, uint32_t userId, uint32_t accessLevel) {
     DatabaseMsg msg = {};
     msg.command = DB_CMD_WRITE_LOG;
+    msg.roomId = roomId;
 
-    msg.payload.log.logType = LOG_TYPE_ACCESS ;
+    msg.payload.log.logType = LOG_TYPE_ACCESS;
+    msg.payload.log.eventCode = EVT_ROOM_LEAVE;
     msg.payload.log.entityID = userId;
     msg.payload.log.value = static_cast<double>(accessLevel);
     msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
 
-    generateDescription(userId, msg.payload.log.description, sizeof(msg.payload.log.description));
-
-    m_mqToDatabase.send(&msg, sizeof(DatabaseMsg), 0);
+    m_outbox.post(msg);
 }
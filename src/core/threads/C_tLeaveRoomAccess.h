@@ -2,38 +2,51 @@
 #define C_TVERIFYLEAVEROOM_H
 
 /*
- * Exit thread: validates exit RFID and drives the door servo.
+ * Exit thread: validates exit RFID and drives the door servo (serves every room).
  */
 
+#include <atomic>
+#include <vector>
+
 #include "C_Thread.h"
-#include "C_Monitor.h"
-#include "C_RDM6300.h"
+#include "C_UnitEvents.h"
+#include "C_Room.h"
 #include "C_Mqueue.h"
+#include "C_Outbox.h"
+#include "C_RuleEngine.h"
 #include "SharedTypes.h"
 
 class C_tLeaveRoomAccess : public C_Thread {
 private:
-    C_Monitor& m_monitorrfid;
-    C_Monitor& m_monitorservoroom;
-    C_RDM6300& m_rfidExit;       
+    C_UnitEvents& m_events;
+    std::vector<C_Room*> m_rooms;
     C_Mqueue& m_mqToDatabase;
     C_Mqueue& m_mqToLeaveRoom;   
     C_Mqueue& m_mqToActuator;
+    C_Outbox& m_outbox;
+    C_RuleEngine& m_rules;
+
+    // Rooms whose door this thread unlocked (relocked on the next reed event).
+    uint32_t m_doorsOpen;
+    std::atomic<int> m_replyTimeoutS;
 
-    int m_failedAttempts;
-    int m_maxAttempts;
+    // edgeNs: time of the exit reader's trigger.
+    void handleCard(C_Room& room, uint64_t edgeNs);
+    void closeDoor(C_Room& room);
 
 public:
-    C_tLeaveRoomAccess(C_Monitor& monitorrfid, C_Monitor& monitorservoroom,
-                       C_RDM6300& rfid,
+    C_tLeaveRoomAccess(C_UnitEvents& events,
+                       const std::vector<C_Room*>& rooms,
                        C_Mqueue& mqDB,
                        C_Mqueue& mqFromDB,
-                       C_Mqueue& mqAct);
+                       C_Mqueue& mqAct,
+                       C_Outbox& outbox,
+                       C_RuleEngine& rules);
 
     virtual ~C_tLeaveRoomAccess();
 
-    void generateDescription(uint32_t userId, char* buffer, size_t size);
-    void sendLog(uint32_t userId, uint32_t accessLevel);
+    void sendLog(uint16_t roomId, uint32_t userId, uint32_t accessLevel);
+    void setReplyTimeout(int seconds);
     void run() override;
 };
 
@@ -0,0 +1,59 @@
+/*
+ * Flow: poll outbox backlog -> replay batch while /mq_to_db has room -> sync segment -> report.
+ */
+
+#include "C_tOutboxFlush.h"
+#include "C_Logger.h"
+#include <ctime>
+
+static constexpr uint32_t FLUSH_BATCH = 16;
+static constexpr long FLUSH_IDLE_MS = 200;
+static constexpr long FLUSH_BACKOFF_MS = 1000;
+
+C_tOutboxFlush::C_tOutboxFlush(C_Outbox& outbox)
+    : C_Thread(PRIO_LOW),
+      m_outbox(outbox),
+      m_reportedDrops(0)
+{
+}
+
+void C_tOutboxFlush::run() {
+    LOG_INFO("[OutboxFlush] Thread iniciada.");
+
+    uint32_t replayed = 0;
+
+    while (!stopRequested()) {
+        long sleepMs = FLUSH_IDLE_MS;
+
+        if (m_outbox.backlog() > 0) {
+            uint32_t n = m_outbox.flush(FLUSH_BATCH);
+            replayed += n;
+            // DB still busy/down: back off instead of spinning.
+            if (n == 0) sleepMs = FLUSH_BACKOFF_MS;
+            else if (m_outbox.backlog() > 0) sleepMs = 0;
+        }
+
+        // Durability for slots appended by post() on the RT threads.
+        m_outbox.sync();
+
+        if (replayed > 0 && m_outbox.backlog() == 0) {
+            LOG_INFO("[OutboxFlush] %u mensagens reenviadas para a BD", replayed);
+            replayed = 0;
+        }
+
+        uint32_t drops = m_outbox.dropped();
+        if (drops != m_reportedDrops) {
+            LOG_WARN("[OutboxFlush] %u mensagens descartadas", drops - m_reportedDrops);
+            m_reportedDrops = drops;
+        }
+
+        if (sleepMs > 0) {
+            struct timespec ts = {sleepMs / 1000, (sleepMs % 1000) * 1000000L};
+            nanosleep(&ts, nullptr);
+        }
+    }
+
+    // Final attempt so a clean shutdown leaves as little as possible on disk.
+    m_outbox.flush(OUTBOX_DEFAULT_SLOTS);
+    LOG_INFO("[OutboxFlush] Thread terminada (pendentes: %u)", m_outbox.backlog());
+}
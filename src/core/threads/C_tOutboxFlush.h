@@ -0,0 +1,25 @@
+#ifndef C_TOUTBOXFLUSH_H
+#define C_TOUTBOXFLUSH_H
+
+/*
+ * Outbox replay thread: drains the persisted backlog to the DB daemon in order
+ * and writes the segment to disk off the real-time path.
+ */
+
+#include "C_Thread.h"
+#include "C_Outbox.h"
+#include "SharedTypes.h"
+
+class C_tOutboxFlush : public C_Thread {
+private:
+    C_Outbox& m_outbox;
+    uint32_t m_reportedDrops;
+
+public:
+    explicit C_tOutboxFlush(C_Outbox& outbox);
+    ~C_tOutboxFlush() override = default;
+
+    void run() override;
+};
+
+#endif
@@ -1,58 +1,61 @@
 /*
- * Flow: load settings -> read loop -> control fan -> send logs.
+ * Flow: load settings -> read loop -> statistics/alerts -> control fan -> send logs.
  */
 
 #include "C_tReadEnvSensor.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <ctime>
 #include <cstring>
 #include "SharedTypes.h"
 #include "C_TH_SHT30.h"
 #include "C_Monitor.h"
 #include "C_Mqueue.h"
+#include "C_Outbox.h"
+#include "C_RuleEngine.h"
 
 
 C_tReadEnvSensor::C_tReadEnvSensor(C_TH_SHT30& sensor,
-                                   C_Mqueue& mqAct,
+                                   C_RuleEngine& rules,
                                    C_Mqueue& mqDB,
                                    C_Mqueue& mqFromDb,
+                                   C_Outbox& outbox,
                                    int intervalSec,
                                    int threshold)
     : C_Thread(PRIO_LOW),  
       m_sensor(sensor),
-      m_mqToActuator(mqAct),
+      m_rules(rules),
       m_mqToDatabase(mqDB),
       m_mqFromDb(mqFromDb),
+      m_outbox(outbox),
       m_tempThreshold(threshold),
-      m_intervalSeconds(intervalSec),
-      m_lastFanState(0)
+      m_intervalSeconds(intervalSec)
 {}
 
 C_tReadEnvSensor::~C_tReadEnvSensor() = default;
 
 void C_tReadEnvSensor::run() {
-    std::cout << "[tReadEnv] Thread em execução.\n";
+    LOG_INFO("[tReadEnv] Thread em execução.");
 
     {
         // Initial settings request to DB (threshold and interval).
         DatabaseMsg reqSettings = {};
         reqSettings.command = DB_CMD_GET_SETTINGS_THREAD;
-        m_mqToDatabase.send(&reqSettings, sizeof(reqSettings));
-
-        std::cout << "[tReadEnv] A pedir settings à BD..." << std::endl;
+        LOG_INFO("[tReadEnv] A pedir settings à BD...");
 
         AuthResponse settingsResp{};
-        ssize_t bytes = m_mqFromDb.timedReceive(&settingsResp, sizeof(settingsResp), 5);
+        ssize_t bytes = -1;
+        if (m_mqToDatabase.trySend(&reqSettings, sizeof(reqSettings))) {
+            bytes = m_mqFromDb.timedReceive(&settingsResp, sizeof(settingsResp), 5);
+        }
 
         if (bytes > 0 && settingsResp.command == DB_CMD_GET_SETTINGS_THREAD) {
             m_tempThreshold = settingsResp.payload.settings.tempThreshold;
             m_intervalSeconds = settingsResp.payload.settings.samplingInterval;
-            std::cout << "[tReadEnv] Settings carregadas: threshold="
-                      << m_tempThreshold << "°C, interval="
-                      << m_intervalSeconds << "s" << std::endl;
+            LOG_INFO("[tReadEnv] Settings carregadas: threshold=%d°C, interval=%ds", m_tempThreshold, m_intervalSeconds);
         } else {
-            std::cout << "[tReadEnv] AVISO: A usar valores default (BD não respondeu)" << std::endl;
+            LOG_WARN("[tReadEnv] AVISO: A usar valores default (BD não respondeu)");
         }
+        m_rules.setVar(RVAR_TEMP_THRESHOLD, m_tempThreshold);
     }
 
     while (!stopRequested()) {
@@ -70,10 +73,9 @@ void C_tReadEnvSensor::run() {
                 m_tempThreshold   = cmdMsg.payload.settings.tempThreshold;
                 m_intervalSeconds = cmdMsg.payload.settings.samplingInterval;
                 if (m_intervalSeconds < 1) m_intervalSeconds = 1;
+                m_rules.setVar(RVAR_TEMP_THRESHOLD, m_tempThreshold);
 
-                std::cout << "[tReadEnv] Settings atualizadas: interval="
-                          << m_intervalSeconds
-                          << "s, threshold=" << m_tempThreshold << "\n";
+                LOG_INFO("[tReadEnv] Settings atualizadas: interval=%ds, threshold=%d", m_intervalSeconds, m_tempThreshold);
             }
 
             continue;
@@ -85,30 +87,28 @@ void C_tReadEnvSensor::run() {
             float temp = data.data.tempHum.temp;
             float hum  = data.data.tempHum.hum;
 
-            uint8_t fanValue = (temp > static_cast<float>(m_tempThreshold)) ? 1 : 0;
-
-            if (fanValue != m_lastFanState) {
-                // Toggle fan when crossing the threshold.
-                ActuatorCmd cmd{ID_FAN, fanValue};
-                m_lastFanState = fanValue;
-                m_mqToActuator.send(&cmd, sizeof(cmd));
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            uint8_t alerts = m_stats.update(temp, hum, static_cast<double>(now.tv_sec) +
+                                                       static_cast<double>(now.tv_nsec) / 1e9);
+            LOG_DEBUG("[tReadEnv] T=%.2f (média %.2f, %.2f/min, [%.2f..%.2f]) HR=%.1f (média %.1f)",
+                      temp, m_stats.temp().mean, m_stats.temp().ratePerMin,
+                      m_stats.temp().min, m_stats.temp().max, hum, m_stats.hum().mean);
+
+            // Fan switching on the threshold is a rule (ENV_SAMPLE).
+            m_rules.fire(REVT_ENV_SAMPLE, temp, hum);
+            if (alerts != ENV_ALERT_NONE) {
+                raiseAlerts(alerts);
             }
 
             sendLog(static_cast<float>(temp),
                     static_cast<float>(hum));
         } else {
-            std::cerr << "[tReadEnv] ERRO ao ler sensor!\n";
+            LOG_ERROR("[tReadEnv] ERRO ao ler sensor!");
         }
     }
 
-    std::cout << "[tReadEnv] Thread terminada\n";
-}
-
-void C_tReadEnvSensor::generateDescription(double temp, double hum,
-                                          char* buffer, size_t size) {
-    snprintf(buffer, size,
-             "Leitura Ambiental: %.1f°C, %.1f HR",
-             temp, hum);
+    LOG_INFO("[tReadEnv] Thread terminada");
 }
 
 void C_tReadEnvSensor::sendLog(double temp, double hum) const {
@@ -116,17 +116,54 @@ void C_tReadEnvSensor::sendLog(double temp, double hum) const {
 
     msg.command = DB_CMD_WRITE_LOG;
     msg.payload.log.logType = LOG_TYPE_SENSOR;
+    msg.payload.log.eventCode = EVT_ENV_READING;
     msg.payload.log.entityID = ID_SHT31;  
     msg.payload.log.value = temp;
     msg.payload.log.value2 = hum;
     msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
-    generateDescription(temp, hum,
-                       msg.payload.log.description,
-                       sizeof(msg.payload.log.description));
 
-    if (m_mqToDatabase.send(&msg, sizeof(DatabaseMsg), 0)) {
-        std::cout << "[tReadEnv] Log enviado para BD" << std::endl;
+    if (m_outbox.post(msg)) {
+        LOG_INFO("[tReadEnv] Log enviado para BD");
     } else {
-        std::cerr << "[tReadEnv] ERRO ao enviar log para BD!" << std::endl;
+        LOG_ERROR("[tReadEnv] ERRO ao enviar log para BD!");
+    }
+}
+
+void C_tReadEnvSensor::raiseAlerts(uint8_t alerts) {
+    const C_EnvStats::S_Channel& t = m_stats.temp();
+    const C_EnvStats::S_Channel& h = m_stats.hum();
+
+    if (alerts & ENV_ALERT_RAPID_RISE) {
+        LOG_WARN("[tReadEnv] ALERTA: subida rápida de temperatura (%.2f°C/min)", t.ratePerMin);
+        sendAlert(EVT_ENV_RAPID_RISE, t.last, t.ratePerMin);
+    }
+    if (alerts & ENV_ALERT_TEMP_DRIFT) {
+        LOG_WARN("[tReadEnv] ALERTA: temperatura fora do padrão (%.2f°C, média %.2f, z=%.1f)",
+                 t.last, t.mean, t.zScore);
+        sendAlert(EVT_ENV_TEMP_DRIFT, t.last, t.mean);
     }
+    if (alerts & ENV_ALERT_HUM_SPIKE) {
+        LOG_WARN("[tReadEnv] ALERTA: pico de humidade (%.1f HR, média %.1f)", h.last, h.mean);
+        sendAlert(EVT_ENV_HUM_SPIKE, h.last, h.mean);
+    }
+    if (alerts & ENV_ALERT_STUCK) {
+        LOG_WARN("[tReadEnv] ALERTA: sensor sem variação em %d amostras", ENV_WINDOW);
+        sendAlert(EVT_ENV_STUCK, t.last, h.last);
+    }
+}
+
+void C_tReadEnvSensor::sendAlert(LogEvent_enum code, double value, double value2) const {
+    DatabaseMsg msg = {};
+
+    msg.command = DB_CMD_WRITE_LOG;
+    msg.payload.log.logType = LOG_TYPE_ALERT;
+    msg.payload.log.eventCode = code;
+    msg.payload.log.entityID = ID_SHT31;
+    msg.payload.log.value = value;
+    msg.payload.log.value2 = value2;
+    msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
+    m_outbox.post(msg);
+
+    // Site-specific reactions (alarm, fan) are rules on ENV_ALERT.
+    m_rules.fire(REVT_ENV_ALERT, static_cast<double>(code));
 }
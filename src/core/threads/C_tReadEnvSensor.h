@@ -1,34 +1,43 @@
 #ifndef C_TREADENVENSOR_H
 #define C_TREADENVENSOR_H
 /*
- * Environment thread: reads SHT30, updates DB, and controls fan.
+ * Environment thread: reads SHT30, updates DB, controls fan and raises early warnings.
  */
 #include <cstdint>
 #include "C_Thread.h"
+#include "C_EnvStats.h"
+#include "SharedTypes.h"
 
 class C_Monitor;
 class C_TH_SHT30;
 class C_Mqueue;
+class C_Outbox;
+class C_RuleEngine;
 
 class C_tReadEnvSensor : public C_Thread {
 private:
     C_TH_SHT30& m_sensor;
-    C_Mqueue& m_mqToActuator;
+    C_RuleEngine& m_rules;
     C_Mqueue& m_mqToDatabase;
     C_Mqueue& m_mqFromDb;
+    C_Outbox& m_outbox;
 
     int m_tempThreshold;
     int m_intervalSeconds;
-    uint8_t m_lastFanState;
-    
+
+    // Streaming statistics for drift/spike/stuck detection.
+    C_EnvStats m_stats;
+
     void sendLog(double temp, double hum) const;
-    static void generateDescription(double temp, double hum, char* buffer, size_t size);
+    void raiseAlerts(uint8_t alerts);
+    void sendAlert(LogEvent_enum code, double value, double value2) const;
 
 public:
     C_tReadEnvSensor(C_TH_SHT30& sensor,
-                     C_Mqueue& mqAct,
+                     C_RuleEngine& rules,
                      C_Mqueue& mqDB,
-                     C_Mqueue& mqFromDb, 
+                     C_Mqueue& mqFromDb,
+                     C_Outbox& outbox,
                      int intervalSec = 600,
                      int threshold = 30);
 
@@ -3,10 +3,21 @@
  */
 
 #include "C_tSighandler.h"
+#include "C_Room.h"
+#include "C_Logger.h"
+#include "C_HalPaths.h"
+#include <ctime>
+#include <cstring>
+#include <poll.h>
 
+static uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
 
-C_tSighandler::C_tSighandler(C_Monitor& reed_room,C_Monitor& reed_vault, C_Monitor& pir, C_Monitor& finger, C_Monitor& rfid_entry,C_Monitor& rfid_exit)
-    : C_Thread(PRIO_HIGH),m_monReed_room(reed_room),m_monReed_vault(reed_vault), m_monPIR(pir), m_monFinger(finger), m_monRFID_entry(rfid_entry),m_monRFID_exit(rfid_exit), m_fd(-1)
+C_tSighandler::C_tSighandler(const C_SiteMap& site, C_UnitEvents& roomEntry, C_UnitEvents& roomExit, C_UnitEvents& pir, C_Monitor& reed_vault, C_Monitor& finger)
+    : C_Thread(PRIO_HIGH),m_site(site),m_roomEntry(roomEntry),m_roomExit(roomExit), m_pir(pir),m_monReed_vault(reed_vault), m_monFinger(finger), m_fd(-1)
 {
     sigemptyset(&m_sigSet);
     sigaddset(&m_sigSet, 43); 
@@ -15,6 +26,11 @@ C_tSighandler::C_tSighandler(C_Monitor& reed_room,C_Monitor& reed_vault, C_Monit
     sigaddset(&m_sigSet, 46); 
     sigaddset(&m_sigSet, 47); 
     sigaddset(&m_sigSet, 48); 
+
+    // Per-input settings from the site map ([site] <input>_holdoff_ms, ...).
+    for (int sig = SIG_FIRST; sig <= SIG_LAST; ++sig) {
+        setDebounce(sig, m_site.debounce[sig - SIG_FIRST]);
+    }
 }
 
 C_tSighandler::~C_tSighandler() {
@@ -34,21 +50,153 @@ void C_tSighandler::setupSignalBlock() {
     sigaddset(&set, 48);
     
     if (pthread_sigmask(SIG_BLOCK, &set, NULL) != 0) {
-        perror("Erro ao bloquear sinais");
+        LOG_ERROR("Erro ao bloquear sinais: %s", strerror(errno));
+    }
+}
+
+void C_tSighandler::setDebounce(int sig, const S_Debounce& cfg) {
+    // Must be called before start(); the state is owned by the handler thread.
+    if (sig < SIG_FIRST || sig > SIG_LAST) return;
+    for (int unit = 0; unit < SITE_MAX_ROOMS; ++unit) {
+        S_DebounceState& st = m_debounce[sig - SIG_FIRST][unit];
+        st.cfg = cfg;
+        if (st.cfg.minEdges < 1) st.cfg.minEdges = 1;
+        st.windowOpen = false;
+        st.windowDelivered = false;
+        st.windowEnd = 0;
+        st.windowEdges = 0;
+        st.lastDelivered = INT64_MIN / 2;
+    }
+}
+
+const S_DebounceStats* C_tSighandler::getStats(int sig) const {
+    if (sig < SIG_FIRST || sig > SIG_LAST) return nullptr;
+    return &m_stats[sig - SIG_FIRST];
+}
+
+int C_tSighandler::unitFor(int sig, int pino) const {
+    // Vault inputs have a single unit; room inputs are routed by pin.
+    switch (sig) {
+        case 44: return m_site.roomIndexFor(IRQ_ROOM_REED, pino);
+        case 45: return m_site.roomIndexFor(IRQ_ROOM_PIR, pino);
+        case 47: return m_site.roomIndexFor(IRQ_RFID_ENTRY, pino);
+        case 48: return m_site.roomIndexFor(IRQ_RFID_EXIT, pino);
+        default: return 0;
+    }
+}
+
+bool C_tSighandler::acceptEvent(int sig, int unit, int64_t nowMs) {
+    S_DebounceState& st = m_debounce[sig - SIG_FIRST][unit];
+    S_DebounceStats& stats = m_stats[sig - SIG_FIRST];
+    stats.received++;
+
+    // Close an expired window (lazily, on the next edge).
+    if (st.windowOpen && nowMs >= st.windowEnd) {
+        if (!st.windowDelivered) stats.rejected++;
+        st.windowOpen = false;
+    }
+
+    if (st.windowOpen) {
+        // Edge inside the hold-off window: qualify or merge.
+        st.windowEdges++;
+        if (!st.windowDelivered && st.windowEdges >= st.cfg.minEdges) {
+            st.windowDelivered = true;
+            st.lastDelivered = nowMs;
+            return true;
+        }
+        stats.coalesced++;
+        return false;
+    }
+
+    if (nowMs - st.lastDelivered < st.cfg.minIntervalMs) {
+        stats.rateLimited++;
+        return false;
+    }
+
+    // First edge: open a window and deliver on the leading edge when qualified.
+    st.windowOpen = (st.cfg.holdoffMs > 0);
+    st.windowEnd = nowMs + st.cfg.holdoffMs;
+    st.windowEdges = 1;
+    st.windowDelivered = (st.cfg.minEdges <= 1);
+    if (st.windowDelivered) {
+        st.lastDelivered = nowMs;
+        return true;
+    }
+    if (!st.windowOpen) stats.rejected++;
+    return false;
+}
+
+void C_tSighandler::dispatch(int sig, int unit, int pino, uint64_t edgeNs) {
+    m_stats[sig - SIG_FIRST].delivered++;
+    unsigned room = static_cast<unsigned>(unit);
+
+    // Map signal -> corresponding monitor / room inbox.
+    switch (sig) {
+        case 43:
+            LOG_INFO("[Hardware] Reed Switch detetado no pino %d", pino);
+            m_monReed_vault.signal(edgeNs);
+            break;
+
+        case 44:
+            LOG_INFO("[Hardware] Reed Switch detetado no pino %d (sala #%d)", pino, unit);
+            // Entry and exit flows each relock the doors they opened.
+            m_roomEntry.post(room, ROOM_EVT_REED, edgeNs);
+            m_roomExit.post(room, ROOM_EVT_REED, edgeNs);
+            break;
+        case 45:
+            LOG_INFO("[Hardware] Movimento PIR detetado no pino %d (sala #%d)", pino, unit);
+            m_pir.post(room, 0, edgeNs);
+            break;
+        case 46:
+            LOG_INFO("[Hardware] Digital lida no pino %d", pino);
+            m_monFinger.signal(edgeNs);
+            break;
+        case 47:
+            LOG_INFO("[Hardware] RFID entrada no pino %d (sala #%d)", pino, unit);
+            m_roomEntry.post(room, ROOM_EVT_RFID, edgeNs);
+            break;
+        case 48:
+            LOG_INFO("[Hardware] RFID saida aproximado no pino %d (sala #%d)", pino, unit);
+            m_roomExit.post(room, ROOM_EVT_RFID, edgeNs);
+    }
+}
+
+void C_tSighandler::logStats() const {
+    // Debounce summary (only signals that saw traffic).
+    for (int sig = SIG_FIRST; sig <= SIG_LAST; ++sig) {
+        const S_DebounceStats& s = m_stats[sig - SIG_FIRST];
+        if (s.received == 0) continue;
+        LOG_INFO("[Sighandler] Sinal %d: recebidos=%u entregues=%u agrupados=%u limitados=%u rejeitados=%u", sig, s.received.load(), s.delivered.load(), s.coalesced.load(), s.rateLimited.load(), s.rejected.load());
+        if (!m_inputs.empty() && s.delivered > 0) {
+            LOG_INFO("[Sighandler] Sinal %d: latência média=%llu us máx=%u us", sig,
+                     static_cast<unsigned long long>(s.latencySumUs.load() / s.delivered.load()), s.latencyMaxUs.load());
+        }
     }
 }
 
 void C_tSighandler::run() {
+    // Simulated inputs arrive as the driver's signals (no edge events on a fake sysfs).
+    if (m_site.irqSource == IRQ_SOURCE_GPIO && !C_HalPaths::simulated()) {
+        runGpio();
+    } else {
+        runDriver();
+    }
+    logStats();
+}
+
+void C_tSighandler::runDriver() {
     siginfo_t info;
 
-    // Register PID with the driver to receive IRQ signals.
-    m_fd = open("/dev/irq0", O_WRONLY);
-    if (m_fd < 0 || ioctl(m_fd, REGIST_PID, 0) < 0) {
-        std::cerr << "[Sighandler] ERRO: Não foi possível conectar ao Kernel Driver!" << std::endl;
-        return;
+    // Register PID with the driver to receive IRQ signals (the simulator queues them itself).
+    if (!C_HalPaths::simulated()) {
+        m_fd = open("/dev/irq0", O_WRONLY);
+        if (m_fd < 0 || ioctl(m_fd, REGIST_PID, 0) < 0) {
+            LOG_ERROR("[Sighandler] ERRO: Não foi possível conectar ao Kernel Driver!");
+            return;
+        }
     }
 
-    std::cout << "[Sighandler] Pronto. À espera de eventos de hardware..." << std::endl;
+    LOG_INFO("[Sighandler] Pronto. À espera de eventos de hardware...");
 
     while (!stopRequested()) {
 
@@ -65,34 +213,88 @@ void C_tSighandler::run() {
             continue;
         }
 
-        int pino = info.si_int; 
-
-        // Map signal -> corresponding monitor.
-        switch (sig) {
-            case 43:
-                std::cout << "[Hardware] Reed Switch detetado no pino " << pino << std::endl;
-                m_monReed_vault.signal();
-                break;
-
-            case 44:
-                std::cout << "[Hardware] Reed Switch detetado no pino " << pino << std::endl;
-                m_monReed_room.signal();
-                break;
-            case 45:
-                std::cout << "[Hardware] Movimento PIR detetado no pino " << pino << std::endl;
-                m_monPIR.signal();
-                break;
-            case 46:
-                std::cout << "[Hardware] Digital lida no pino " << pino << std::endl;
-                m_monFinger.signal();
-                break;
-            case 47:
-                std::cout << "[Hardware] RFID entrada no pino " << pino << std::endl;
-                m_monRFID_entry.signal();
-                break;
-            case 48:
-                std::cout << "[Hardware] RFID saida aproximado no pino " << pino << std::endl;
-                m_monRFID_exit.signal();
+        if (sig < SIG_FIRST || sig > SIG_LAST) continue;
+
+        int unit = unitFor(sig, info.si_int);
+        if (unit < 0) {
+            LOG_RATELIMITED(LOG_LVL_WARN, 10000, "[Sighandler] Sinal %d do pino %d sem sala configurada", sig, info.si_int);
+            continue;
+        }
+
+        // The driver's signal carries no edge time: the receipt is the closest one.
+        uint64_t edgeNs = monotonicNs();
+
+        // Drop bounces/retriggers before they reach monitors, DB and logs.
+        if (acceptEvent(sig, unit, static_cast<int64_t>(edgeNs / 1000000ULL))) {
+            dispatch(sig, unit, info.si_int, edgeNs);
+        }
+    }
+}
+
+void C_tSighandler::addEdgeInput(int sig, int unit, int pin) {
+    S_EdgeInput input;
+    input.gpio = std::make_unique<C_GPIO>(pin, IN, m_site.irqEdge);
+    input.sig = sig;
+    input.unit = unit;
+    m_inputs.push_back(std::move(input));
+}
+
+bool C_tSighandler::openEdgeInputs() {
+    // Same input kinds as the driver signals, with the pins from the site map.
+    static const int ROOM_SIGS[IRQ_INPUT_COUNT] = {44, 45, 47, 48};
+    m_inputs.clear();
+    addEdgeInput(43, 0, m_site.vault.reedIrqPin);
+    addEdgeInput(46, 0, m_site.vault.fingerprintIrqPin);
+    for (size_t r = 0; r < m_site.rooms.size(); ++r) {
+        for (int i = 0; i < IRQ_INPUT_COUNT; ++i) {
+            addEdgeInput(ROOM_SIGS[i], static_cast<int>(r), m_site.rooms[r].irqPin[i]);
+        }
+    }
+
+    for (S_EdgeInput& input : m_inputs) {
+        if (!input.gpio->init()) {
+            LOG_ERROR("[Sighandler] ERRO: entrada GPIO %d (sinal %d) indisponível", input.gpio->pin(), input.sig);
+            m_inputs.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void C_tSighandler::runGpio() {
+    if (!openEdgeInputs()) return;
+
+    // chardev line requests signal POLLIN; sysfs value files signal POLLPRI.
+    const short events = (C_GPIO::backend() == GPIO_BACKEND_CHARDEV) ? POLLIN : (POLLPRI | POLLERR);
+    std::vector<struct pollfd> fds(m_inputs.size());
+    for (size_t i = 0; i < m_inputs.size(); ++i) {
+        fds[i].fd = m_inputs[i].gpio->eventFd();
+        fds[i].events = events;
+    }
+
+    LOG_INFO("[Sighandler] Pronto (GPIO, %zu entradas). À espera de eventos de hardware...", m_inputs.size());
+
+    while (!stopRequested()) {
+        // 1 s timeout to allow graceful stop.
+        int ready = poll(fds.data(), fds.size(), 1000);
+        if (ready <= 0) continue;
+
+        for (size_t i = 0; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) continue;
+            S_EdgeInput& input = m_inputs[i];
+            S_GpioEvent ev;
+            if (!input.gpio->readEvent(ev)) continue;
+
+            // Debounce on the edge time, not on when we got to it.
+            if (!acceptEvent(input.sig, input.unit, static_cast<int64_t>(ev.timestampNs / 1000000ULL))) continue;
+            dispatch(input.sig, input.unit, input.gpio->pin(), ev.timestampNs);
+
+            uint64_t latencyNs = monotonicNs() - ev.timestampNs;
+            uint32_t us = static_cast<uint32_t>(latencyNs / 1000ULL);
+            S_DebounceStats& stats = m_stats[input.sig - SIG_FIRST];
+            stats.latencySumUs += us;
+            if (us > stats.latencyMaxUs) stats.latencyMaxUs = us;
         }
     }
+    m_inputs.clear();
 }
@@ -1,7 +1,11 @@
 #ifndef SECUREASSETGUARD_C_TSIGHANDLER_H
 #define SECUREASSETGUARD_C_TSIGHANDLER_H
 /*
- * High-level thread that receives IRQ driver signals and wakes monitors.
+ * High-level thread that receives hardware input events and wakes monitors/inboxes.
+ * Source (site map irq_source): the IRQ kernel module (RT signals 43..48) or GPIO
+ * edge events polled directly (no module, kernel timestamps). GPIO inputs reuse
+ * the signal numbers as input kinds. Room inputs are routed to a room by pin;
+ * bursty inputs (reed switches, PIR) go through a debounce stage per kind and room.
  */
 #include <csignal>
 #include <cerrno>
@@ -9,28 +13,86 @@
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include "C_Thread.h"
+#include "C_GPIO.h"
 #include "C_Monitor.h"
+#include "C_UnitEvents.h"
+#include "C_SiteMap.h"
 #include"SharedTypes.h"
 #define IRQ_IOC_MAGIC  'k'
 #define REGIST_PID     _IOW(IRQ_IOC_MAGIC, 1, int)
 
+#define SIG_FIRST      43
+#define SIG_LAST       48
+#define SIG_COUNT      (SIG_LAST - SIG_FIRST + 1)
+
+static_assert(SIG_COUNT == SITE_INPUT_KINDS, "one debounce setting per input signal");
+
+// Per-signal counters, readable from other threads.
+struct S_DebounceStats {
+    std::atomic<uint32_t> received{0};
+    std::atomic<uint32_t> delivered{0};
+    std::atomic<uint32_t> coalesced{0};   // Merged inside a hold-off window.
+    std::atomic<uint32_t> rateLimited{0}; // Dropped by the minimum interval.
+    std::atomic<uint32_t> rejected{0};    // Windows that never reached minEdges.
+    // Edge timestamp -> dispatch (GPIO source only).
+    std::atomic<uint32_t> latencyMaxUs{0};
+    std::atomic<uint64_t> latencySumUs{0};
+};
+
 class C_tSighandler : public C_Thread {
 
-    C_Monitor& m_monReed_room;
+    struct S_DebounceState {
+        S_Debounce cfg;
+        bool windowOpen;
+        bool windowDelivered;
+        int64_t windowEnd;
+        int windowEdges;
+        int64_t lastDelivered;
+    };
+
+    const C_SiteMap& m_site;
+    C_UnitEvents& m_roomEntry;     // RFID entry + reed, per room.
+    C_UnitEvents& m_roomExit;      // RFID exit + reed, per room.
+    C_UnitEvents& m_pir;
     C_Monitor& m_monReed_vault;
-    C_Monitor& m_monPIR;
     C_Monitor& m_monFinger;
-    C_Monitor& m_monRFID_entry;
-    C_Monitor& m_monRFID_exit;
 
     int m_fd;
     sigset_t m_sigSet;
 
+    // GPIO source: one edge input per room/vault line.
+    struct S_EdgeInput {
+        std::unique_ptr<C_GPIO> gpio;
+        int sig;
+        int unit;
+    };
+    std::vector<S_EdgeInput> m_inputs;
+
+    S_DebounceState m_debounce[SIG_COUNT][SITE_MAX_ROOMS];
+    S_DebounceStats m_stats[SIG_COUNT];
+
+    int unitFor(int sig, int pino) const;
+    bool acceptEvent(int sig, int unit, int64_t nowMs);
+    // edgeNs travels with the event so the flows can measure edge-to-handler latency.
+    void dispatch(int sig, int unit, int pino, uint64_t edgeNs);
+    void logStats() const;
+
+    void runDriver();
+    bool openEdgeInputs();
+    void runGpio();
+    void addEdgeInput(int sig, int unit, int pin);
+
 public:
-    C_tSighandler(C_Monitor& reed_room,C_Monitor& reed_vault, C_Monitor& pir, C_Monitor& finger, C_Monitor& rfid_entry,C_Monitor& rfid_exit);
+    C_tSighandler(const C_SiteMap& site, C_UnitEvents& roomEntry, C_UnitEvents& roomExit, C_UnitEvents& pir, C_Monitor& reed_vault, C_Monitor& finger);
      ~C_tSighandler() override;
     static void setupSignalBlock();
+    void setDebounce(int sig, const S_Debounce& cfg);
+    const S_DebounceStats* getStats(int sig) const;
     void run() override;
 };
 
@@ -0,0 +1,25 @@
+/*
+ * Flow: epoll over open UARTs (1 s ticks) -> read into ring -> decode -> frame queue.
+ */
+
+#include "C_tUartRx.h"
+#include "C_Logger.h"
+
+C_tUartRx::C_tUartRx(C_UARTLoop& loop)
+    : C_Thread(PRIO_HIGH),
+      m_loop(loop)
+{
+}
+
+void C_tUartRx::run() {
+    LOG_INFO("[UartRx] Thread iniciada.");
+    m_loop.setRunning(true);
+
+    while (!stopRequested()) {
+        m_loop.poll(1000);
+    }
+
+    // Device threads still waiting fall back to reading inline.
+    m_loop.setRunning(false);
+    LOG_INFO("[UartRx] Thread terminada");
+}
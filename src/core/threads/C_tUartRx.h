@@ -0,0 +1,23 @@
+#ifndef C_TUARTRX_H
+#define C_TUARTRX_H
+
+/*
+ * UART receive thread: drains every open port into its ring and decodes frames.
+ */
+
+#include "C_Thread.h"
+#include "C_UARTLoop.h"
+#include "SharedTypes.h"
+
+class C_tUartRx : public C_Thread {
+private:
+    C_UARTLoop& m_loop;
+
+public:
+    explicit C_tUartRx(C_UARTLoop& loop);
+    ~C_tUartRx() override = default;
+
+    void run() override;
+};
+
+#endif
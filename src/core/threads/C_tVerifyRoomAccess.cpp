@@ -1,21 +1,27 @@
 /*
- * Flow: wait for RFID event -> query DB -> trigger servo/alarms -> write log.
+ * Flow: wait for RFID/reed events of any room -> query DB -> trigger servo/alarms -> write log.
  */
 
 #include "C_tVerifyRoomAccess.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <cstring>
 #include <ctime>
 
-C_tVerifyRoomAccess::C_tVerifyRoomAccess(C_Monitor& monitorrfid, C_Monitor& m_monitorservoroom, C_RDM6300& rfid, C_Mqueue& mqDB, C_Mqueue& mqFromDB,C_Mqueue& mqAct)
-    : C_Thread(PRIO_MEDIUM),m_monitorrfid(monitorrfid),
-      m_monitorservoroom(m_monitorservoroom),
-      m_rfidEntry(rfid),
+// Vault-level users (room + fingerprint) likely head to the vault next.
+static constexpr uint32_t ACCESS_LEVEL_VAULT = 2;
+
+C_tVerifyRoomAccess::C_tVerifyRoomAccess(C_UnitEvents& events, const std::vector<C_Room*>& rooms, C_Mqueue& mqDB, C_Mqueue& mqFromDB, C_Mqueue& mqAct, C_Outbox& outbox, C_RuleEngine& rules, C_PowerPolicy& power, uint16_t vaultRoomId)
+    : C_Thread(PRIO_MEDIUM),m_events(events),
+      m_rooms(rooms),
       m_mqToDatabase(mqDB), 
       m_mqToVerifyRoom(mqFromDB), 
       m_mqToActuator(mqAct), 
-      m_maxAttempts(3),
-      m_failedAttempts(0) {
+      m_outbox(outbox),
+      m_rules(rules),
+      m_power(power),
+      m_vaultRoomId(vaultRoomId),
+      m_doorsOpen(0),
+      m_replyTimeoutS(ACCESS_REPLY_TIMEOUT_DEFAULT) {
     
 }
 
@@ -23,108 +29,132 @@ C_tVerifyRoomAccess::~C_tVerifyRoomAccess() {
     
 }
 
+void C_tVerifyRoomAccess::setReplyTimeout(int seconds) {
+    m_replyTimeoutS.store(seconds);
+}
+
 
 void C_tVerifyRoomAccess::run() {
-    std::cout << "[VerifyRoomAccess] Thread iniciada. À espera de tags..." << std::endl;
+    LOG_INFO("[VerifyRoomAccess] Thread iniciada (%zu salas). À espera de tags...", m_rooms.size());
 
-    // Main loop: wait for RFID monitor signal.
+    // Main loop: events of every room arrive in one inbox.
     while (!stopRequested()) {
 
-        // timedWait returns true on timeout; loop continues.
-        if (m_monitorrfid.timedWait(1)) {
+        // take() returns 0 on timeout; loop continues.
+        uint64_t edgesNs[UNIT_EVENTS_BITS];
+        uint32_t events = m_events.take(1, edgesNs);
+        if (events == 0) {
             continue;
         }
 
-        SensorData data = {}; 
-
-        // Read entry RFID.
-        if (m_rfidEntry.read(&data)) {
-            const char* rfidRead = data.data.rfid_single.tagID;
-            std::cout << "[RFID entry] Cartão lido: " << rfidRead << std::endl;
-
-            // Send authorization request to DB.
-            DatabaseMsg msg = {};
-            msg.command = DB_CMD_ENTER_ROOM_RFID;
-            strncpy(msg.payload.rfid, rfidRead, sizeof(msg.payload.rfid) - 1);
-            msg.payload.rfid[sizeof(msg.payload.rfid) - 1] = '\0';
-            m_mqToDatabase.send(&msg, sizeof(msg));
-            std::cout << "m enviafa: " << std::endl;
-
-            // Wait for DB response with timeout to allow stop.
-            while (!stopRequested()) {
-                
-                AuthResponse resp = {};
-                ssize_t bytes = m_mqToVerifyRoom.timedReceive(&resp, sizeof(resp), 1);
-
-                if (bytes > 0) {
-                    // DB response: authorized vs. denied.
-                    if (resp.payload.auth.authorized) {
-                        std::cout << "[RFID] Acesso Autorizado! UserID: " << static_cast<unsigned int>(resp.payload.auth.userId) << std::endl;
-                        m_failedAttempts = 0;
-
-                        // Open room door and log access.
-                        ActuatorCmd cmd = {ID_SERVO_ROOM, 0};
-                        m_mqToActuator.send(&cmd, sizeof(cmd));
-                        sendLog(static_cast<uint32_t>(resp.payload.auth.userId),
-                                static_cast<uint32_t>(resp.payload.auth.accessLevel),
-                                true);
-
-                        // Wait for door reed switch to close.
-                        while (!stopRequested()) {
-                            if (!m_monitorservoroom.timedWait(1)) {
-                                break; 
-                            }
-                        }
-
-                        if (stopRequested()) break;
-                        // Close room door.
-                        cmd = {ID_SERVO_ROOM, 90};
-                        m_mqToActuator.send(&cmd, sizeof(cmd));
-                    }
-                    else {
-                        // Track failed attempts and trigger alarm if needed.
-                        m_failedAttempts++;
-                        std::cerr << "[RFID] Negado! Tentativa " << m_failedAttempts << "/" << m_maxAttempts << std::endl;
-
-                        if (m_failedAttempts >= m_maxAttempts) {
-                            m_failedAttempts = 0;
-                            ActuatorCmd alarm = {ID_ALARM_ACTUATOR, 1};
-                            m_mqToActuator.send(&alarm, sizeof(alarm));
-                            sendLog(0U, 0U, false);
-                        }
-                    }
-                    break; 
-                }
+        for (C_Room* room : m_rooms) {
+            if (stopRequested()) break;
+
+            // Door passage first: relock doors this thread opened.
+            if (C_UnitEvents::has(events, room->index(), ROOM_EVT_REED) &&
+                (m_doorsOpen & (1u << room->index()))) {
+                closeDoor(*room);
+            }
+
+            if (C_UnitEvents::has(events, room->index(), ROOM_EVT_RFID)) {
+                handleCard(*room, C_UnitEvents::edgeOf(edgesNs, room->index(), ROOM_EVT_RFID));
             }
         }
     }
 
-    std::cout << "[VerifyRoomAccess] Thread terminada com sucesso." << std::endl;
+    LOG_INFO("[VerifyRoomAccess] Thread terminada com sucesso.");
 }
 
+void C_tVerifyRoomAccess::handleCard(C_Room& room, uint64_t edgeNs) {
+    SensorData data = {}; 
 
-void C_tVerifyRoomAccess::generateDescription(uint32_t userId, bool authorized, char* buffer, size_t size) {
-    if (!authorized) {
-        // Access denied log message.
-        snprintf(buffer, size, "ACESSO NEGADO: Cartão ou Utilizador não reconhecido");
-    } else {
-        // Access granted log message.
-        snprintf(buffer, size, "Utilizador %u ENTROU na sala", userId);
+    // Read entry RFID.
+    if (!room.rfidEntry().read(&data)) {
+        return;
     }
+
+    const char* rfidRead = data.data.rfid_single.tagID;
+    LOG_INFO("[RFID entry] %s: cartão lido: %s", room.name(), rfidRead);
+
+    // Send authorization request to DB.
+    DatabaseMsg msg = {};
+    msg.command = DB_CMD_ENTER_ROOM_RFID;
+    msg.roomId = room.id();
+    strncpy(msg.payload.rfid, rfidRead, sizeof(msg.payload.rfid) - 1);
+    msg.payload.rfid[sizeof(msg.payload.rfid) - 1] = '\0';
+
+    // Drop a late reply left over from a request that timed out.
+    AuthResponse stale = {};
+    while (m_mqToVerifyRoom.timedReceive(&stale, sizeof(stale), 0) > 0) {}
+
+    if (!m_mqToDatabase.trySend(&msg, sizeof(msg))) {
+        LOG_WARN("[RFID] BD indisponível: acesso recusado");
+        return;
+    }
+
+    // Wait for DB response with timeout to allow stop.
+    int waited = 0;
+    const int timeoutS = m_replyTimeoutS.load();
+    while (!stopRequested()) {
+        if (waited++ >= timeoutS) {
+            LOG_WARN("[RFID] BD sem resposta: acesso recusado");
+            return;
+        }
+
+        AuthResponse resp = {};
+        ssize_t bytes = m_mqToVerifyRoom.timedReceive(&resp, sizeof(resp), 1);
+        if (bytes <= 0) continue;
+
+        // Requests are serialized: a reply for another room is stale.
+        if (resp.roomId != room.id()) continue;
+
+        // DB response: authorized vs. denied.
+        if (resp.payload.auth.authorized) {
+            uint32_t userId = static_cast<uint32_t>(resp.payload.auth.userId);
+            LOG_INFO("[RFID] %s: acesso autorizado! UserID: %u", room.name(), static_cast<unsigned int>(userId));
+            room.occupancy().enter(userId);
+            m_rules.fire(REVT_ACCESS_GRANTED, static_cast<double>(userId), 0.0, room.id());
+            if (room.id() == m_vaultRoomId &&
+                static_cast<uint32_t>(resp.payload.auth.accessLevel) >= ACCESS_LEVEL_VAULT) {
+                m_power.request(PREWAKE_FINGERPRINT);
+            }
+
+            // Open room door and log access; the next reed event relocks it.
+            ActuatorCmd cmd(ID_SERVO_ROOM, 0, room.id());
+            m_mqToActuator.send(&cmd, sizeof(cmd));
+            LOG_DEBUG("[RFID] %s: porta comandada %u us após o cartão", room.name(), sinceEdgeUs(edgeNs));
+            m_doorsOpen |= 1u << room.index();
+            sendLog(room.id(), userId, static_cast<uint32_t>(resp.payload.auth.accessLevel), true);
+        }
+        else {
+            // Failed-attempt counting and alarm are rule driven.
+            LOG_WARN("[RFID] %s: negado! Tentativas: %.0f", room.name(),
+                     m_rules.getVar(RVAR_FAILED_SWIPES, room.id()) + 1.0);
+            m_rules.fire(REVT_ACCESS_DENIED, 0.0, 0.0, room.id());
+        }
+        return;
+    }
+}
+
+void C_tVerifyRoomAccess::closeDoor(C_Room& room) {
+    // Close room door after passage.
+    ActuatorCmd cmd(ID_SERVO_ROOM, 90, room.id());
+    m_mqToActuator.send(&cmd, sizeof(cmd));
+    m_doorsOpen &= ~(1u << room.index());
 }
 
-void C_tVerifyRoomAccess::sendLog(uint32_t userId, uint32_t accessLevel, bool authorized) {
+
+void C_tVerifyRoomAccess::sendLog(uint16_t roomId, uint32_t userId, uint32_t accessLevel, bool authorized) {
     DatabaseMsg msg = {};
     msg.command = DB_CMD_WRITE_LOG;
+    msg.roomId = roomId;
 
     // LOG_TYPE_ACCESS vs LOG_TYPE_ALERT.
     msg.payload.log.logType = authorized ? LOG_TYPE_ACCESS : LOG_TYPE_ALERT;
+    msg.payload.log.eventCode = authorized ? EVT_ROOM_ENTER : EVT_ROOM_DENIED;
     msg.payload.log.entityID = userId;
     msg.payload.log.value = static_cast<double>(accessLevel);
     msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
 
-    // Human-readable description for UI.
-    generateDescription(userId, authorized, msg.payload.log.description, sizeof(msg.payload.log.description));
-
-    m_mqToDatabase.send(&msg, sizeof(DatabaseMsg), 0);
+    m_outbox.post(msg);
 }
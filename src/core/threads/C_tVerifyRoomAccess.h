@@ -2,41 +2,57 @@
 #define C_TVERIFYROOMACCESS_H
 
 /*
- * Room access verification thread via entry RFID.
+ * Room access verification thread via entry RFID (serves every room).
  */
 
+#include <atomic>
+#include <vector>
+
 #include "C_Thread.h"
 #include "C_Mqueue.h"
-#include "C_Monitor.h"
-#include "C_RDM6300.h"
+#include "C_UnitEvents.h"
+#include "C_Room.h"
+#include "C_Outbox.h"
+#include "C_RuleEngine.h"
+#include "C_PowerPolicy.h"
 #include "SharedTypes.h"
 
 class C_tVerifyRoomAccess : public C_Thread {
 private:
     
-    C_Monitor& m_monitorrfid;
-    C_Monitor& m_monitorservoroom;
-    C_RDM6300& m_rfidEntry;
+    C_UnitEvents& m_events;
+    std::vector<C_Room*> m_rooms;
     C_Mqueue& m_mqToDatabase;   
     C_Mqueue& m_mqToVerifyRoom;
     C_Mqueue& m_mqToActuator;
+    C_Outbox& m_outbox;
+    C_RuleEngine& m_rules;
+    C_PowerPolicy& m_power;
+    uint16_t m_vaultRoomId;
 
-    int m_failedAttempts;
-    int m_maxAttempts;
+    // Rooms whose door this thread unlocked (relocked on the next reed event).
+    uint32_t m_doorsOpen;
+    std::atomic<int> m_replyTimeoutS;
 
-    void sendLog(uint32_t userId, uint32_t accessLevel, bool isInside);
+    // edgeNs: when the reader's trigger fired (latency of the decision).
+    void handleCard(C_Room& room, uint64_t edgeNs);
+    void closeDoor(C_Room& room);
+    void sendLog(uint16_t roomId, uint32_t userId, uint32_t accessLevel, bool isInside);
 
 public:
     
-    C_tVerifyRoomAccess(C_Monitor& monitorrfid,
-                        C_Monitor& m_monitorservoroom,
-                        C_RDM6300& rfid,
+    C_tVerifyRoomAccess(C_UnitEvents& events,
+                        const std::vector<C_Room*>& rooms,
                         C_Mqueue& mqDB,
                         C_Mqueue& mqFromDB,
-                        C_Mqueue& mqAct);
+                        C_Mqueue& mqAct,
+                        C_Outbox& outbox,
+                        C_RuleEngine& rules,
+                        C_PowerPolicy& power,
+                        uint16_t vaultRoomId);
 
     virtual ~C_tVerifyRoomAccess();
-    void generateDescription(uint32_t userId, bool authorized, char* buffer, size_t size);
+    void setReplyTimeout(int seconds);
     void run() override; 
 };
 
@@ -3,32 +3,36 @@
  */
 
 #include "C_tVerifyVaultAccess.h"
-#include <iostream>
+#include "C_Logger.h"
 #include <ctime>
 #include <unistd.h>
 
 #include "SharedTypes.h"
 
-
 c_tVerifyVaultAccess::c_tVerifyVaultAccess(C_Monitor& m_monitorfgp,
                                          C_Monitor& m_monitorservovault,
                                          C_Fingerprint& m_fingerprint,
-                                         C_Mqueue& m_mqToDatabase,
+                                         C_Outbox& outbox,
                                          C_Mqueue& m_mqToActuator,
-                                         C_Mqueue& mqFromDatabase)
+                                         C_Mqueue& mqFromDatabase,
+                                         C_PowerPolicy& power,
+                                         const S_VaultMap& vault)
     : C_Thread(PRIO_MEDIUM),m_monitorfgp(m_monitorfgp),
       m_monitorservovault( m_monitorservovault),
       m_fingerprint(m_fingerprint),
-      m_mqToDatabase(m_mqToDatabase),
+      m_outbox(outbox),
       m_mqToActuator(m_mqToActuator),
-      m_mqFromDatabase(mqFromDatabase)
+      m_mqFromDatabase(mqFromDatabase),
+      m_power(power),
+      m_vaultId(vault.id),
+      m_roomId(vault.roomId)
 
 {}
 
 c_tVerifyVaultAccess::~c_tVerifyVaultAccess() = default;
 
 void c_tVerifyVaultAccess::run() {
-    std::cout << "[VaultAccess] Thread iniciada. Sensor Biométrico ativo." << std::endl;
+    LOG_INFO("[VaultAccess] Thread iniciada. Sensor Biométrico ativo.");
     SensorData data={};
 
     AuthResponse cmdMsg = {};
@@ -42,15 +46,27 @@ void c_tVerifyVaultAccess::run() {
             } else if (cmdMsg.command == DB_CMD_DELETE_USER) {
                 m_fingerprint.wakeUp();
                 m_fingerprint.deleteUser(static_cast<int>(cmdMsg.payload.auth.userId));
-                m_fingerprint.sleep();
+                if (!m_power.active(PREWAKE_FINGERPRINT)) {
+                    m_fingerprint.sleep();
+                }
             }
         }
 
+        // Pre-wake decisions are applied on this 1 s tick.
+        PreWakeAction_enum preWake = m_power.poll(PREWAKE_FINGERPRINT);
+        if (preWake == PREWAKE_WAKE) {
+            LOG_INFO("[VaultAccess] Pre-wake do sensor biométrico");
+            m_fingerprint.wakeUp();
+        } else if (preWake == PREWAKE_SLEEP) {
+            m_fingerprint.sleep();
+        }
+
         // Wait for biometric sensor trigger.
         if (m_monitorfgp.timedWait(1)) {
             continue;
         }
-        std::cout << "[finger ativou " <<  std::endl;
+        LOG_DEBUG("[VaultAccess] Sensor biométrico ativado (%u us após a borda)",
+                  sinceEdgeUs(m_monitorfgp.edgeNs()));
         m_fingerprint.wakeUp();
 
         if (pendingAddUserId > 0) {
@@ -58,15 +74,17 @@ void c_tVerifyVaultAccess::run() {
             m_fingerprint.addUser(static_cast<int>(pendingAddUserId));
             pendingAddUserId = 0;
             m_fingerprint.sleep();
+            m_power.release(PREWAKE_FINGERPRINT);
             continue;
         }
 
         // Normal mode: authenticate and open vault.
         if (m_fingerprint.read(&data)) {
             if (data.data.fingerprint.authenticated) {
-                ActuatorCmd cmd = {ID_SERVO_VAULT, 0};
+                ActuatorCmd cmd(ID_SERVO_VAULT, 0, m_vaultId);
                 m_mqToActuator.send(&cmd, sizeof(cmd));
-                
+                m_power.request(PREWAKE_UHF);
+
                 sendLog(static_cast<uint32_t>(data.data.fingerprint.userID), true);
 
                 // Wait for vault reed switch.
@@ -79,7 +97,7 @@ void c_tVerifyVaultAccess::run() {
                     break;
                 }
                 // Close the vault.
-                cmd = {ID_SERVO_VAULT, 90};
+                cmd = ActuatorCmd(ID_SERVO_VAULT, 90, m_vaultId);
                 m_mqToActuator.send(&cmd, sizeof(cmd));
             } else {
                 sendLog(0U, false);
@@ -87,6 +105,7 @@ void c_tVerifyVaultAccess::run() {
         }
 
         m_fingerprint.sleep();
+        m_power.release(PREWAKE_FINGERPRINT);
     }
 
 }
@@ -94,19 +113,14 @@ void c_tVerifyVaultAccess::run() {
 
 
 
-void c_tVerifyVaultAccess::generateDescription(uint32_t userId, bool authorized, char* buffer, size_t size) {
-    if (authorized) {
-        snprintf(buffer, size, "Cofre Aberto - Utilizador ID: %u", userId);
-    } else {
-        snprintf(buffer, size, "Tentativa falhada no Cofre - ID desconhecido");
-    }
-}
-
 void c_tVerifyVaultAccess::sendLog(uint32_t userId, bool authorized) {
     DatabaseMsg msg = {};
     msg.command = DB_CMD_WRITE_LOG;
+    msg.roomId = m_roomId;
+    msg.vaultId = m_vaultId;
 
     msg.payload.log.logType = authorized ? LOG_TYPE_ACCESS : LOG_TYPE_ALERT;
+    msg.payload.log.eventCode = authorized ? EVT_VAULT_OPEN : EVT_VAULT_DENIED;
 
     // Log the event for UI and audit.
     msg.payload.log.entityID = userId;
@@ -114,7 +128,5 @@ void c_tVerifyVaultAccess::sendLog(uint32_t userId, bool authorized) {
     msg.payload.log.value = authorized ? 1.0 : 0.0;
     msg.payload.log.timestamp = static_cast<uint32_t>(time(nullptr));
 
-    generateDescription(userId, authorized, msg.payload.log.description, sizeof(msg.payload.log.description));
-
-    m_mqToDatabase.send(&msg, sizeof(DatabaseMsg));
+    m_outbox.post(msg);
 }
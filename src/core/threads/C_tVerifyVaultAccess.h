@@ -9,19 +9,25 @@
 #include "C_Thread.h"
 #include "C_Monitor.h"
 #include "C_Mqueue.h"
+#include "C_Outbox.h"
+#include "C_PowerPolicy.h"
+#include "C_SiteMap.h"
 
 class c_tVerifyVaultAccess : public C_Thread {
         C_Monitor& m_monitorfgp;
         C_Monitor& m_monitorservovault;
         C_Fingerprint& m_fingerprint;
-        C_Mqueue& m_mqToDatabase;
+        C_Outbox& m_outbox;
         C_Mqueue& m_mqToActuator;
         C_Mqueue& m_mqFromDatabase;
+        C_PowerPolicy& m_power;
+        // Stamped on the vault logs.
+        uint16_t m_vaultId;
+        uint16_t m_roomId;
     public:
-        c_tVerifyVaultAccess(C_Monitor& m_monitor,C_Monitor& m_monitorservovault, C_Fingerprint& m_fingerprint,C_Mqueue& m_mqToDatabase,C_Mqueue& m_mqToActuator, C_Mqueue& m_mqFromDatabase);
+        c_tVerifyVaultAccess(C_Monitor& m_monitor,C_Monitor& m_monitorservovault, C_Fingerprint& m_fingerprint,C_Outbox& outbox,C_Mqueue& m_mqToActuator, C_Mqueue& m_mqFromDatabase, C_PowerPolicy& power, const S_VaultMap& vault);
         ~c_tVerifyVaultAccess() override;
         void run() override;
-        void generateDescription(uint32_t userId, bool authorized, char* buffer, size_t size);
         void sendLog(uint32_t userId, bool authorized);
 };
 
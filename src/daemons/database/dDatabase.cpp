@@ -3,6 +3,7 @@
  */
 
 #include "dDatabase.h"
+#include "C_Logger.h"
 #include <iostream>
 #include <argon2.h>
 #include <cstdlib>
@@ -69,6 +70,28 @@ void bindTextOrNull(sqlite3_stmt* stmt, int index, const char* text) {
     }
 }
 
+// Asset tags: 24-hex-digit EPCs are keyed as 12-byte BLOBs (as the scan
+// stores them); anything else is a legacy TEXT tag.
+void bindTag(sqlite3_stmt* stmt, int index, const char* tag) {
+    uint8_t epc[INVENTORY_EPC_BYTES];
+    if (epcFromHex(tag, epc)) {
+        sqlite3_bind_blob(stmt, index, epc, INVENTORY_EPC_BYTES, SQLITE_TRANSIENT);
+    } else {
+        bindTextOrNull(stmt, index, tag);
+    }
+}
+
+std::string columnTag(sqlite3_stmt* stmt, int column) {
+    if (sqlite3_column_type(stmt, column) == SQLITE_BLOB &&
+        sqlite3_column_bytes(stmt, column) == INVENTORY_EPC_BYTES) {
+        char hex[INVENTORY_EPC_HEX_SIZE];
+        epcToHex(static_cast<const uint8_t*>(sqlite3_column_blob(stmt, column)), hex);
+        return hex;
+    }
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return text ? text : "";
+}
+
 std::string getUserNameById(sqlite3* db, uint32_t userId) {
     sqlite3_stmt* stmt = nullptr;
     std::string name;
@@ -85,6 +108,40 @@ std::string getUserNameById(sqlite3* db, uint32_t userId) {
     }
     return name;
 }
+
+std::string getAssetNameById(sqlite3* db, uint32_t assetId) {
+    sqlite3_stmt* stmt = nullptr;
+    std::string name;
+    const char* sql = "SELECT Name FROM Assets WHERE AssetID = ?;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, static_cast<int>(assetId));
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            if (value) {
+                name = value;
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    return name;
+}
+
+std::string getUserNameByFingerprint(sqlite3* db, uint32_t fingerId) {
+    sqlite3_stmt* stmt = nullptr;
+    std::string name;
+    const char* sql = "SELECT Name FROM Users WHERE FingerprintID = ?;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, static_cast<int>(fingerId));
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            if (value) {
+                name = value;
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    return name;
+}
 }
 
 dDatabase::dDatabase(const std::string& dbPath,
@@ -94,7 +151,8 @@ dDatabase::dDatabase(const std::string& dbPath,
                    C_Mqueue& mqFinger,
                    C_Mqueue& m_mqToCheckMovement,
                    C_Mqueue& mqToWeb,
-                   C_Mqueue& mqToEnv)   
+                   C_Mqueue& mqToEnv,
+                   C_Mqueue& mqToInventory)
     : m_db(nullptr),
       m_dbPath(dbPath),
       m_mqToDatabase(mqDb),
@@ -103,7 +161,10 @@ dDatabase::dDatabase(const std::string& dbPath,
       m_mqToFingerprint(mqFinger),
       m_mqToCheckMovement(m_mqToCheckMovement),
       m_mqToWeb(mqToWeb),
-      m_mqToEnvThread(mqToEnv)      
+      m_mqToEnvThread(mqToEnv),
+      m_mqToInventory(mqToInventory),
+      m_outboxEpoch(0),
+      m_outboxLastSeq(0)
 {
 }
 
@@ -117,8 +178,7 @@ bool dDatabase::open() {
     int result = sqlite3_open(m_dbPath.c_str(), &m_db);
 
     if (result != SQLITE_OK) {
-        std::cerr << "ERRO: Não foi possível abrir a base de dados: "
-                  << sqlite3_errmsg(m_db) << std::endl;
+        LOG_ERROR("ERRO: Não foi possível abrir a base de dados: %s", sqlite3_errmsg(m_db));
         return false;
     }
 
@@ -126,8 +186,7 @@ bool dDatabase::open() {
 
     // Apply SQLCipher key before any DB operation.
     if (sqlite3_key(m_db, key.data(), static_cast<int>(key.size())) != SQLITE_OK) {
-        std::cerr << "ERRO: Falha ao definir chave SQLCipher: "
-                  << sqlite3_errmsg(m_db) << std::endl;
+        LOG_ERROR("ERRO: Falha ao definir chave SQLCipher: %s", sqlite3_errmsg(m_db));
         secureZero(key.data(), key.size());
         sqlite3_close(m_db);
         m_db = nullptr;
@@ -136,7 +195,7 @@ bool dDatabase::open() {
 
     secureZero(key.data(), key.size());
 
-    std::cout << "SUCESSO: Ligado ao ficheiro: " << m_dbPath << std::endl;
+    LOG_INFO("SUCESSO: Ligado ao ficheiro: %s", m_dbPath.c_str());
     return true;
 }
 
@@ -145,7 +204,7 @@ void dDatabase::close() {
         // Close open handle.
         sqlite3_close(m_db);
         m_db = nullptr; 
-        std::cout << "Base de dados fechada corretamente." << std::endl;
+        LOG_INFO("Base de dados fechada corretamente.");
     }
 }
 
@@ -153,11 +212,11 @@ void dDatabase::close() {
 bool dDatabase::initializeSchema() {
     // Create tables and seed default rows.
     if (!m_db) {
-        std::cerr << "Erro: A base de dados não está aberta!" << std::endl;
+        LOG_ERROR("Erro: A base de dados não está aberta!");
         return false;
     }
 
-    // Base schema: Users, Logs, Assets, Sensors, Actuators, SystemSettings.
+    // Base schema: Users, Logs, Assets, InventorySessions, Sensors, Actuators, SystemSettings.
     const char* sql =
         "CREATE TABLE IF NOT EXISTS Users ("
         "UserID INTEGER PRIMARY KEY AUTOINCREMENT, "
@@ -166,7 +225,8 @@ bool dDatabase::initializeSchema() {
         "FingerprintID INTEGER UNIQUE, "
         "Password TEXT, "
         "AccessLevel INTEGER, "
-        "IsInside INTEGER DEFAULT 0);"
+        "IsInside INTEGER DEFAULT 0, "
+        "InsideRoom INTEGER DEFAULT 0);"
 
         "CREATE TABLE IF NOT EXISTS Logs ("
         "LogsID INTEGER PRIMARY KEY AUTOINCREMENT, "
@@ -175,13 +235,27 @@ bool dDatabase::initializeSchema() {
         "LogType INTEGER, "
         "Description TEXT, "
         "Value REAL, "
-        "Value2 REAL DEFAULT 0);"
+        "Value2 REAL DEFAULT 0, "
+        "EventCode INTEGER DEFAULT 0, "
+        "RoomID INTEGER DEFAULT 0, "
+        "VaultID INTEGER DEFAULT 0);"
 
         "CREATE TABLE IF NOT EXISTS Assets ("
         "AssetID INTEGER PRIMARY KEY AUTOINCREMENT, "
         "Name TEXT, "
-        "RFID_Tag TEXT UNIQUE, "
-        "LastRead INTEGER);"
+        "RFID_Tag BLOB UNIQUE, "
+        "LastRead INTEGER, "
+        "MissingSince INTEGER DEFAULT 0);"
+
+        "CREATE TABLE IF NOT EXISTS InventorySessions ("
+        "SessionID INTEGER PRIMARY KEY, "
+        "VaultID INTEGER DEFAULT 0, "
+        "RoomID INTEGER DEFAULT 0, "
+        "StartedAt INTEGER, "
+        "EndedAt INTEGER DEFAULT 0, "
+        "Batches INTEGER DEFAULT 0, "
+        "Tags INTEGER DEFAULT 0, "
+        "Complete INTEGER DEFAULT 0);"
 
         "CREATE TABLE IF NOT EXISTS Sensors ("
         "SensorID INTEGER PRIMARY KEY AUTOINCREMENT, "
@@ -198,13 +272,18 @@ bool dDatabase::initializeSchema() {
         "CREATE TABLE IF NOT EXISTS SystemSettings ("
         "ID INTEGER PRIMARY KEY CHECK (ID = 1), "
         "TempThreshold INTEGER DEFAULT 30, "
-        "SamplingTime INTEGER DEFAULT 600);";
+        "SamplingTime INTEGER DEFAULT 600);"
+
+        "CREATE TABLE IF NOT EXISTS OutboxState ("
+        "ID INTEGER PRIMARY KEY CHECK (ID = 1), "
+        "Epoch INTEGER DEFAULT 0, "
+        "LastSeq INTEGER DEFAULT 0);";
 
     char* errMsg = nullptr;
     int rc = sqlite3_exec(m_db, sql, nullptr, nullptr, &errMsg);
 
     if (rc != SQLITE_OK) {
-        std::cerr << "Erro ao criar tabelas: " << errMsg << std::endl;
+        LOG_ERROR("Erro ao criar tabelas: %s", errMsg);
         sqlite3_free(errMsg);
         return false;
     }
@@ -251,29 +330,305 @@ bool dDatabase::initializeSchema() {
         "('SERVO_ROOM', 1), ('SERVO_VAULT', 1), ('FAN', 0), ('ALARM', 0);";
     sqlite3_exec(m_db, insertActuators, nullptr, nullptr, nullptr);
 
+    migrateLogsSchema();
+    migrateSiteSchema();
+    migrateAssetsSchema();
+    loadOutboxState();
+
     return true;
 }
 
+void dDatabase::loadOutboxState() {
+    sqlite3_exec(m_db, "INSERT OR IGNORE INTO OutboxState (ID, Epoch, LastSeq) VALUES (1, 0, 0);",
+                 nullptr, nullptr, nullptr);
+
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT Epoch, LastSeq FROM OutboxState WHERE ID = 1;";
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            m_outboxEpoch = static_cast<uint32_t>(sqlite3_column_int64(stmt, 0));
+            m_outboxLastSeq = static_cast<uint32_t>(sqlite3_column_int64(stmt, 1));
+        }
+        sqlite3_finalize(stmt);
+    }
+}
+
+bool dDatabase::isOutboxDuplicate(const DatabaseMsg& msg) const {
+    // A new epoch (core outbox recreated) restarts the sequence.
+    return msg.outboxSeq != 0 &&
+           msg.outboxEpoch == m_outboxEpoch &&
+           msg.outboxSeq <= m_outboxLastSeq;
+}
+
+bool dDatabase::commitOutboxSeq(const DatabaseMsg& msg) {
+    // Runs inside the message's transaction: the effects and the sequence
+    // commit together, so a crash can neither replay nor lose the message.
+    sqlite3_stmt* stmt;
+    bool ok = false;
+    const char* sql = "UPDATE OutboxState SET Epoch = ?, LastSeq = ? WHERE ID = 1;";
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, msg.outboxEpoch);
+        sqlite3_bind_int64(stmt, 2, msg.outboxSeq);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+    }
+    return ok;
+}
+
+bool dDatabase::hasColumn(const char* table, const char* column) {
+    std::string pragma = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt* stmt;
+    bool found = false;
+    if (sqlite3_prepare_v2(m_db, pragma.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* col = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            if (col && strcmp(col, column) == 0) {
+                found = true;
+                break;
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    return found;
+}
+
+void dDatabase::migrateSiteSchema() {
+    // Multi-room controllers: events and occupancy carry the room/vault ID.
+    if (!hasColumn("Logs", "RoomID")) {
+        sqlite3_exec(m_db, "ALTER TABLE Logs ADD COLUMN RoomID INTEGER DEFAULT 0;", nullptr, nullptr, nullptr);
+    }
+    if (!hasColumn("Logs", "VaultID")) {
+        sqlite3_exec(m_db, "ALTER TABLE Logs ADD COLUMN VaultID INTEGER DEFAULT 0;", nullptr, nullptr, nullptr);
+    }
+    if (!hasColumn("Users", "InsideRoom")) {
+        sqlite3_exec(m_db, "ALTER TABLE Users ADD COLUMN InsideRoom INTEGER DEFAULT 0;", nullptr, nullptr, nullptr);
+    }
+    sqlite3_exec(m_db, "CREATE INDEX IF NOT EXISTS idx_logs_room_ts ON Logs (RoomID, Timestamp);",
+                 nullptr, nullptr, nullptr);
+}
+
+void dDatabase::migrateAssetsSchema() {
+    // Background inventory marks assets that stopped answering.
+    if (!hasColumn("Assets", "MissingSince")) {
+        sqlite3_exec(m_db, "ALTER TABLE Assets ADD COLUMN MissingSince INTEGER DEFAULT 0;", nullptr, nullptr, nullptr);
+    }
+
+    // Tags were stored as hex TEXT: rekey scanned EPCs as BLOBs, once.
+    sqlite3_stmt* sel;
+    sqlite3_stmt* upd;
+    const char* sqlSel = "SELECT AssetID, RFID_Tag FROM Assets WHERE typeof(RFID_Tag) = 'text';";
+    const char* sqlUpd = "UPDATE OR IGNORE Assets SET RFID_Tag = ? WHERE AssetID = ?;";
+    if (sqlite3_prepare_v2(m_db, sqlSel, -1, &sel, nullptr) != SQLITE_OK) return;
+    if (sqlite3_prepare_v2(m_db, sqlUpd, -1, &upd, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(sel);
+        return;
+    }
+
+    int converted = 0;
+    sqlite3_exec(m_db, "BEGIN;", nullptr, nullptr, nullptr);
+    while (sqlite3_step(sel) == SQLITE_ROW) {
+        uint8_t epc[INVENTORY_EPC_BYTES];
+        const char* tag = reinterpret_cast<const char*>(sqlite3_column_text(sel, 1));
+        if (!epcFromHex(tag, epc)) continue;
+        sqlite3_bind_blob(upd, 1, epc, INVENTORY_EPC_BYTES, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(upd, 2, sqlite3_column_int64(sel, 0));
+        if (sqlite3_step(upd) == SQLITE_DONE && sqlite3_changes(m_db) > 0) ++converted;
+        sqlite3_reset(upd);
+    }
+    sqlite3_exec(m_db, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_finalize(sel);
+    sqlite3_finalize(upd);
+
+    if (converted > 0) {
+        LOG_INFO("[DB] %d etiqueta(s) de ativos convertida(s) para EPC binário", converted);
+    }
+}
+
+void dDatabase::migrateLogsSchema() {
+    // Older databases predate the EventCode column.
+    sqlite3_stmt* stmt;
+    bool hasEventCode = false;
+    if (sqlite3_prepare_v2(m_db, "PRAGMA table_info(Logs);", -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* col = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            if (col && strcmp(col, "EventCode") == 0) {
+                hasEventCode = true;
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    if (!hasEventCode) {
+        sqlite3_exec(m_db, "ALTER TABLE Logs ADD COLUMN EventCode INTEGER DEFAULT 0;",
+                     nullptr, nullptr, nullptr);
+    }
+
+    // Dashboard and filter queries look up by event/type, newest first.
+    const char* indexes =
+        "CREATE INDEX IF NOT EXISTS idx_logs_event_ts ON Logs (EventCode, Timestamp);"
+        "CREATE INDEX IF NOT EXISTS idx_logs_type_ts ON Logs (LogType, Timestamp);";
+
+    char* errMsg = nullptr;
+    if (sqlite3_exec(m_db, indexes, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        LOG_ERROR("Erro ao criar indices de Logs: %s", errMsg);
+        sqlite3_free(errMsg);
+    }
+
+    if (hasEventCode) return;
+
+    // One-off backfill of legacy text rows (only runs when the column is added).
+    const char* backfill =
+        "BEGIN;"
+        "UPDATE Logs SET EventCode = 1  WHERE LogType = 2 AND Description LIKE '%ENTROU%';"
+        "UPDATE Logs SET EventCode = 3  WHERE LogType = 2 AND Description LIKE '%SAIU%';"
+        "UPDATE Logs SET EventCode = 4  WHERE LogType = 2 AND Description LIKE '%Cofre%';"
+        "UPDATE Logs SET EventCode = 2  WHERE LogType = 4 AND Description LIKE 'ACESSO NEGADO%';"
+        "UPDATE Logs SET EventCode = 5  WHERE LogType = 4 AND Description LIKE '%Cofre%';"
+        "UPDATE Logs SET EventCode = 6  WHERE LogType = 4 AND Description LIKE '%Movimento%';"
+        "UPDATE Logs SET EventCode = 8  WHERE LogType = 5;"
+        "UPDATE Logs SET EventCode = 9  WHERE LogType = 1;"
+        "UPDATE Logs SET EventCode = 10 WHERE LogType = 0;"
+        "COMMIT;";
+
+    if (sqlite3_exec(m_db, backfill, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        LOG_ERROR("Erro na migracao de Logs: %s", errMsg);
+        sqlite3_free(errMsg);
+        sqlite3_exec(m_db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    } else {
+        LOG_INFO("Logs migrados para EventCode.");
+    }
+}
+
+std::string dDatabase::renderLogText(int eventCode, uint32_t entityId, double value,
+                                     double value2, const char* legacyText) {
+    // Render display text from event code and parameters.
+    char buffer[128];
+    std::string name;
+
+    switch (eventCode) {
+        case EVT_ROOM_ENTER:
+        case EVT_ROOM_LEAVE:
+            name = getUserNameById(m_db, entityId);
+            if (name.empty()) name = std::to_string(entityId);
+            return "Utilizador " + name +
+                   (eventCode == EVT_ROOM_ENTER ? " ENTROU na sala" : " SAIU da sala");
+
+        case EVT_ROOM_DENIED:
+            return "ACESSO NEGADO: Cartão ou Utilizador não reconhecido";
+
+        case EVT_VAULT_OPEN:
+            name = getUserNameByFingerprint(m_db, entityId);
+            if (name.empty()) name = "ID " + std::to_string(entityId);
+            return "Cofre Aberto - Utilizador: " + name;
+
+        case EVT_VAULT_DENIED:
+            return "Tentativa falhada no Cofre - ID desconhecido";
+
+        case EVT_PIR_EMPTY_ROOM:
+            return "ALERTA: Movimento detetado em sala VAZIA!";
+
+        case EVT_PIR_MOTION:
+            return "Movimento detetado na sala";
+
+        case EVT_INVENTORY_SCAN:
+            snprintf(buffer, sizeof(buffer),
+                     "LEITURA INVENTÁRIO: %d itens confirmados após fecho", static_cast<int>(value));
+            return buffer;
+
+        case EVT_ASSET_APPEARED:
+        case EVT_ASSET_MISSING:
+            name = getAssetNameById(m_db, entityId);
+            if (name.empty()) name = "#" + std::to_string(entityId);
+            if (eventCode == EVT_ASSET_APPEARED) return "Item detetado no cofre: " + name;
+            snprintf(buffer, sizeof(buffer), "ALERTA: Item %s ausente do cofre (sem leitura há %d min)",
+                     name.c_str(), static_cast<int>(value2 / 60));
+            return buffer;
+
+        case EVT_ENV_READING:
+            snprintf(buffer, sizeof(buffer), "Leitura Ambiental: %.1f°C, %.1f HR", value, value2);
+            return buffer;
+
+        case EVT_ENV_RAPID_RISE:
+            snprintf(buffer, sizeof(buffer), "ALERTA: Subida rápida de temperatura (%.1f°C, %.1f°C/min)", value, value2);
+            return buffer;
+
+        case EVT_ENV_TEMP_DRIFT:
+            snprintf(buffer, sizeof(buffer), "ALERTA: Temperatura anómala (%.1f°C, média %.1f°C)", value, value2);
+            return buffer;
+
+        case EVT_ENV_HUM_SPIKE:
+            snprintf(buffer, sizeof(buffer), "ALERTA: Pico de humidade (%.1f HR, média %.1f HR)", value, value2);
+            return buffer;
+
+        case EVT_ENV_STUCK:
+            snprintf(buffer, sizeof(buffer), "ALERTA: Sensor ambiental sem variação (%.1f°C, %.1f HR)", value, value2);
+            return buffer;
+
+        case EVT_ACTUATOR_STATE: {
+            int state = static_cast<int>(value);
+            switch (entityId) {
+                case ID_SERVO_ROOM:
+                case ID_SERVO_VAULT:
+                    if (state == 0) return "Porta LIVRE (PWM OFF)";
+                    snprintf(buffer, sizeof(buffer), "Porta TRANCADA (%d°)", state);
+                    return buffer;
+                case ID_FAN:
+                    return state > 0 ? "Ventoinha LIGADA" : "Ventoinha DESLIGADA";
+                case ID_ALARM_ACTUATOR:
+                    return state > 0 ? "Alarme ATIVADO" : "Alarme DESATIVADO";
+                default:
+                    snprintf(buffer, sizeof(buffer), "Atuador %u Val %d", entityId, state);
+                    return buffer;
+            }
+        }
+
+        default:
+            // Legacy rows that could not be classified keep their stored text.
+            return legacyText ? legacyText : "";
+    }
+}
+
 void dDatabase::processDbMessage(const DatabaseMsg &msg) {
     /*
      * IPC dispatcher: routes DB commands from core/web to handlers.
      */
+    if (isOutboxDuplicate(msg)) {
+        LOG_DEBUG("Outbox: mensagem %u repetida ignorada", msg.outboxSeq);
+        return;
+    }
+
+    // Sequenced (outbox) messages run in one transaction with their sequence;
+    // handlers only open savepoints.
+    bool sequenced = msg.outboxSeq != 0;
+    if (sequenced) {
+        sqlite3_exec(m_db, "BEGIN;", nullptr, nullptr, nullptr);
+    }
+
     // Central dispatch of commands from core/web.
     switch (msg.command) {
         case DB_CMD_ENTER_ROOM_RFID:
-            handleAccessRequest(msg.payload.rfid, true);
+            handleAccessRequest(msg.payload.rfid, true, msg.roomId);
             break;
         case DB_CMD_LEAVE_ROOM_RFID:
-            handleAccessRequest(msg.payload.rfid, false);
+            handleAccessRequest(msg.payload.rfid, false, msg.roomId);
             break;
         case DB_CMD_UPDATE_ASSET:
-            handleScanInventory(msg.payload.rfidInventory);
+            handleScanInventory(msg.payload.rfidInventory, msg.roomId, msg.vaultId);
+            break;
+        case DB_CMD_INVENTORY_END:
+            handleInventoryEnd(msg.payload.rfidInventory);
+            break;
+        case DB_CMD_TAG_PRESENCE:
+            handleTagPresence(msg.payload.tagPresence, msg.roomId, msg.vaultId);
             break;
         case DB_CMD_WRITE_LOG:
-            handleInsertLog(msg.payload.log);
+            handleInsertLog(msg.payload.log, msg.roomId, msg.vaultId);
             break;
         case DB_CMD_USER_IN_PIR:
-            handleCheckUserInPir();
+            handleCheckUserInPir(msg.roomId);
+            break;
+        case DB_CMD_GET_PRESENT_TAGS:
+            handleGetPresentTags(msg.payload.requestId);
             break;
         case DB_CMD_LOGIN:
             handleLogin(msg.payload.login);
@@ -328,16 +683,29 @@ void dDatabase::processDbMessage(const DatabaseMsg &msg) {
             break;
         default: ;
     }
+
+    if (!sequenced) return;
+
+    if (commitOutboxSeq(msg) &&
+        sqlite3_exec(m_db, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK) {
+        m_outboxEpoch = msg.outboxEpoch;
+        m_outboxLastSeq = msg.outboxSeq;
+    } else {
+        // All or nothing: the message is not half applied nor marked as seen.
+        LOG_ERROR("Outbox: mensagem %u não gravada: %s", msg.outboxSeq, sqlite3_errmsg(m_db));
+        sqlite3_exec(m_db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
 }
 
 
-void dDatabase::handleAccessRequest(const char* rfid, bool isEntering) {
+void dDatabase::handleAccessRequest(const char* rfid, bool isEntering, uint16_t roomId) {
     // Verify RFID and respond with AuthResponse to the correct thread.
     sqlite3_stmt* stmt;
 
     AuthResponse resp = {};
 
     resp.command = isEntering ? DB_CMD_ENTER_ROOM_RFID : DB_CMD_LEAVE_ROOM_RFID;
+    resp.roomId = roomId;
 
     const char* sqlSelect = "SELECT UserID, AccessLevel FROM Users WHERE RFID_Card = ?;";
     if (sqlite3_prepare_v2(m_db, sqlSelect, -1, &stmt, nullptr) == SQLITE_OK) {
@@ -347,22 +715,21 @@ void dDatabase::handleAccessRequest(const char* rfid, bool isEntering) {
             resp.payload.auth.userId = static_cast<uint32_t>(sqlite3_column_int(stmt, 0));
             resp.payload.auth.accessLevel = static_cast<uint32_t>(sqlite3_column_int(stmt, 1));
 
-            cout << "\n[CHECK] User Encontrado!" << endl;
-            cout << " > UserID:      " << resp.payload.auth.userId << endl;
-            cout << " > AccessLevel: " << resp.payload.auth.accessLevel << endl;
-            cout << "----------------------------" << endl;
+            LOG_INFO("[CHECK] User encontrado: UserID=%u AccessLevel=%u",
+                     resp.payload.auth.userId, resp.payload.auth.accessLevel);
         }
         sqlite3_finalize(stmt);
     }
 
     if (resp.payload.auth.authorized) {
-        // Track occupancy for PIR checks.
+        // Track occupancy (and the room) for PIR checks.
         int newState = isEntering ? 1 : 0;
 
-        const char* sqlUpdate = "UPDATE Users SET IsInside = ? WHERE UserID = ?;";
+        const char* sqlUpdate = "UPDATE Users SET IsInside = ?, InsideRoom = ? WHERE UserID = ?;";
         if (sqlite3_prepare_v2(m_db, sqlUpdate, -1, &stmt, nullptr) == SQLITE_OK) {
             sqlite3_bind_int(stmt, 1, newState);
-            sqlite3_bind_int(stmt, 2, static_cast<int>(resp.payload.auth.userId));
+            sqlite3_bind_int(stmt, 2, isEntering ? static_cast<int>(roomId) : 0);
+            sqlite3_bind_int(stmt, 3, static_cast<int>(resp.payload.auth.userId));
             sqlite3_step(stmt);
             sqlite3_finalize(stmt);
         }
@@ -378,41 +745,21 @@ void dDatabase::handleAccessRequest(const char* rfid, bool isEntering) {
 }
 
 
-void dDatabase::handleInsertLog(const DatabaseLog& log) {
-    // Insert log record and update state tables.
+void dDatabase::handleInsertLog(const DatabaseLog& log, uint16_t roomId, uint16_t vaultId) {
+    // Insert log record (text is rendered on read) and update state tables.
     sqlite3_stmt* stmt;
-    std::string description = log.description;
-
-    if (log.logType == LOG_TYPE_ACCESS && log.entityID > 0) {
-        // Enrich access logs with user name when possible.
-        sqlite3_stmt* nameStmt;
-        const char* sqlName = "SELECT Name FROM Users WHERE UserID = ? OR FingerprintID = ? LIMIT 1;";
-
-        if (sqlite3_prepare_v2(m_db, sqlName, -1, &nameStmt, nullptr) == SQLITE_OK) {
-            sqlite3_bind_int(nameStmt, 1, log.entityID);
-            sqlite3_bind_int(nameStmt, 2, log.entityID);
-
-            if (sqlite3_step(nameStmt) == SQLITE_ROW) {
-                const char* n = (const char*)sqlite3_column_text(nameStmt, 0);
-                if (n) {
-                    std::string name(n);
-                    if (description.find("ENTROU") != std::string::npos) description = "Utilizador " + name + " ENTROU na sala";
-                    else if (description.find("SAIU") != std::string::npos) description = "Utilizador " + name + " SAIU da sala";
-                    else if (description.find("Cofre") != std::string::npos) description = "Cofre Aberto - Utilizador: " + name;
-                }
-            }
-            sqlite3_finalize(nameStmt);
-        }
-    }
 
-    const char* sql = "INSERT INTO Logs (LogType, EntityID, Value, Value2, Timestamp, Description) VALUES (?, ?, ?, ?, ?, ?);";
+    const char* sql = "INSERT INTO Logs (LogType, EventCode, EntityID, Value, Value2, Timestamp, RoomID, VaultID) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         sqlite3_bind_int(stmt, 1, static_cast<int>(log.logType));
-        sqlite3_bind_int(stmt, 2, static_cast<int>(log.entityID));
-        sqlite3_bind_double(stmt, 3, log.value);
-        sqlite3_bind_double(stmt, 4, log.value2);
-        sqlite3_bind_int(stmt, 5, static_cast<int>(log.timestamp));
-        sqlite3_bind_text(stmt, 6, description.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, static_cast<int>(log.eventCode));
+        sqlite3_bind_int(stmt, 3, static_cast<int>(log.entityID));
+        sqlite3_bind_double(stmt, 4, log.value);
+        sqlite3_bind_double(stmt, 5, log.value2);
+        sqlite3_bind_int(stmt, 6, static_cast<int>(log.timestamp));
+        sqlite3_bind_int(stmt, 7, static_cast<int>(roomId));
+        sqlite3_bind_int(stmt, 8, static_cast<int>(vaultId));
         sqlite3_step(stmt);
         sqlite3_finalize(stmt);
     }
@@ -473,22 +820,24 @@ void dDatabase::updateActuatorTable(uint8_t entityID, double value, uint32_t tim
 }
 
 
-void dDatabase::handleCheckUserInPir() {
+void dDatabase::handleCheckUserInPir(uint16_t roomId) {
     sqlite3_stmt* stmt;
 
     AuthResponse resp = {};
 
     resp.command = DB_CMD_USER_IN_PIR;
-    
-    // Count users marked as inside.
-    const char* sql = "SELECT COUNT(*) FROM Users WHERE IsInside = 1;";
+    resp.roomId = roomId;
+
+    // Count users inside the room (seeds the core's tracker at startup).
+    // Rows from before room tracking (InsideRoom = 0) count for every room.
+    const char* sql = "SELECT COUNT(*) FROM Users WHERE IsInside = 1 AND "
+                      "(? = 0 OR InsideRoom = ? OR InsideRoom = 0);";
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, static_cast<int>(roomId));
+        sqlite3_bind_int(stmt, 2, static_cast<int>(roomId));
         if (sqlite3_step(stmt) == SQLITE_ROW) {
-            int count = sqlite3_column_int(stmt, 0);
-            if (count > 0) {
-                resp.payload.auth.authorized = true; 
-            }
+            resp.payload.occupancy = static_cast<uint32_t>(sqlite3_column_int(stmt, 0));
         }
         sqlite3_finalize(stmt);
     }
@@ -497,47 +846,218 @@ void dDatabase::handleCheckUserInPir() {
     m_mqToCheckMovement.send(&resp, sizeof(resp));
 }
 
-void dDatabase:: handleScanInventory(const Data_RFID_Inventory& inventory) {
-    // Update LastRead for each tag; insert unknown tags.
+void dDatabase::handleGetPresentTags(uint32_t requestId) {
+    // Tags the background inventory last held as present (seeds the core's
+    // presence table after a restart). Assets never read are not in the vault.
     sqlite3_stmt* stmt;
-    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    AuthResponse resp = {};
+    resp.command = DB_CMD_GET_PRESENT_TAGS;
+    Data_PresentTags& reply = resp.payload.presentTags;
+    reply.requestId = requestId;
+
+    const char* sql = "SELECT RFID_Tag FROM Assets WHERE MissingSince = 0 AND LastRead > 0 "
+                      "AND typeof(RFID_Tag) = 'blob' AND length(RFID_Tag) = ?;";
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        // No reply: the core retries, then starts from an empty table.
+        LOG_ERROR("[DB] Erro ao ler ativos presentes: %s", sqlite3_errmsg(m_db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, INVENTORY_EPC_BYTES);
 
-    const char* sqlUpdate = "UPDATE Assets SET LastRead = ? WHERE RFID_Tag = ?;";
+    int total = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        memcpy(reply.epc[reply.tagCount], sqlite3_column_blob(stmt, 0), INVENTORY_EPC_BYTES);
+        ++total;
+        if (++reply.tagCount == PRESENT_TAGS_PER_REPLY) {
+            m_mqToInventory.send(&resp, sizeof(resp));
+            ++reply.batchIndex;
+            reply.tagCount = 0;
+        }
+    }
+    sqlite3_finalize(stmt);
 
-    if (sqlite3_prepare_v2(m_db, sqlUpdate, -1, &stmt, nullptr) == SQLITE_OK) {
+    reply.last = 1;
+    m_mqToInventory.send(&resp, sizeof(resp));
+    LOG_DEBUG("[DB] %d ativos presentes enviados ao inventário", total);
+}
 
-        // Iterate over tag list.
-        for (int i = 0; i < inventory.tagCount; ++i) {
+void dDatabase::handleScanInventory(const Data_RFID_Inventory& inventory, uint16_t roomId, uint16_t vaultId) {
+    // One batch of a scan session: update LastRead for each tag, insert unknown tags.
+    // Every batch carries the scan start, so a whole session reads as one instant
+    // (the scan log row has the same time) however long the reader ran.
+    uint32_t readAt = inventory.startedAt ? inventory.startedAt : static_cast<uint32_t>(time(nullptr));
+    int count = (inventory.tagCount > INVENTORY_BATCH_TAGS) ? INVENTORY_BATCH_TAGS : inventory.tagCount;
 
-            // Bind tag and timestamp.
-            sqlite3_bind_int(stmt, 1, static_cast<int>(now));
-            sqlite3_bind_text(stmt, 2, inventory.tagList[i], -1, SQLITE_TRANSIENT);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_stmt* stmtIns = nullptr;
+    const char* sqlUpdate = "UPDATE Assets SET LastRead = ?, MissingSince = 0 WHERE RFID_Tag = ?;";
+    const char* sqlInsert = "INSERT INTO Assets (Name, RFID_Tag, LastRead) VALUES ('Item Desconhecido', ?, ?);";
+    if (sqlite3_prepare_v2(m_db, sqlUpdate, -1, &stmt, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(m_db, sqlInsert, -1, &stmtIns, nullptr) != SQLITE_OK) {
+        LOG_ERROR("[DB] Erro no prepare do inventário: %s", sqlite3_errmsg(m_db));
+        sqlite3_finalize(stmt);
+        sqlite3_finalize(stmtIns);
+        return;
+    }
+
+    // The whole batch (and its session bookkeeping) is atomic; a savepoint nests
+    // inside the dispatcher's transaction of sequenced messages.
+    sqlite3_exec(m_db, "SAVEPOINT inventory;", nullptr, nullptr, nullptr);
+
+    for (int i = 0; i < count; ++i) {
+        const uint8_t* epc = inventory.tagList[i];
 
-            // Update existing asset row.
-            if (sqlite3_step(stmt) != SQLITE_DONE) {
-                std::cerr << "[DB] Erro ao atualizar Tag: " << inventory.tagList[i] << std::endl;
+        sqlite3_bind_int(stmt, 1, static_cast<int>(readAt));
+        sqlite3_bind_blob(stmt, 2, epc, INVENTORY_EPC_BYTES, SQLITE_STATIC);
+        bool updated = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+
+        if (!updated || sqlite3_changes(m_db) == 0) {
+            char tag[INVENTORY_EPC_HEX_SIZE];
+            epcToHex(epc, tag);
+            if (!updated) {
+                LOG_ERROR("[DB] Erro ao atualizar Tag: %s", tag);
+                continue;
             }
-            if (sqlite3_changes(m_db) == 0) {
-                const char* sqlInsert = "INSERT INTO Assets (Name, RFID_Tag, LastRead) VALUES ('Item Desconhecido', ?, ?);";
-                sqlite3_stmt* stmtIns;
-
-                if (sqlite3_prepare_v2(m_db, sqlInsert, -1, &stmtIns, nullptr) == SQLITE_OK) {
-                    sqlite3_bind_text(stmtIns, 1, inventory.tagList[i], -1, SQLITE_TRANSIENT);
-                    sqlite3_bind_int(stmtIns, 2, static_cast<int>(now));
-                    sqlite3_step(stmtIns);
-                    sqlite3_finalize(stmtIns);
-                    std::cout << "[DB] Novo ativo detetado e registado: " << inventory.tagList[i] << std::endl;
-                }
+            sqlite3_bind_blob(stmtIns, 1, epc, INVENTORY_EPC_BYTES, SQLITE_STATIC);
+            sqlite3_bind_int(stmtIns, 2, static_cast<int>(readAt));
+            if (sqlite3_step(stmtIns) == SQLITE_DONE) {
+                LOG_INFO("[DB] Novo ativo detetado e registado: %s", tag);
             }
+            sqlite3_reset(stmtIns);
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_finalize(stmtIns);
+
+    if (inventory.sessionId != 0) {
+        // First batch opens the session; every batch adds to it.
+        const char* sqlOpen =
+            "INSERT OR IGNORE INTO InventorySessions (SessionID, VaultID, RoomID, StartedAt) VALUES (?, ?, ?, ?);";
+        if (sqlite3_prepare_v2(m_db, sqlOpen, -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_int64(stmt, 1, inventory.sessionId);
+            sqlite3_bind_int(stmt, 2, vaultId);
+            sqlite3_bind_int(stmt, 3, roomId);
+            sqlite3_bind_int(stmt, 4, static_cast<int>(readAt));
+            sqlite3_step(stmt);
+            sqlite3_finalize(stmt);
+        }
+        const char* sqlAdd =
+            "UPDATE InventorySessions SET Batches = Batches + 1, Tags = Tags + ? WHERE SessionID = ?;";
+        if (sqlite3_prepare_v2(m_db, sqlAdd, -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_int(stmt, 1, count);
+            sqlite3_bind_int64(stmt, 2, inventory.sessionId);
+            sqlite3_step(stmt);
+            sqlite3_finalize(stmt);
+        }
+    }
+
+    sqlite3_exec(m_db, "RELEASE inventory;", nullptr, nullptr, nullptr);
+    LOG_DEBUG("[DB] Inventário: sessão %u lote %u (%d itens)",
+              inventory.sessionId, inventory.batchIndex, count);
+}
 
-            // Reset for next tag.
-            sqlite3_reset(stmt);
+void dDatabase::handleTagPresence(const Data_TagPresence& presence, uint16_t roomId, uint16_t vaultId) {
+    // Background inventory diff: asset state plus one audit row per change.
+    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    char tag[INVENTORY_EPC_HEX_SIZE];
+    epcToHex(presence.epc, tag);
+    sqlite3_stmt* stmt;
+
+    sqlite3_exec(m_db, "SAVEPOINT presence;", nullptr, nullptr, nullptr);
+
+    const char* sqlState = presence.present
+        ? "UPDATE Assets SET LastRead = ?, MissingSince = 0 WHERE RFID_Tag = ?;"
+        : "UPDATE Assets SET MissingSince = ? WHERE RFID_Tag = ?;";
+    if (sqlite3_prepare_v2(m_db, sqlState, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, static_cast<int>(presence.present ? presence.lastSeen : now));
+        sqlite3_bind_blob(stmt, 2, presence.epc, INVENTORY_EPC_BYTES, SQLITE_STATIC);
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    if (presence.present && sqlite3_changes(m_db) == 0) {
+        const char* sqlInsert = "INSERT INTO Assets (Name, RFID_Tag, LastRead) VALUES ('Item Desconhecido', ?, ?);";
+        if (sqlite3_prepare_v2(m_db, sqlInsert, -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_blob(stmt, 1, presence.epc, INVENTORY_EPC_BYTES, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 2, static_cast<int>(presence.lastSeen));
+            if (sqlite3_step(stmt) == SQLITE_DONE) {
+                LOG_INFO("[DB] Novo ativo detetado e registado: %s", tag);
+            }
+            sqlite3_finalize(stmt);
         }
+    }
 
+    uint32_t assetId = 0;
+    const char* sqlId = "SELECT AssetID FROM Assets WHERE RFID_Tag = ?;";
+    if (sqlite3_prepare_v2(m_db, sqlId, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_blob(stmt, 1, presence.epc, INVENTORY_EPC_BYTES, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            assetId = static_cast<uint32_t>(sqlite3_column_int(stmt, 0));
+        }
         sqlite3_finalize(stmt);
-        std::cout << "[DB] Inventário atualizado com sucesso (" << inventory.tagCount << " itens)." << std::endl;
+    }
+
+    // value: rounds that read the tag; value2: seconds since the last read.
+    DatabaseLog log;
+    log.logType = presence.present ? LOG_TYPE_INVENTORY : LOG_TYPE_ALERT;
+    log.eventCode = presence.present ? EVT_ASSET_APPEARED : EVT_ASSET_MISSING;
+    log.entityID = assetId;
+    log.value = static_cast<double>(presence.reads);
+    log.value2 = (now > presence.lastSeen) ? static_cast<double>(now - presence.lastSeen) : 0.0;
+    log.timestamp = now;
+    handleInsertLog(log, roomId, vaultId);
+
+    sqlite3_exec(m_db, "RELEASE presence;", nullptr, nullptr, nullptr);
+
+    if (presence.present) {
+        LOG_DEBUG("[DB] Ativo %s presente", tag);
+    } else {
+        LOG_WARN("[DB] Ativo %s ausente do cofre %u", tag, vaultId);
+    }
+}
+
+void dDatabase::handleInventoryEnd(const Data_RFID_Inventory& inventory) {
+    // Close the session; a shortfall means batches were lost on the way.
+    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    sqlite3_stmt* stmt;
+
+    // An empty scan sends no batch: the end message opens the session too.
+    const char* sqlEnd =
+        "INSERT OR IGNORE INTO InventorySessions (SessionID, StartedAt) VALUES (?, ?);";
+    if (sqlite3_prepare_v2(m_db, sqlEnd, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, inventory.sessionId);
+        sqlite3_bind_int(stmt, 2, static_cast<int>(inventory.startedAt ? inventory.startedAt : now));
+        sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+    }
+    const char* sqlClose =
+        "UPDATE InventorySessions SET EndedAt = ?, Complete = 1 WHERE SessionID = ?;";
+    if (sqlite3_prepare_v2(m_db, sqlClose, -1, &stmt, nullptr) != SQLITE_OK) {
+        LOG_ERROR("[DB] Erro ao fechar sessão de inventário: %s", sqlite3_errmsg(m_db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, static_cast<int>(now));
+    sqlite3_bind_int64(stmt, 2, inventory.sessionId);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    int batches = 0;
+    int tags = 0;
+    const char* sqlCount = "SELECT Batches, Tags FROM InventorySessions WHERE SessionID = ?;";
+    if (sqlite3_prepare_v2(m_db, sqlCount, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, inventory.sessionId);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            batches = sqlite3_column_int(stmt, 0);
+            tags = sqlite3_column_int(stmt, 1);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    if (batches != inventory.batchIndex || static_cast<uint32_t>(tags) != inventory.totalTags) {
+        LOG_WARN("[DB] Sessão de inventário %u incompleta: %d/%u lotes, %d/%u itens",
+                 inventory.sessionId, batches, inventory.batchIndex, tags, inventory.totalTags);
     } else {
-        std::cerr << "[DB] Erro no prepare do inventário: " << sqlite3_errmsg(m_db) << std::endl;
+        LOG_INFO("[DB] Inventário atualizado com sucesso (sessão %u, %d itens).", inventory.sessionId, tags);
     }
 }
 
@@ -697,11 +1217,11 @@ void dDatabase::handleGetSensors() {
     const char* sqlVault =
     "SELECT u.Name, l.Timestamp, l.EntityID FROM Logs l "
     "LEFT JOIN Users u ON l.EntityID = u.FingerprintID "
-    "WHERE l.LogType = ? AND l.Description LIKE '%Cofre%' "
+    "WHERE l.EventCode = ? "
     "ORDER BY l.Timestamp DESC LIMIT 1;";
 
     if (sqlite3_prepare_v2(m_db, sqlVault, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, LOG_TYPE_ACCESS);
+        sqlite3_bind_int(stmt, 1, EVT_VAULT_OPEN);
 
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
@@ -739,11 +1259,11 @@ void dDatabase::handleGetSensors() {
     }
     // Room entry time from access logs.
     const char* sqlRoomTime =
-        "SELECT Timestamp FROM Logs WHERE LogType = ? AND Description LIKE '%ENTROU%' "
+        "SELECT Timestamp FROM Logs WHERE EventCode = ? "
         "ORDER BY Timestamp DESC LIMIT 1;";
 
     if (sqlite3_prepare_v2(m_db, sqlRoomTime, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, LOG_TYPE_ACCESS);
+        sqlite3_bind_int(stmt, 1, EVT_ROOM_ENTER);
 
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             time_t ts = sqlite3_column_int(stmt, 0);
@@ -770,11 +1290,11 @@ void dDatabase::handleGetSensors() {
     const char* sqlRoomOut =
         "SELECT u.Name, l.Timestamp FROM Logs l "
         "LEFT JOIN Users u ON l.EntityID = u.UserID "
-        "WHERE l.LogType = ? AND l.Description LIKE '%SAIU%' "
+        "WHERE l.EventCode = ? "
         "ORDER BY l.Timestamp DESC LIMIT 1;";
 
     if (sqlite3_prepare_v2(m_db, sqlRoomOut, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, LOG_TYPE_ACCESS);
+        sqlite3_bind_int(stmt, 1, EVT_ROOM_LEAVE);
 
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             const char* userName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
@@ -1195,14 +1715,17 @@ void dDatabase::handleGetAssets() {
     DbWebResponse resp = {};
     nlohmann::json assets = nlohmann::json::array();
 
-    const char* sql = "SELECT Name, RFID_Tag, LastRead FROM Assets;";
+    const char* sql = "SELECT Name, RFID_Tag, LastRead, MissingSince FROM Assets;";
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        // Last full scan (presence events are inventory rows too; legacy rows have no code).
         time_t lastScan = 0;
         sqlite3_stmt* scanStmt = nullptr;
-        const char* sqlScan = "SELECT Timestamp FROM Logs WHERE LogType = ? ORDER BY Timestamp DESC LIMIT 1;";
+        const char* sqlScan = "SELECT Timestamp FROM Logs WHERE LogType = ? AND EventCode IN (0, ?) "
+                              "ORDER BY Timestamp DESC LIMIT 1;";
         if (sqlite3_prepare_v2(m_db, sqlScan, -1, &scanStmt, nullptr) == SQLITE_OK) {
             sqlite3_bind_int(scanStmt, 1, LOG_TYPE_INVENTORY);
+            sqlite3_bind_int(scanStmt, 2, EVT_INVENTORY_SCAN);
             if (sqlite3_step(scanStmt) == SQLITE_ROW) {
                 lastScan = sqlite3_column_int(scanStmt, 0);
             }
@@ -1212,12 +1735,12 @@ void dDatabase::handleGetAssets() {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
             nlohmann::json asset;
             const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-            const char* tag = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
             asset["name"] = name ? name : "";
-            asset["tag"] = tag ? tag : "";
+            asset["tag"] = columnTag(stmt, 1);
 
             time_t ts = sqlite3_column_int(stmt, 2);
-            if (lastScan > 0 && ts >= lastScan) {
+            bool missing = sqlite3_column_int(stmt, 3) != 0;
+            if (!missing && lastScan > 0 && ts >= lastScan) {
                 asset["state"] = "Inside";
             } else {
                 asset["state"] = "Outside";
@@ -1256,7 +1779,7 @@ void dDatabase::handleCreateAsset(const AssetData& asset) {
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         bindTextOrNull(stmt, 1, asset.name);
-        bindTextOrNull(stmt, 2, asset.tag);
+        bindTag(stmt, 2, asset.tag);
         sqlite3_bind_int(stmt, 3, 0);
 
         if (sqlite3_step(stmt) == SQLITE_DONE) {
@@ -1285,7 +1808,7 @@ void dDatabase::handleModifyAsset(const AssetData& asset) {
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
         bindTextOrNull(stmt, 1, asset.name);
-        bindTextOrNull(stmt, 2, asset.tag);
+        bindTag(stmt, 2, asset.tag);
 
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             resp.success = true;
@@ -1311,7 +1834,7 @@ void dDatabase::handleRemoveAsset(const char* tag) {
     const char* sql = "DELETE FROM Assets WHERE RFID_Tag = ?;";
 
     if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, tag, -1, SQLITE_TRANSIENT);
+        bindTag(stmt, 1, tag);
 
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             resp.success = true;
@@ -1472,7 +1995,7 @@ void dDatabase::handleFilterLogs(const LogFilter& filter) {
         else if (strcmp(filter.logType, "Users") == 0) logTypeFilter = LOG_TYPE_ACCESS;       
 
         const char* sql =
-            "SELECT Timestamp, LogType, Description, EntityID FROM Logs "
+            "SELECT Timestamp, LogType, EventCode, EntityID, Value, Value2, Description FROM Logs "
             "WHERE LogType = ? AND Timestamp > ? "
             "ORDER BY Timestamp DESC LIMIT 100;";
 
@@ -1494,24 +2017,13 @@ void dDatabase::handleFilterLogs(const LogFilter& filter) {
                 int type = sqlite3_column_int(stmt, 1);
                 log["type"] = (type == LOG_TYPE_ALERT) ? "Alert" : "Info";
 
-                const char* desc = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+                int eventCode = sqlite3_column_int(stmt, 2);
                 uint32_t entityId = static_cast<uint32_t>(sqlite3_column_int(stmt, 3));
-                std::string description = desc ? desc : "";
-                if (type == LOG_TYPE_ACCESS && entityId > 0) {
-                    // Replace placeholders with actual user name when possible.
-                    std::string name = getUserNameById(m_db, entityId);
-                    if (!name.empty()) {
-                        if (description.find("ENTROU") != std::string::npos) {
-                            description = "Utilizador " + name + " ENTROU na sala";
-                        } else if (description.find("SAIU") != std::string::npos) {
-                            description = "Utilizador " + name + " SAIU da sala";
-                        } else if (description.find("Cofre") != std::string::npos) {
-                            description = "Cofre Aberto - Utilizador: " + name;
-                        }
-                    }
-                }
-
-                log["desc"] = description;
+                double value = sqlite3_column_double(stmt, 4);
+                double value2 = sqlite3_column_double(stmt, 5);
+                const char* legacy = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
+
+                log["desc"] = renderLogText(eventCode, entityId, value, value2, legacy);
 
                 logs.push_back(log);
             }
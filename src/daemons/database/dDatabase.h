@@ -21,7 +21,8 @@ public:
               C_Mqueue& mqFinger,
               C_Mqueue& mqCheckMovement,
               C_Mqueue& mqToWeb,
-              C_Mqueue& mqToEnv);
+              C_Mqueue& mqToEnv,
+              C_Mqueue& mqToInventory);
     ~dDatabase();
 
     bool open();
@@ -40,16 +41,33 @@ private:
     C_Mqueue& m_mqToCheckMovement;
     C_Mqueue& m_mqToWeb;
     C_Mqueue& m_mqToEnvThread;    
+    C_Mqueue& m_mqToInventory;
+
+    // Last outbox message applied (core replays may repeat it).
+    uint32_t m_outboxEpoch;
+    uint32_t m_outboxLastSeq;
 
     
-    void handleAccessRequest(const char* rfid, bool isEntering);
-    void handleScanInventory(const Data_RFID_Inventory& inventory);
-    void handleCheckUserInPir();
+    void handleAccessRequest(const char* rfid, bool isEntering, uint16_t roomId);
+    void handleScanInventory(const Data_RFID_Inventory& inventory, uint16_t roomId, uint16_t vaultId);
+    void handleInventoryEnd(const Data_RFID_Inventory& inventory);
+    void handleTagPresence(const Data_TagPresence& presence, uint16_t roomId, uint16_t vaultId);
+    void handleCheckUserInPir(uint16_t roomId);
+    void handleGetPresentTags(uint32_t requestId);
     void handleLogin(const LoginRequest& login);
     void handleGetDashboard();
     void handleGetSensors();
     void handleGetActuators();
-    void handleInsertLog(const DatabaseLog& log);
+    void handleInsertLog(const DatabaseLog& log, uint16_t roomId, uint16_t vaultId);
+    bool hasColumn(const char* table, const char* column);
+    void migrateLogsSchema();
+    void migrateSiteSchema();
+    void migrateAssetsSchema();
+    void loadOutboxState();
+    bool isOutboxDuplicate(const DatabaseMsg& msg) const;
+    bool commitOutboxSeq(const DatabaseMsg& msg);
+    std::string renderLogText(int eventCode, uint32_t entityId, double value,
+                              double value2, const char* legacyText);
     void updateSensorTable(uint8_t entityID, double value, double value2, uint32_t timestamp);
     void updateActuatorTable(uint8_t entityID, double value, uint32_t timestamp);
 
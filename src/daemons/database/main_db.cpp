@@ -7,6 +7,8 @@
 #include <cstring>
 
 #include "dDatabase.h"
+#include "C_Logger.h"
+#include "C_ConfigWatch.h"
 #include "C_Mqueue.h"
 #include "SharedTypes.h"
 
@@ -16,6 +18,7 @@
  */
 
 static const char* DB_PIDFILE = "/var/run/dDatabase.pid";
+static const char* DB_PATH_DEFAULT = "secure_asset.db";
 static volatile sig_atomic_t g_stop = 0;
 static int g_shutdown_fd = -1;
 
@@ -87,6 +90,8 @@ int main() {
     unsetenv("NOTIFY_FD");
     unsetenv("SHUTDOWN_FD");
 
+    C_Logger::start(STDOUT_FILENO);
+
     // Open existing queues (created by the launcher).
     C_Mqueue mqToDb("/mq_to_db", sizeof(DatabaseMsg), 20, false);
     C_Mqueue mqRfidIn("/mq_rfid_in", sizeof(AuthResponse), 10, false);
@@ -95,10 +100,17 @@ int main() {
     C_Mqueue mqMove("/mq_move", sizeof(AuthResponse), 10, false);
     C_Mqueue mqToWeb("/mq_db_to_web", sizeof(DbWebResponse), 10, false);
     C_Mqueue mqToEnv("/mq_db_to_env", sizeof(AuthResponse), 10, false);
+    C_Mqueue mqToInventory("/mq_db_to_inventory", sizeof(AuthResponse), 10, false);
+
+    // [database] path: opened once, changes apply on the next start.
+    C_ConfigWatch config(SYSTEM_CONFIG_PATH);
+    config.load();
+    config.restartOnly("database");
+    config.watch();
 
-    dDatabase db("secure_asset.db",
+    dDatabase db(config.config().getString("database", "path", DB_PATH_DEFAULT),
                  mqToDb, mqRfidIn, mqRfidOut,
-                 mqFinger, mqMove, mqToWeb, mqToEnv);
+                 mqFinger, mqMove, mqToWeb, mqToEnv, mqToInventory);
 
     bool ok = db.open() && db.initializeSchema();
 
@@ -116,6 +128,7 @@ int main() {
         // Avoid wrapper waiting until timeout.
         sendShutdownAck(); // closes g_shutdown_fd
         unlink(DB_PIDFILE);
+        C_Logger::stop();
         return -1;
     }
 
@@ -129,9 +142,11 @@ int main() {
             // Dispatch requests received via IPC.
             db.processDbMessage(msg);
         }
+        config.poll(0);
     }
 
     db.close();
+    C_Logger::stop();
     sendShutdownAck();
     unlink(DB_PIDFILE);
     return 0;
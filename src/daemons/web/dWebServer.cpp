@@ -9,8 +9,9 @@
 #include <ctime>
 #include <random>
 
-dWebServer::dWebServer(C_Mqueue& toDb, C_Mqueue& fromDb, int port)
-    : m_mqToDatabase(toDb), m_mqFromDatabase(fromDb), m_port(port), m_running(false) {
+dWebServer::dWebServer(C_Mqueue& toDb, C_Mqueue& fromDb, int port, const std::string& bindAddress)
+    : m_mqToDatabase(toDb), m_mqFromDatabase(fromDb), m_bindAddress(bindAddress), m_port(port),
+      m_running(false), m_staticRoot(WEB_STATIC_ROOT_DEFAULT), m_dbTimeout(WEB_DB_TIMEOUT_DEFAULT) {
     mg_mgr_init(&m_mgr);
 }
 
@@ -20,7 +21,7 @@ dWebServer::~dWebServer() {
 }
 
 bool dWebServer::start() {
-    std::string addr = "http://10.42.0.163:" + std::to_string(m_port) + "/";
+    std::string addr = "http://" + m_bindAddress + ":" + std::to_string(m_port) + "/";
 
     // Start HTTP listener on configured address.
     if (mg_http_listen(&m_mgr, addr.c_str(), eventHandler, this) == nullptr) {
@@ -37,14 +38,25 @@ void dWebServer::stop() {
     m_running = false;
 }
 
-void dWebServer::run() {
+void dWebServer::run(const std::function<void()>& tick) {
     while (m_running) {
         // Main Mongoose loop + expired session cleanup.
         mg_mgr_poll(&m_mgr, 1000);
         cleanExpiredSessions();
+        if (tick) tick();
     }
 }
 
+void dWebServer::setStaticRoot(const std::string& root) {
+    m_staticRoot = root;
+    std::cout << "[WebServer] Static root: " << m_staticRoot << std::endl;
+}
+
+void dWebServer::setDbTimeout(int seconds) {
+    m_dbTimeout = (seconds < 1) ? 1 : seconds;
+    std::cout << "[WebServer] DB timeout: " << m_dbTimeout << " s" << std::endl;
+}
+
 bool dWebServer::matchUri(const struct mg_str* uri, const char* pattern) {
     size_t plen = strlen(pattern);
     return uri->len == plen && memcmp(uri->buf, pattern, plen) == 0;
@@ -113,7 +125,7 @@ void dWebServer::eventHandler(struct mg_connection* c, int ev, void* ev_data) {
             }
             struct mg_http_serve_opts opts;
             memset(&opts, 0, sizeof(opts));
-            opts.root_dir = "/root/SecureAsset/web";
+            opts.root_dir = self->m_staticRoot.c_str();
             mg_http_serve_dir(c, hm, &opts);
         }
     }
@@ -141,7 +153,7 @@ void dWebServer::handleLogin(struct mg_connection* c, struct mg_http_message* hm
     }
 
     DbWebResponse resp = {};
-    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
     if (bytes <= 0 || !resp.success) {
         sendError(c, 401, "Invalid credentials");
@@ -193,7 +205,7 @@ void dWebServer::handleRegister(struct mg_connection* c, struct mg_http_message*
     }
 
     DbWebResponse resp = {};
-    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
     if (bytes > 0 && resp.success) {
         sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -246,7 +258,7 @@ void dWebServer::handleDashboard(struct mg_connection* c, struct mg_http_message
     }
 
     DbWebResponse resp = {};
-    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
     if (bytes > 0 && resp.success) {
         nlohmann::json data = nlohmann::json::parse(resp.jsonData);
@@ -272,7 +284,7 @@ void dWebServer::handleSensors(struct mg_connection* c, struct mg_http_message*
     m_mqToDatabase.send(&msg, sizeof(msg));
 
     DbWebResponse resp = {};
-    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
     if (bytes > 0 && resp.success) {
         sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -294,7 +306,7 @@ void dWebServer::handleActuators(struct mg_connection* c, struct mg_http_message
     m_mqToDatabase.send(&msg, sizeof(msg));
 
     DbWebResponse resp = {};
-    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
     if (bytes > 0 && resp.success) {
         sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -327,7 +339,7 @@ void dWebServer::handleLogsFilter(struct mg_connection* c, struct mg_http_messag
     m_mqToDatabase.send(&msg, sizeof(msg));
 
     DbWebResponse resp = {};
-    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+    ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
     if (bytes > 0 && resp.success) {
         sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -356,7 +368,7 @@ void dWebServer::handleUsers(struct mg_connection* c, struct mg_http_message* hm
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -395,7 +407,7 @@ void dWebServer::handleUsers(struct mg_connection* c, struct mg_http_message* hm
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -450,7 +462,7 @@ void dWebServer::handleUsersById(struct mg_connection* c, struct mg_http_message
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -467,7 +479,7 @@ void dWebServer::handleUsersById(struct mg_connection* c, struct mg_http_message
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -496,7 +508,7 @@ void dWebServer::handleAssets(struct mg_connection* c, struct mg_http_message* h
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -522,7 +534,7 @@ void dWebServer::handleAssets(struct mg_connection* c, struct mg_http_message* h
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -566,7 +578,7 @@ void dWebServer::handleAssetsById(struct mg_connection* c, struct mg_http_messag
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -583,7 +595,7 @@ void dWebServer::handleAssetsById(struct mg_connection* c, struct mg_http_messag
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -613,7 +625,7 @@ void dWebServer::handleSettings(struct mg_connection* c, struct mg_http_message*
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -639,7 +651,7 @@ void dWebServer::handleSettings(struct mg_connection* c, struct mg_http_message*
         m_mqToDatabase.send(&msg, sizeof(msg));
 
         DbWebResponse resp = {};
-        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), 2);
+        ssize_t bytes = m_mqFromDatabase.timedReceive(&resp, sizeof(resp), m_dbTimeout);
 
         if (bytes > 0 && resp.success) {
             sendJson(c, 200, nlohmann::json::parse(resp.jsonData));
@@ -9,11 +9,18 @@
 #include <string>
 #include <map>
 #include <mutex>
+#include <functional>
 #include "mongoose.h"
 #include "nlohmann/json.hpp"
 #include "C_Mqueue.h"
 #include "SharedTypes.h"
 
+// Defaults for the [web] section of the system configuration.
+#define WEB_BIND_ADDRESS_DEFAULT  "10.42.0.163"
+#define WEB_PORT_DEFAULT          8080
+#define WEB_STATIC_ROOT_DEFAULT   "/root/SecureAsset/web"
+#define WEB_DB_TIMEOUT_DEFAULT    2
+
 struct SessionData {
     uint32_t userId;
     std::string username;
@@ -31,16 +38,25 @@ private:
     C_Mqueue& m_mqFromDatabase;
     std::map<std::string, SessionData> m_sessions;
     std::mutex m_sessionMutex;
+    std::string m_bindAddress;
     int m_port;
     bool m_running;
+    // Live settings (applied between polls, same thread as the handlers).
+    std::string m_staticRoot;
+    int m_dbTimeout;
 
 public:
-    dWebServer(C_Mqueue& toDb, C_Mqueue& fromDb, int port = 8080);
+    dWebServer(C_Mqueue& toDb, C_Mqueue& fromDb, int port = WEB_PORT_DEFAULT,
+               const std::string& bindAddress = WEB_BIND_ADDRESS_DEFAULT);
     ~dWebServer();
 
     bool start();
     void stop();
-    void run();
+    // Event loop; 'tick' runs between polls (e.g. configuration reload).
+    void run(const std::function<void()>& tick = nullptr);
+
+    void setStaticRoot(const std::string& root);
+    void setDbTimeout(int seconds);
 
 private:
     static void eventHandler(struct mg_connection* c, int ev, void* ev_data);
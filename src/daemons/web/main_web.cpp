@@ -8,6 +8,7 @@
 #include <cstring>
 
 #include "dWebServer.h"
+#include "C_ConfigWatch.h"
 #include "C_Mqueue.h"
 #include "SharedTypes.h"
 
@@ -95,9 +96,31 @@ int main() {
     C_Mqueue mqToDb("/mq_to_db", sizeof(DatabaseMsg), 20, false);
     C_Mqueue mqFromDb("/mq_db_to_web", sizeof(DbWebResponse), 10, false);
 
-    dWebServer server(mqToDb, mqFromDb, 8080);
+    // [web]: bind_address/port need a restart; static_root/db_timeout are live.
+    C_ConfigWatch config(SYSTEM_CONFIG_PATH);
+    config.load();
+    const C_Config& c = config.config();
+
+    dWebServer server(mqToDb, mqFromDb,
+                      c.getInt("web", "port", WEB_PORT_DEFAULT),
+                      c.getString("web", "bind_address", WEB_BIND_ADDRESS_DEFAULT));
     g_server = &server;
 
+    const std::string listenAddr = c.getString("web", "bind_address", WEB_BIND_ADDRESS_DEFAULT) + ":" +
+                                   std::to_string(c.getInt("web", "port", WEB_PORT_DEFAULT));
+    auto applyWeb = [&server, listenAddr](const C_Config& cfg) {
+        server.setStaticRoot(cfg.getString("web", "static_root", WEB_STATIC_ROOT_DEFAULT));
+        server.setDbTimeout(cfg.getInt("web", "db_timeout", WEB_DB_TIMEOUT_DEFAULT));
+        std::string addr = cfg.getString("web", "bind_address", WEB_BIND_ADDRESS_DEFAULT) + ":" +
+                           std::to_string(cfg.getInt("web", "port", WEB_PORT_DEFAULT));
+        if (addr != listenAddr) {
+            std::cout << "[WebServer] Endereço " << addr << " aplicado no próximo arranque" << std::endl;
+        }
+    };
+    applyWeb(c);
+    config.subscribe("web", applyWeb);
+    config.watch();
+
     std::signal(SIGINT, handleSignal);
     std::signal(SIGTERM, handleSignal);
 
@@ -121,7 +144,7 @@ int main() {
     }
 
     // Blocks until stop() is called by the signal handler.
-    server.run();
+    server.run([&config]() { config.poll(0); });
 
     sendShutdownAck();
     unlink(WEB_PIDFILE);